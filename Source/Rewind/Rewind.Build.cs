@@ -8,6 +8,7 @@ public class Rewind : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Chaos", "PhysicsCore",
+			"MassEntity", "MassCommon", "MassMovement", "MassSpawner", "GeometryCollectionEngine" });
 	}
 }
@@ -3,5 +3,6 @@
 #include "Rewind.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogRewind);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Rewind, "Rewind" );
- 
\ No newline at end of file
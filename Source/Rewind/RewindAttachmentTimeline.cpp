@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindAttachmentTimeline.h"
+
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "RewindComponent.h"
+
+void FRewindAttachmentTimeline::Initialize(int32 InCapacity, bool bInKeepColdHistory)
+{
+	Capacity = FMath::Max(InCapacity, 1);
+	Keys.SetNumZeroed(Capacity);
+	Head = 0;
+	NumFrames = 0;
+	ColdRuns.Reset();
+	bKeepColdHistory = bInKeepColdHistory;
+}
+
+bool FRewindAttachmentTimeline::IsRewindableParent(const USceneComponent* Parent)
+{
+	const AActor* ParentOwner = Parent ? Parent->GetOwner() : nullptr;
+	return ParentOwner && ParentOwner->FindComponentByClass<URewindComponent>() != nullptr;
+}
+
+void FRewindAttachmentTimeline::Record(const USceneComponent& Root)
+{
+	check(Capacity > 0);
+
+	if (NumFrames == Capacity) { PopFront(); }
+	Keys[GetSlot(NumFrames)] = FindOrAddKey(Root.GetAttachParent(), Root.GetAttachSocketName());
+	++NumFrames;
+}
+
+void FRewindAttachmentTimeline::PopFront()
+{
+	check(NumFrames > 0);
+
+	if (bKeepColdHistory)
+	{
+		const uint16 Key = Keys[Head];
+		if (ColdRuns.Num() > 0 && ColdRuns.Last().Key == Key) { ++ColdRuns.Last().NumFrames; }
+		else { ColdRuns.Add({ Key, 1 }); }
+	}
+
+	Head = (Head + 1) % Capacity;
+	--NumFrames;
+}
+
+void FRewindAttachmentTimeline::Truncate(int32 Count)
+{
+	NumFrames = FMath::Clamp(Count, 0, NumFrames);
+}
+
+void FRewindAttachmentTimeline::Empty()
+{
+	Head = 0;
+	NumFrames = 0;
+}
+
+FRewindAttachmentTimeline::FBranch FRewindAttachmentTimeline::Branch(int32 Count) const
+{
+	FBranch Branch;
+	Branch.Attachments = Attachments;
+	Branch.Keys.SetNumUninitialized(FMath::Clamp(Count, 0, NumFrames));
+	for (int32 Index = 0; Index < Branch.Keys.Num(); ++Index) { Branch.Keys[Index] = Keys[GetSlot(Index)]; }
+	return Branch;
+}
+
+void FRewindAttachmentTimeline::Restore(const FBranch& Branch)
+{
+	check(Capacity > 0);
+
+	// Keys index the table they were recorded with, so the branch's table replaces this one along with the frames
+	Attachments = Branch.Attachments;
+	ColdRuns.Reset();
+	Head = 0;
+	NumFrames = FMath::Min(Branch.Keys.Num(), Capacity);
+	const int32 FirstKey = Branch.Keys.Num() - NumFrames;
+	for (int32 Index = 0; Index < NumFrames; ++Index) { Keys[Index] = Branch.Keys[FirstKey + Index]; }
+}
+
+void FRewindAttachmentTimeline::RestoreColdHistory(int32 Count)
+{
+	check(Capacity > 0);
+
+	// Snapshots streamed back in can take the resident window past its usual capacity
+	if (NumFrames + Count > Capacity) { Grow(NumFrames + Count); }
+
+	for (; Count > 0 && ColdRuns.Num() > 0; --Count)
+	{
+		Head = (Head + Capacity - 1) % Capacity;
+		Keys[Head] = ColdRuns.Last().Key;
+		++NumFrames;
+		if (--ColdRuns.Last().NumFrames == 0) { ColdRuns.Pop(false); }
+	}
+}
+
+void FRewindAttachmentTimeline::Grow(int32 NewCapacity)
+{
+	TArray<uint16> NewKeys;
+	NewKeys.SetNumZeroed(NewCapacity);
+	for (int32 Index = 0; Index < NumFrames; ++Index) { NewKeys[Index] = Keys[GetSlot(Index)]; }
+	Keys = MoveTemp(NewKeys);
+	Capacity = NewCapacity;
+	Head = 0;
+}
+
+bool FRewindAttachmentTimeline::Apply(int32 Index, USceneComponent& Root) const
+{
+	const uint16 Key = Keys[GetSlot(Index)];
+	if (Key == 0)
+	{
+		// Attachments to actors that aren't rewound belong to game code, so only rewindable parents are detached from
+		if (IsRewindableParent(Root.GetAttachParent())) { Root.DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform); }
+		return true;
+	}
+
+	const FAttachment& Attachment = Attachments[Key - 1];
+	USceneComponent* Parent = Attachment.Parent.Get();
+	if (!Parent) { return false; }
+
+	if (Root.GetAttachParent() != Parent || Root.GetAttachSocketName() != Attachment.SocketName)
+	{
+		Root.AttachToComponent(Parent, FAttachmentTransformRules::KeepRelativeTransform, Attachment.SocketName);
+	}
+	return true;
+}
+
+uint16 FRewindAttachmentTimeline::FindOrAddKey(USceneComponent* Parent, FName SocketName)
+{
+	if (!IsRewindableParent(Parent)) { return 0; }
+
+	// Actors are attached to a handful of parents over their lifetime, so a linear search is fine
+	for (int32 Index = 0; Index < Attachments.Num(); ++Index)
+	{
+		if (Attachments[Index].Parent == Parent && Attachments[Index].SocketName == SocketName) { return uint16(Index + 1); }
+	}
+	check(Attachments.Num() < MAX_uint16);
+
+	Attachments.Add({ Parent, SocketName });
+	return uint16(Attachments.Num());
+}
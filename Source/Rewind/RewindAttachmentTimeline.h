@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USceneComponent;
+
+/**
+ * Ring buffer of what an actor's root component was attached to when each snapshot was recorded.
+ *
+ * Only attachment to other rewindable actors is tracked, since their own timelines put them back where they were.
+ * Snapshots recorded while attached to one hold transforms relative to it, so rigidly attached weapons, carried props
+ * and vehicle parts follow their parent during playback instead of interpolating a world transform of their own. Each
+ * frame is a two byte key into a table of parents and sockets, and attach and detach events are the frames where the
+ * key changes. Keys of frames spilled by the flight recorder are kept in memory, run length encoded, so snapshots
+ * streamed back in are placed in the space they were recorded in.
+ */
+class REWIND_API FRewindAttachmentTimeline
+{
+public:
+	// Rewindable parent and socket an actor was attached to
+	struct FAttachment
+	{
+		TWeakObjectPtr<USceneComponent> Parent;
+		FName SocketName;
+	};
+
+	// Frames of a captured timeline branch, aligned with its newest snapshots
+	struct FBranch
+	{
+		TArray<FAttachment> Attachments;
+		TArray<uint16> Keys;
+	};
+
+	// Sizes the buffer for Capacity frames and discards any history; frames that are popped are kept as cold history if
+	// their snapshots are spilled rather than dropped
+	void Initialize(int32 InCapacity, bool bInKeepColdHistory);
+
+	// Returns whether Parent belongs to an actor whose own timeline rewinds it
+	static bool IsRewindableParent(const USceneComponent* Parent);
+
+	// Returns whether the buffer has been sized
+	bool IsInitialized() const { return Capacity > 0; }
+
+	int32 Num() const { return NumFrames; }
+
+	// Appends what Root is attached to, overwriting the oldest frame when full
+	void Record(const USceneComponent& Root);
+
+	// Removes the oldest frame
+	void PopFront();
+
+	// Keeps the oldest Count frames
+	void Truncate(int32 Count);
+
+	// Removes all frames
+	void Empty();
+
+	// Captures the oldest Count frames
+	FBranch Branch(int32 Count) const;
+
+	// Replaces all frames and cold history with a captured branch
+	void Restore(const FBranch& Branch);
+
+	// Moves the newest Count frames of cold history back onto the front, as their snapshots have been streamed back in
+	void RestoreColdHistory(int32 Count);
+
+	// Forgets all cold history; used when the snapshots it belongs to are discarded or no longer line up with it
+	void DiscardColdHistory() { ColdRuns.Reset(); }
+
+	// Returns whether snapshots recorded with a frame hold transforms relative to a rewindable parent
+	bool IsRelative(int32 Index) const { return Keys[GetSlot(Index)] != 0; }
+
+	// Returns whether two frames were recorded with the same attachment, so their snapshots can be blended
+	bool IsSameAttachment(int32 IndexA, int32 IndexB) const { return Keys[GetSlot(IndexA)] == Keys[GetSlot(IndexB)]; }
+
+	// Attaches Root to, or detaches it from, a rewindable parent as it was at a frame; returns false if that parent no
+	// longer exists, in which case the frame's relative transforms can't be applied
+	bool Apply(int32 Index, USceneComponent& Root) const;
+
+	SIZE_T GetAllocatedSize() const { return Keys.GetAllocatedSize() + Attachments.GetAllocatedSize() + ColdRuns.GetAllocatedSize(); }
+
+private:
+	// Consecutive popped frames with the same key
+	struct FColdRun
+	{
+		uint16 Key = 0;
+		int32 NumFrames = 0;
+	};
+
+	int32 GetSlot(int32 Index) const { return (Head + Index) % Capacity; }
+
+	// Moves the frames into a larger ring, oldest first
+	void Grow(int32 NewCapacity);
+
+	// Returns the key of an attachment, adding it to the table if needed; 0 when not attached to a rewindable parent
+	uint16 FindOrAddKey(USceneComponent* Parent, FName SocketName);
+
+	// Distinct attachments seen so far; key N refers to Attachments[N - 1]
+	TArray<FAttachment> Attachments;
+
+	// Ring of keys, one per frame; Head is the slot of the oldest frame
+	TArray<uint16> Keys;
+	int32 Capacity = 0;
+	int32 Head = 0;
+	int32 NumFrames = 0;
+
+	// Keys of popped frames, oldest first, while their snapshots are spilled rather than dropped
+	TArray<FColdRun> ColdRuns;
+	bool bKeepColdHistory = false;
+};
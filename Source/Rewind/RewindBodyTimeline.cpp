@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindBodyTimeline.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "PhysicsEngine/BodyInstance.h"
+
+void FRewindBodyTimeline::Initialize(const USkeletalMeshComponent& Mesh, int32 InCapacity)
+{
+	BodyBoneIndices.Reset(Mesh.Bodies.Num());
+	for (const FBodyInstance* Body : Mesh.Bodies) { BodyBoneIndices.Add(Body ? Body->InstanceBoneIndex : INDEX_NONE); }
+
+	BoneBodyIndices.Init(INDEX_NONE, Mesh.GetNumBones());
+	for (int32 BodyIndex = 0; BodyIndex < BodyBoneIndices.Num(); ++BodyIndex)
+	{
+		if (BoneBodyIndices.IsValidIndex(BodyBoneIndices[BodyIndex])) { BoneBodyIndices[BodyBoneIndices[BodyIndex]] = BodyIndex; }
+	}
+
+	Capacity = FMath::Max(InCapacity, 1);
+	Frames.SetNum(Capacity);
+	States.Empty();
+	StateBlockCapacity = 0;
+	Head = 0;
+	NumFrames = 0;
+	StateBlockHead = 0;
+	NumStateBlocks = 0;
+}
+
+bool FRewindBodyTimeline::IsCompatible(const USkeletalMeshComponent& Mesh) const
+{
+	if (Capacity == 0 || Mesh.Bodies.Num() != BodyBoneIndices.Num()) { return false; }
+
+	for (int32 BodyIndex = 0; BodyIndex < BodyBoneIndices.Num(); ++BodyIndex)
+	{
+		const FBodyInstance* Body = Mesh.Bodies[BodyIndex];
+		if ((Body ? Body->InstanceBoneIndex : INDEX_NONE) != BodyBoneIndices[BodyIndex]) { return false; }
+	}
+	return true;
+}
+
+void FRewindBodyTimeline::Record(USkeletalMeshComponent& Mesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindBodyTimeline::Record);
+
+	check(Capacity > 0);
+
+	// Claim the next slot, overwriting the oldest frame if the buffer is full
+	if (NumFrames == Capacity) { PopFront(); }
+	const int32 Slot = GetSlot(NumFrames);
+	++NumFrames;
+
+	FRewindBodyFrame& Frame = Frames[Slot];
+	Frame.Origin = Mesh.GetComponentLocation();
+	Frame.bIsSimulating = Mesh.IsSimulatingPhysics();
+	Frame.bIsSleeping = true;
+	Frame.StateBlock = INDEX_NONE;
+	if (!Frame.bIsSimulating) { return; }
+
+	Frame.StateBlock = AddStateBlock();
+	const int32 NumBodies = GetNumBodies();
+	FRewindBodyState* SlotStates = States.GetData() + Frame.StateBlock * NumBodies;
+	FPhysicsCommand::ExecuteRead(
+		&Mesh,
+		[&]()
+		{
+			for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex)
+			{
+				const FBodyInstance* Body = Mesh.Bodies[BodyIndex];
+				const FPhysicsActorHandle Handle = Body ? Body->GetPhysicsActorHandle() : nullptr;
+				FRewindBodyState& State = SlotStates[BodyIndex];
+				if (!FPhysicsInterface::IsValid(Handle))
+				{
+					State = FRewindBodyState();
+					continue;
+				}
+
+				const FTransform Pose = FPhysicsInterface::GetGlobalPose_AssumesLocked(Handle);
+				State.Location = FVector3f(Pose.GetLocation() - Frame.Origin);
+				State.Rotation = FQuat4f(Pose.GetRotation());
+				State.LinearVelocity = FVector3f(FPhysicsInterface::GetLinearVelocity_AssumesLocked(Handle));
+				State.AngularVelocityInRadians = FVector3f(FPhysicsInterface::GetAngularVelocity_AssumesLocked(Handle));
+				Frame.bIsSleeping &= FPhysicsInterface::IsSleeping(Handle);
+			}
+		});
+}
+
+int32 FRewindBodyTimeline::AddStateBlock()
+{
+	if (NumStateBlocks == StateBlockCapacity)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FRewindBodyTimeline::AddStateBlock);
+
+		// Unwrap the blocks in use into a larger array; frames own blocks in order, so they are renumbered in one pass
+		const int32 NumBodies = GetNumBodies();
+		const int32 NewCapacity = FMath::Min(FMath::Max(StateBlockCapacity * 2, 16), Capacity);
+		TArray<FRewindBodyState> NewStates;
+		NewStates.SetNum(NewCapacity * NumBodies);
+		int32 NewBlock = 0;
+		for (int32 Index = 0; Index < NumFrames; ++Index)
+		{
+			FRewindBodyFrame& Frame = Frames[GetSlot(Index)];
+			if (Frame.StateBlock == INDEX_NONE) { continue; }
+
+			FMemory::Memcpy(&NewStates[NewBlock * NumBodies], &States[Frame.StateBlock * NumBodies], NumBodies * sizeof(FRewindBodyState));
+			Frame.StateBlock = NewBlock++;
+		}
+		States = MoveTemp(NewStates);
+		StateBlockCapacity = NewCapacity;
+		StateBlockHead = 0;
+	}
+
+	const int32 Block = (StateBlockHead + NumStateBlocks) % StateBlockCapacity;
+	++NumStateBlocks;
+	return Block;
+}
+
+void FRewindBodyTimeline::PopStateBlock()
+{
+	check(NumStateBlocks > 0);
+
+	StateBlockHead = (StateBlockHead + 1) % StateBlockCapacity;
+	--NumStateBlocks;
+}
+
+void FRewindBodyTimeline::PopFront()
+{
+	check(NumFrames > 0);
+
+	if (Frames[Head].StateBlock != INDEX_NONE) { PopStateBlock(); }
+	Head = (Head + 1) % Capacity;
+	--NumFrames;
+}
+
+void FRewindBodyTimeline::Truncate(int32 Count)
+{
+	// Blocks are released from the newest, just like the frames that own them
+	for (Count = FMath::Max(Count, 0); NumFrames > Count; --NumFrames)
+	{
+		if (Frames[GetSlot(NumFrames - 1)].StateBlock != INDEX_NONE) { --NumStateBlocks; }
+	}
+}
+
+void FRewindBodyTimeline::Empty()
+{
+	Head = 0;
+	NumFrames = 0;
+	StateBlockHead = 0;
+	NumStateBlocks = 0;
+}
+
+TArrayView<const FRewindBodyState> FRewindBodyTimeline::GetBodies(int32 Index) const
+{
+	check(Index >= 0 && Index < NumFrames);
+	const int32 Block = GetFrame(Index).StateBlock;
+	if (Block == INDEX_NONE) { return TArrayView<const FRewindBodyState>(); }
+	return TArrayView<const FRewindBodyState>(States.GetData() + Block * GetNumBodies(), GetNumBodies());
+}
+
+void FRewindBodyTimeline::SampleTransforms(int32 IndexA, int32 IndexB, float Alpha, TArray<FTransform>& OutTransforms) const
+{
+	if (GetFrame(IndexA).StateBlock == INDEX_NONE) { IndexA = IndexB; }
+	if (GetFrame(IndexB).StateBlock == INDEX_NONE) { IndexB = IndexA; }
+
+	const FVector OriginA = GetFrame(IndexA).Origin;
+	const FVector OriginB = GetFrame(IndexB).Origin;
+	TArrayView<const FRewindBodyState> BodiesA = GetBodies(IndexA);
+	TArrayView<const FRewindBodyState> BodiesB = GetBodies(IndexB);
+	check(BodiesA.Num() == GetNumBodies() && BodiesB.Num() == GetNumBodies());
+
+	OutTransforms.SetNumUninitialized(GetNumBodies(), false);
+	for (int32 BodyIndex = 0; BodyIndex < GetNumBodies(); ++BodyIndex)
+	{
+		const FVector LocationA = OriginA + FVector(BodiesA[BodyIndex].Location);
+		const FVector LocationB = OriginB + FVector(BodiesB[BodyIndex].Location);
+		const FQuat4f Rotation = FQuat4f::FastLerp(BodiesA[BodyIndex].Rotation, BodiesB[BodyIndex].Rotation, Alpha).GetNormalized();
+		OutTransforms[BodyIndex] = FTransform(FQuat(Rotation), FMath::Lerp(LocationA, LocationB, Alpha));
+	}
+}
+
+void FRewindBodyTimeline::Apply(int32 Index, USkeletalMeshComponent& Mesh, bool bRestoreSleepState) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindBodyTimeline::Apply);
+
+	check(IsCompatible(Mesh));
+
+	const FRewindBodyFrame& Frame = GetFrame(Index);
+	TArrayView<const FRewindBodyState> Bodies = GetBodies(Index);
+	if (Bodies.Num() == 0) { return; }
+	const bool bPutToSleep = bRestoreSleepState && Frame.bIsSleeping;
+	FPhysicsCommand::ExecuteWrite(
+		&Mesh,
+		[&]()
+		{
+			for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+			{
+				const FBodyInstance* Body = Mesh.Bodies[BodyIndex];
+				const FPhysicsActorHandle Handle = Body ? Body->GetPhysicsActorHandle() : nullptr;
+				if (!FPhysicsInterface::IsValid(Handle)) { continue; }
+
+				const FRewindBodyState& State = Bodies[BodyIndex];
+				const FTransform Pose(FQuat(State.Rotation), Frame.Origin + FVector(State.Location));
+				FPhysicsInterface::SetGlobalPose_AssumesLocked(Handle, Pose);
+				FPhysicsInterface::SetLinearVelocity_AssumesLocked(Handle, FVector(State.LinearVelocity));
+				FPhysicsInterface::SetAngularVelocity_AssumesLocked(Handle, FVector(State.AngularVelocityInRadians));
+				if (bPutToSleep) { FPhysicsInterface::PutToSleep_AssumesLocked(Handle); }
+			}
+		});
+}
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+// State of one rigid body of a physics asset; location is relative to the frame's origin to keep it at single precision
+struct FRewindBodyState
+{
+	FVector3f Location = FVector3f::ZeroVector;
+	FQuat4f Rotation = FQuat4f::Identity;
+	FVector3f LinearVelocity = FVector3f::ZeroVector;
+	FVector3f AngularVelocityInRadians = FVector3f::ZeroVector;
+};
+
+// State shared by all bodies of a frame
+struct FRewindBodyFrame
+{
+	// World location body locations are relative to
+	FVector Origin = FVector::ZeroVector;
+
+	// Whether the bodies were simulating (e.g. ragdolled) when the frame was recorded
+	bool bIsSimulating = false;
+
+	// Whether every body was asleep
+	bool bIsSleeping = false;
+
+	// Block of bodies holding the frame's state; only frames recorded while simulating have one
+	int32 StateBlock = INDEX_NONE;
+};
+
+/**
+ * Ring buffer of every rigid body of a skeletal mesh's physics asset.
+ *
+ * Each frame stores all bodies contiguously, so recording is one batched physics read into a single block and restoring
+ * is one batched physics write, no matter how many bodies the physics asset has. Bodies that follow animation are already
+ * covered by the pose, so frames recorded while not simulating store no bodies, and blocks are only allocated as frames
+ * that simulate need them. Frames are indexed from oldest to newest like the other rewind timelines.
+ */
+class REWIND_API FRewindBodyTimeline
+{
+public:
+	// Sizes the buffer for Capacity frames of Mesh's bodies and discards any history
+	void Initialize(const USkeletalMeshComponent& Mesh, int32 InCapacity);
+
+	// Returns whether frames recorded so far can be applied to Mesh's current bodies
+	bool IsCompatible(const USkeletalMeshComponent& Mesh) const;
+
+	int32 GetNumBodies() const { return BodyBoneIndices.Num(); }
+
+	int32 Num() const { return NumFrames; }
+
+	// Appends a frame, overwriting the oldest frame when full; if Mesh is simulating, every body is read in one physics read
+	void Record(USkeletalMeshComponent& Mesh);
+
+	// Removes the oldest frame
+	void PopFront();
+
+	// Keeps the oldest Count frames
+	void Truncate(int32 Count);
+
+	// Removes all frames
+	void Empty();
+
+	const FRewindBodyFrame& GetFrame(int32 Index) const { return Frames[GetSlot(Index)]; }
+
+	// Returns the bodies of a frame, in the order of the mesh's body instances; empty unless the frame was simulating
+	TArrayView<const FRewindBodyState> GetBodies(int32 Index) const;
+
+	// Blends the world transforms of the bodies in two frames into OutTransforms; at least one of them must be simulating,
+	// and a frame that wasn't takes the bodies of the other
+	void SampleTransforms(int32 IndexA, int32 IndexB, float Alpha, TArray<FTransform>& OutTransforms) const;
+
+	// Returns the body driving each bone of the mesh, or INDEX_NONE for bones without a body
+	TConstArrayView<int32> GetBoneBodyIndices() const { return BoneBodyIndices; }
+
+	// Writes the transforms and velocities of a simulating frame to all of Mesh's bodies in one physics write
+	void Apply(int32 Index, USkeletalMeshComponent& Mesh, bool bRestoreSleepState) const;
+
+	SIZE_T GetAllocatedSize() const { return Frames.GetAllocatedSize() + States.GetAllocatedSize(); }
+
+private:
+	int32 GetSlot(int32 Index) const { return (Head + Index) % Capacity; }
+
+	// Claims a block for the newest frame, growing the blocks if all of them are in use
+	int32 AddStateBlock();
+
+	// Releases the oldest block
+	void PopStateBlock();
+
+	// One entry per frame slot
+	TArray<FRewindBodyFrame> Frames;
+
+	// GetNumBodies() entries per block; blocks are used in the same order as the frames that own them
+	TArray<FRewindBodyState> States;
+	int32 StateBlockCapacity = 0;
+	int32 StateBlockHead = 0;
+	int32 NumStateBlocks = 0;
+
+	// Bone index of each body instance
+	TArray<int32> BodyBoneIndices;
+
+	// Body index of each bone
+	TArray<int32> BoneBodyIndices;
+
+	int32 Capacity = 0;
+	int32 Head = 0;
+	int32 NumFrames = 0;
+};
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace RewindChangeLog
+{
+	// Elements that moved less than this (cm) are treated as unchanged
+	constexpr float LocationTolerance = 0.01f;
+
+	// Quaternion component difference below which elements are treated as unrotated
+	constexpr float RotationTolerance = 1.e-4f;
+} // namespace RewindChangeLog
+
+/**
+ * Frames of changes to an array of elements, such as the instances of a mesh or the pieces of a geometry collection.
+ *
+ * Frames store only the elements that changed since the previous frame, with both their old and new values, so settled
+ * elements cost nothing and the owner's current state can be stepped to any frame in either direction by undoing or
+ * redoing changes. Changes are kept as structures of arrays. The owner holds the current state; the log only tracks
+ * which frame it belongs to.
+ */
+template <typename ValueType>
+class TRewindChangeLog
+{
+public:
+	int32 Num() const { return Frames.Num() - FirstFrame; }
+
+	// Frame the owner's current state belongs to
+	int32 GetCurrentIndex() const { return CurrentIndex; }
+
+	// Returns the newest frame with any changes; the owner's state at frames from it onwards is the same as at the newest
+	int32 GetNewestChangedIndex() const { return NewestChangedFrame >= FirstFrame ? NewestChangedFrame - FirstFrame : INDEX_NONE; }
+
+	// Appends an empty frame, which the current state then belongs to; must be at the newest frame
+	void AddFrame()
+	{
+		check(CurrentIndex == Num() - 1);
+		FFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.FirstChange = Elements.Num();
+		CurrentIndex = Num() - 1;
+	}
+
+	// Adds a change of an element to the newest frame
+	void AddChange(int32 Element, const ValueType& From, const ValueType& To)
+	{
+		Elements.Add(Element);
+		FromValues.Add(From);
+		ToValues.Add(To);
+		++Frames.Last().NumChanges;
+		NewestChangedFrame = Frames.Num() - 1;
+	}
+
+	// Removes the oldest frame
+	void PopFront()
+	{
+		check(Num() > 0);
+
+		++FirstFrame;
+		if (CurrentIndex != INDEX_NONE) { CurrentIndex = FMath::Max(CurrentIndex - 1, 0); }
+		if (Num() == 0)
+		{
+			Empty();
+			return;
+		}
+
+		// The oldest frame's changes lead from a frame that no longer exists, so they can't be played back either; release
+		// them along with the popped frames once they make up most of the arrays
+		if (FirstFrame > 64 && FirstFrame > Frames.Num() / 2)
+		{
+			const FFrame& OldestFrame = Frames[FirstFrame];
+			const int32 NumReleasedChanges = OldestFrame.FirstChange + OldestFrame.NumChanges;
+			Frames.RemoveAt(0, FirstFrame, false);
+			NewestChangedFrame = NewestChangedFrame > FirstFrame ? NewestChangedFrame - FirstFrame : INDEX_NONE;
+			FirstFrame = 0;
+			for (FFrame& Frame : Frames) { Frame.FirstChange = FMath::Max(Frame.FirstChange - NumReleasedChanges, 0); }
+			Frames[0].NumChanges = 0;
+
+			Elements.RemoveAt(0, NumReleasedChanges, false);
+			FromValues.RemoveAt(0, NumReleasedChanges, false);
+			ToValues.RemoveAt(0, NumReleasedChanges, false);
+		}
+	}
+
+	// Keeps the oldest Count frames; SetValue(int32 Element, const ValueType& Value) is called to step the owner's state
+	// back if it belongs to a removed frame
+	template <typename FunctionType>
+	void Truncate(int32 Count, FunctionType&& SetValue)
+	{
+		if (Count >= Num()) { return; }
+		if (Count <= 0)
+		{
+			Empty();
+			return;
+		}
+
+		// The current state must stay on a frame that still exists
+		if (CurrentIndex >= Count) { Seek(Count - 1, SetValue); }
+
+		Frames.SetNum(FirstFrame + Count, false);
+		const FFrame& NewestFrame = Frames.Last();
+		const int32 NumChanges = NewestFrame.FirstChange + NewestFrame.NumChanges;
+		Elements.SetNum(NumChanges, false);
+		FromValues.SetNum(NumChanges, false);
+		ToValues.SetNum(NumChanges, false);
+
+		while (NewestChangedFrame >= Frames.Num() || (NewestChangedFrame >= 0 && Frames[NewestChangedFrame].NumChanges == 0))
+		{
+			--NewestChangedFrame;
+		}
+	}
+
+	// Removes all frames, keeping the owner's current state as the starting point for new ones
+	void Empty()
+	{
+		Frames.Reset();
+		FirstFrame = 0;
+		Elements.Reset();
+		FromValues.Reset();
+		ToValues.Reset();
+		CurrentIndex = INDEX_NONE;
+		NewestChangedFrame = INDEX_NONE;
+	}
+
+	// Steps the owner's state to a frame; SetValue(int32 Element, const ValueType& Value) is called for every element
+	// changed on the way, oldest change last when walking back and newest change last when walking forward
+	template <typename FunctionType>
+	void Seek(int32 Index, FunctionType&& SetValue)
+	{
+		check(Index >= 0 && Index < Num() && CurrentIndex != INDEX_NONE);
+
+		// Undo changes walking back through time
+		for (; CurrentIndex > Index; --CurrentIndex)
+		{
+			const FFrame& Frame = Frames[FirstFrame + CurrentIndex];
+			for (int32 Change = Frame.FirstChange; Change < Frame.FirstChange + Frame.NumChanges; ++Change)
+			{
+				SetValue(Elements[Change], FromValues[Change]);
+			}
+		}
+
+		// Redo changes walking forward through time
+		for (; CurrentIndex < Index; ++CurrentIndex)
+		{
+			const FFrame& Frame = Frames[FirstFrame + CurrentIndex + 1];
+			for (int32 Change = Frame.FirstChange; Change < Frame.FirstChange + Frame.NumChanges; ++Change)
+			{
+				SetValue(Elements[Change], ToValues[Change]);
+			}
+		}
+	}
+
+	// Calls Function(int32 Element, const ValueType& From, const ValueType& To) for each change leading to a frame
+	template <typename FunctionType>
+	void ForEachChange(int32 Index, FunctionType&& Function) const
+	{
+		const FFrame& Frame = Frames[FirstFrame + Index];
+		for (int32 Change = Frame.FirstChange; Change < Frame.FirstChange + Frame.NumChanges; ++Change)
+		{
+			Function(Elements[Change], FromValues[Change], ToValues[Change]);
+		}
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Frames.GetAllocatedSize() + Elements.GetAllocatedSize() + FromValues.GetAllocatedSize() + ToValues.GetAllocatedSize();
+	}
+
+private:
+	struct FFrame
+	{
+		// Range in the change arrays of the elements that changed since the previous frame
+		int32 FirstChange = 0;
+		int32 NumChanges = 0;
+	};
+
+	// Frames in order; frames before FirstFrame have been released but not yet compacted
+	TArray<FFrame> Frames;
+	int32 FirstFrame = 0;
+
+	// Changes of all frames, in frame order
+	TArray<int32> Elements;
+	TArray<ValueType> FromValues;
+	TArray<ValueType> ToValues;
+
+	// Frame the owner's current state belongs to
+	int32 CurrentIndex = INDEX_NONE;
+
+	// Index in Frames of the newest frame with any changes
+	int32 NewestChangedFrame = INDEX_NONE;
+};
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindChannel.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "RewindPhysicsRecorder.h"
+
+namespace RewindChannel
+{
+	// Replaces the parts of Transform that aren't in Channels with those of Other
+	void MaskTransform(FTransform& Transform, const FTransform& Other, ERewindSnapshotChannels Channels)
+	{
+		if (!EnumHasAnyFlags(Channels, ERewindSnapshotChannels::Location)) { Transform.SetTranslation(Other.GetTranslation()); }
+		if (!EnumHasAnyFlags(Channels, ERewindSnapshotChannels::Rotation)) { Transform.SetRotation(Other.GetRotation()); }
+		if (!EnumHasAnyFlags(Channels, ERewindSnapshotChannels::Scale)) { Transform.SetScale3D(Other.GetScale3D()); }
+	}
+
+	// Returns the owner's transform in the space it is recorded in
+	FTransform GetOwnerTransform(const FRewindChannelContext& Context)
+	{
+		const AActor* Owner = Context.Owner;
+		return Context.bRelativeToAttachParent ? Owner->GetRootComponent()->GetRelativeTransform() : Owner->GetActorTransform();
+	}
+} // namespace RewindChannel
+
+FTransformAndVelocitySnapshot FRewindTransformAndVelocityPolicy::Capture(const FRewindChannelContext& Context)
+{
+	// Parts that aren't recorded hold constant values, which compressed pages store once rather than once per snapshot
+	const ERewindSnapshotChannels Channels = Context.Channels;
+	const UPrimitiveComponent* Root = Context.RootComponent;
+	FTransformAndVelocitySnapshot Snapshot;
+	Snapshot.TimeSinceLastSnapshot = Context.TimeSinceLastSnapshot;
+	if (const FRewindPhysicsSample* Sample = Context.PhysicsSample)
+	{
+		// The physics thread doesn't know the actor's scale, which is constant while simulating
+		Snapshot.Transform = FTransform(Sample->Rotation, Sample->Location, Context.Owner->GetActorScale3D());
+		Snapshot.LinearVelocity = Sample->LinearVelocity;
+		Snapshot.AngularVelocityInRadians = Sample->AngularVelocityInRadians;
+		Snapshot.bIsSleeping = Sample->bIsSleeping;
+	}
+	else
+	{
+		Snapshot.Transform = RewindChannel::GetOwnerTransform(Context);
+		if (Root)
+		{
+			Snapshot.LinearVelocity = Root->GetPhysicsLinearVelocity();
+			Snapshot.AngularVelocityInRadians = Root->GetPhysicsAngularVelocityInRadians();
+		}
+		Snapshot.bIsSleeping = Root && Root->IsSimulatingPhysics() && !Root->RigidBodyIsAwake();
+	}
+
+	if (!EnumHasAllFlags(Channels, ERewindSnapshotChannels::Transform))
+	{
+		RewindChannel::MaskTransform(Snapshot.Transform, Context.ReferenceTransform, Channels);
+	}
+	if (!EnumHasAnyFlags(Channels, ERewindSnapshotChannels::LinearVelocity)) { Snapshot.LinearVelocity = FVector::ZeroVector; }
+	if (!EnumHasAnyFlags(Channels, ERewindSnapshotChannels::AngularVelocity)) { Snapshot.AngularVelocityInRadians = FVector::ZeroVector; }
+	return Snapshot;
+}
+
+FTransformAndVelocitySnapshot FRewindTransformAndVelocityPolicy::Blend(
+	const FTransformAndVelocitySnapshot& A,
+	const FTransformAndVelocitySnapshot& B,
+	float Alpha)
+{
+	FTransformAndVelocitySnapshot BlendedSnapshot;
+	BlendedSnapshot.Transform.Blend(A.Transform, B.Transform, Alpha);
+	BlendedSnapshot.LinearVelocity = FMath::Lerp(A.LinearVelocity, B.LinearVelocity, Alpha);
+	BlendedSnapshot.AngularVelocityInRadians = FMath::Lerp(A.AngularVelocityInRadians, B.AngularVelocityInRadians, Alpha);
+	BlendedSnapshot.bIsSleeping = Alpha < 0.5f ? A.bIsSleeping : B.bIsSleeping;
+	return BlendedSnapshot;
+}
+
+void FRewindTransformAndVelocityPolicy::Apply(
+	const FRewindChannelContext& Context,
+	const FTransformAndVelocitySnapshot& Snapshot,
+	ERewindApplyMode Mode)
+{
+	// Parts that aren't recorded keep whatever value the owner has now
+	const ERewindSnapshotChannels Channels = Context.Channels;
+	FTransform Transform = Snapshot.Transform;
+	if (!EnumHasAllFlags(Channels, ERewindSnapshotChannels::Transform))
+	{
+		RewindChannel::MaskTransform(Transform, RewindChannel::GetOwnerTransform(Context), Channels);
+	}
+
+	// Attached actors follow their parent, which is rewound by its own timeline
+	if (Context.bRelativeToAttachParent) { Context.Owner->SetActorRelativeTransform(Transform); }
+	else { Context.Owner->SetActorTransform(Transform); }
+
+	UPrimitiveComponent* Root = Context.RootComponent;
+	if (!Root || Mode != ERewindApplyMode::Resume) { return; }
+
+	if (EnumHasAnyFlags(Channels, ERewindSnapshotChannels::LinearVelocity)) { Root->SetPhysicsLinearVelocity(Snapshot.LinearVelocity); }
+	if (EnumHasAnyFlags(Channels, ERewindSnapshotChannels::AngularVelocity))
+	{
+		Root->SetPhysicsAngularVelocityInRadians(Snapshot.AngularVelocityInRadians);
+	}
+
+	// Settled bodies go straight back to sleep instead of simulating, and often jittering, until they settle again;
+	// bodies that were barely moving can optionally be treated as settled too
+	const float Threshold = Context.RestoreSleepSpeedThreshold;
+	const bool bWasAtRest = Threshold > 0.0f && Snapshot.LinearVelocity.SizeSquared() < FMath::Square(Threshold)
+		&& Snapshot.AngularVelocityInRadians.SizeSquared() < FMath::Square(FMath::DegreesToRadians(Threshold));
+	if (Context.bRestoreSleepState && (Snapshot.bIsSleeping || bWasAtRest)) { Root->PutRigidBodyToSleep(); }
+}
+
+FMovementVelocityAndModeSnapshot FRewindMovementVelocityAndModePolicy::Capture(const FRewindChannelContext& Context)
+{
+	FMovementVelocityAndModeSnapshot Snapshot;
+	Snapshot.TimeSinceLastSnapshot = Context.TimeSinceLastSnapshot;
+	Snapshot.MovementVelocity = Context.MovementComponent->Velocity;
+	return Snapshot;
+}
+
+FMovementVelocityAndModeSnapshot FRewindMovementVelocityAndModePolicy::Blend(
+	const FMovementVelocityAndModeSnapshot& A,
+	const FMovementVelocityAndModeSnapshot& B,
+	float Alpha)
+{
+	FMovementVelocityAndModeSnapshot BlendedSnapshot;
+	BlendedSnapshot.MovementVelocity = FMath::Lerp(A.MovementVelocity, B.MovementVelocity, Alpha);
+	return BlendedSnapshot;
+}
+
+void FRewindMovementVelocityAndModePolicy::Apply(
+	const FRewindChannelContext& Context,
+	const FMovementVelocityAndModeSnapshot& Snapshot,
+	ERewindApplyMode Mode)
+{
+	// Playback velocity follows the global rewind speed
+	UCharacterMovementComponent* Movement = Context.MovementComponent;
+	Movement->Velocity = Mode == ERewindApplyMode::Playback ? Snapshot.MovementVelocity * Context.RewindSpeed : Snapshot.MovementVelocity;
+
+	// Mode transitions are only applied when the mode at the playhead changes; movement that keeps simulating during
+	// playback can also change its own mode as the owner is moved around, which this undoes
+	if (Movement->MovementMode != Context.MovementMode || Movement->CustomMovementMode != Context.CustomMovementMode)
+	{
+		Movement->SetMovementMode(Context.MovementMode, Context.CustomMovementMode);
+	}
+}
@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RewindSnapshots.h"
+#include "RewindTimeline.h"
+
+class AActor;
+class UCharacterMovementComponent;
+class UPrimitiveComponent;
+struct FRewindPhysicsSample;
+
+// Why a snapshot is being applied
+enum class ERewindApplyMode : uint8
+{
+	// Playing through history; the owner is posed without touching simulation state
+	Playback,
+
+	// Time is about to flow normally from the snapshot; simulation state such as velocity and sleep is restored too
+	Resume,
+};
+
+// Everything channel policies capture state from and apply it to
+struct FRewindChannelContext
+{
+	AActor* Owner = nullptr;
+	UPrimitiveComponent* RootComponent = nullptr;
+	UCharacterMovementComponent* MovementComponent = nullptr;
+
+	// Time since the previous snapshot, stored with captured snapshots
+	float TimeSinceLastSnapshot = 0.0f;
+
+	// Global rewind speed, applied to movement velocity during playback
+	float RewindSpeed = 1.0f;
+
+	// Movement mode at the playhead, kept up to date by the movement mode events the playhead crosses
+	TEnumAsByte<EMovementMode> MovementMode = MOVE_None;
+	uint8 CustomMovementMode = 0;
+
+	// Sleep restoration settings of the owning rewind component
+	bool bRestoreSleepState = true;
+	float RestoreSleepSpeedThreshold = 0.0f;
+
+	// Whether the owner's transform is recorded and applied relative to the rewindable actor it is attached to
+	bool bRelativeToAttachParent = false;
+
+	// Parts of the owner's transform and velocity that are recorded and applied; the rest are captured as
+	// ReferenceTransform and zero velocity, and left untouched when applying
+	ERewindSnapshotChannels Channels = ERewindSnapshotChannels::All;
+	FTransform ReferenceTransform = FTransform::Identity;
+
+	// Root body state sampled on the physics thread, captured instead of the body's current state when set
+	const FRewindPhysicsSample* PhysicsSample = nullptr;
+};
+
+/**
+ * Timeline of one kind of rewindable state, along with how that state is captured, blended and applied.
+ *
+ * PolicyType provides:
+ *   static SnapshotType Capture(const FRewindChannelContext& Context);
+ *   static SnapshotType Blend(const SnapshotType& A, const SnapshotType& B, float Alpha);
+ *   static void Apply(const FRewindChannelContext& Context, const SnapshotType& Snapshot, ERewindApplyMode Mode);
+ *
+ * Channels are timelines, so they can be spilled, branched and serialized like any other timeline.
+ */
+template <typename SnapshotType, typename PolicyType>
+class TRewindChannel : public TRewindTimeline<SnapshotType>
+{
+public:
+	// Appends a snapshot captured from Context and returns its index
+	int32 Record(const FRewindChannelContext& Context) { return this->Emplace(PolicyType::Capture(Context)); }
+
+	// Applies the blend of two snapshots, or a single snapshot when both indices match
+	void Apply(const FRewindChannelContext& Context, int32 IndexA, int32 IndexB, float Alpha, ERewindApplyMode Mode) const
+	{
+		if (IndexA == IndexB) { PolicyType::Apply(Context, (*this)[IndexA], Mode); }
+		else { PolicyType::Apply(Context, PolicyType::Blend((*this)[IndexA], (*this)[IndexB], FMath::Clamp(Alpha, 0.0f, 1.0f)), Mode); }
+	}
+};
+
+/**
+ * Channels of an owner that share one timeline index; each of ChannelMembers points to a TRewindChannel member.
+ *
+ * Every operation is a fold over the members, so each composition compiles to straight-line code without per-channel
+ * checks, and owners composing fewer channels do strictly less work.
+ */
+template <auto... ChannelMembers>
+struct TRewindChannelSet
+{
+	static_assert(sizeof...(ChannelMembers) > 0, "Channel sets need at least one channel to index the timeline");
+
+	template <typename OwnerType>
+	static int32 Record(OwnerType& Owner, const FRewindChannelContext& Context)
+	{
+		const int32 Indices[] = { (Owner.*ChannelMembers).Record(Context)... };
+		for (const int32 Index : Indices) { check(Index == Indices[0]); }
+		return Indices[0];
+	}
+
+	template <typename OwnerType>
+	static void Apply(
+		OwnerType& Owner,
+		const FRewindChannelContext& Context,
+		int32 IndexA,
+		int32 IndexB,
+		float Alpha,
+		ERewindApplyMode Mode)
+	{
+		((Owner.*ChannelMembers).Apply(Context, IndexA, IndexB, Alpha, Mode), ...);
+	}
+
+	template <typename OwnerType>
+	static void PopFront(OwnerType& Owner)
+	{
+		((Owner.*ChannelMembers).PopFront(), ...);
+	}
+
+	template <typename OwnerType>
+	static void Truncate(OwnerType& Owner, int32 Count)
+	{
+		((Owner.*ChannelMembers).Truncate(Count), ...);
+	}
+};
+
+/**
+ * Timeline an owner records alongside its channel set that only covers the newest snapshots, such as poses, bodies or
+ * properties; snapshots older than its oldest frame, such as those streamed back in by the flight recorder, hold that
+ * frame. TimelineMember points to a member providing Num, PopFront, Truncate and Empty.
+ *
+ * Record and Apply are optional: timelines applied together with other state, like poses and bodies, are only kept in
+ * step through the channel ops and applied by their owner, which aligns indices with AlignIndex.
+ */
+template <typename OwnerType>
+struct TRewindAlignedChannel
+{
+	int32 (*Num)(const OwnerType&) = nullptr;
+	void (*PopFront)(OwnerType&) = nullptr;
+	void (*Truncate)(OwnerType&, int32) = nullptr;
+	void (*Empty)(OwnerType&) = nullptr;
+
+	// Appends the state at the newest snapshot
+	void (*Record)(OwnerType&) = nullptr;
+
+	// Applies the blend of two frames, already aligned with the snapshots being applied
+	void (*Apply)(OwnerType&, int32, int32, float) = nullptr;
+
+	// Returns the frame of a timeline of NumFrames frames that belongs to a snapshot of NumSnapshots snapshots
+	static int32 AlignIndex(int32 SnapshotIndex, int32 NumSnapshots, int32 NumFrames)
+	{
+		return FMath::Max(SnapshotIndex - (NumSnapshots - NumFrames), 0);
+	}
+
+	template <auto TimelineMember>
+	static TRewindAlignedChannel Make(void (*InRecord)(OwnerType&), void (*InApply)(OwnerType&, int32, int32, float))
+	{
+		TRewindAlignedChannel Channel;
+		Channel.Num = [](const OwnerType& Owner) { return (Owner.*TimelineMember).Num(); };
+		Channel.PopFront = [](OwnerType& Owner) { (Owner.*TimelineMember).PopFront(); };
+		Channel.Truncate = [](OwnerType& Owner, int32 Count) { (Owner.*TimelineMember).Truncate(Count); };
+		Channel.Empty = [](OwnerType& Owner) { (Owner.*TimelineMember).Empty(); };
+		Channel.Record = InRecord;
+		Channel.Apply = InApply;
+		return Channel;
+	}
+};
+
+/**
+ * Entry points of the channel set an owner chose at runtime; one indirect call per operation, whatever the composition.
+ *
+ * Aligned channels are registered individually, since which of them an owner records depends on its configuration and
+ * components. The aligned operations take the number of snapshots in the channel set, which is what aligns them.
+ */
+template <typename OwnerType>
+struct TRewindChannelOps
+{
+	int32 (*Record)(OwnerType&, const FRewindChannelContext&) = nullptr;
+	void (*Apply)(OwnerType&, const FRewindChannelContext&, int32, int32, float, ERewindApplyMode) = nullptr;
+	void (*PopFront)(OwnerType&) = nullptr;
+	void (*Truncate)(OwnerType&, int32) = nullptr;
+
+	// Timelines recorded alongside the channel set that only cover the newest snapshots
+	TArray<TRewindAlignedChannel<OwnerType>, TInlineAllocator<6>> AlignedChannels;
+
+	bool IsSet() const { return Record != nullptr; }
+
+	template <typename ChannelSetType>
+	static TRewindChannelOps Make()
+	{
+		TRewindChannelOps Ops;
+		Ops.Record = &ChannelSetType::template Record<OwnerType>;
+		Ops.Apply = &ChannelSetType::template Apply<OwnerType>;
+		Ops.PopFront = &ChannelSetType::template PopFront<OwnerType>;
+		Ops.Truncate = &ChannelSetType::template Truncate<OwnerType>;
+		return Ops;
+	}
+
+	void RecordAligned(OwnerType& Owner) const
+	{
+		for (const TRewindAlignedChannel<OwnerType>& Channel : AlignedChannels)
+		{
+			if (Channel.Record) { Channel.Record(Owner); }
+		}
+	}
+
+	void ApplyAligned(OwnerType& Owner, int32 NumSnapshots, int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha) const
+	{
+		for (const TRewindAlignedChannel<OwnerType>& Channel : AlignedChannels)
+		{
+			const int32 NumFrames = Channel.Num(Owner);
+			if (!Channel.Apply || NumFrames == 0) { continue; }
+
+			const int32 IndexA = TRewindAlignedChannel<OwnerType>::AlignIndex(SnapshotIndexA, NumSnapshots, NumFrames);
+			const int32 IndexB = TRewindAlignedChannel<OwnerType>::AlignIndex(SnapshotIndexB, NumSnapshots, NumFrames);
+			Channel.Apply(Owner, IndexA, IndexB, Alpha);
+		}
+	}
+
+	// Call before popping the channel set; the oldest snapshot only has a frame if every snapshot does
+	void PopFrontAligned(OwnerType& Owner, int32 NumSnapshots) const
+	{
+		for (const TRewindAlignedChannel<OwnerType>& Channel : AlignedChannels)
+		{
+			if (Channel.Num(Owner) == NumSnapshots) { Channel.PopFront(Owner); }
+		}
+	}
+
+	// Aligned channels cover the newest snapshots, so they lose as many as the snapshots do
+	void TruncateAligned(OwnerType& Owner, int32 NumSnapshotsRemoved) const
+	{
+		for (const TRewindAlignedChannel<OwnerType>& Channel : AlignedChannels)
+		{
+			Channel.Truncate(Owner, Channel.Num(Owner) - NumSnapshotsRemoved);
+		}
+	}
+
+	void EmptyAligned(OwnerType& Owner) const
+	{
+		for (const TRewindAlignedChannel<OwnerType>& Channel : AlignedChannels) { Channel.Empty(Owner); }
+	}
+};
+
+// Owner transform and root body velocity
+struct REWIND_API FRewindTransformAndVelocityPolicy
+{
+	static FTransformAndVelocitySnapshot Capture(const FRewindChannelContext& Context);
+	static FTransformAndVelocitySnapshot Blend(const FTransformAndVelocitySnapshot& A, const FTransformAndVelocitySnapshot& B, float Alpha);
+	static void Apply(const FRewindChannelContext& Context, const FTransformAndVelocitySnapshot& Snapshot, ERewindApplyMode Mode);
+};
+
+// Character movement velocity; the mode comes from the context
+struct REWIND_API FRewindMovementVelocityAndModePolicy
+{
+	static FMovementVelocityAndModeSnapshot Capture(const FRewindChannelContext& Context);
+	static FMovementVelocityAndModeSnapshot Blend(
+		const FMovementVelocityAndModeSnapshot& A,
+		const FMovementVelocityAndModeSnapshot& B,
+		float Alpha);
+	static void Apply(const FRewindChannelContext& Context, const FMovementVelocityAndModeSnapshot& Snapshot, ERewindApplyMode Mode);
+};
+
+using FRewindTransformAndVelocityChannel = TRewindChannel<FTransformAndVelocitySnapshot, FRewindTransformAndVelocityPolicy>;
+using FRewindMovementVelocityAndModeChannel = TRewindChannel<FMovementVelocityAndModeSnapshot, FRewindMovementVelocityAndModePolicy>;
@@ -13,6 +13,7 @@
 #include "InputActionValue.h"
 #include "RewindComponent.h"
 #include "RewindGameMode.h"
+#include "RewindInputRecorderComponent.h"
 #include "RewindVisualizationComponent.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
@@ -67,6 +68,9 @@ ARewindCharacter::ARewindCharacter()
 	// Setup a rewind visualization component that draws a static mesh instance for each snapshot
 	RewindVisualizationComponent = CreateDefaultSubobject<URewindVisualizationComponent>(TEXT("RewindVisualizationComponent"));
 	RewindVisualizationComponent->SetupAttachment(RootComponent);
+
+	// Setup an input recorder for regression runs driven from the command line
+	InputRecorderComponent = CreateDefaultSubobject<URewindInputRecorderComponent>(TEXT("InputRecorderComponent"));
 }
 
 void ARewindCharacter::BeginPlay()
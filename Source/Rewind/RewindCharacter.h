@@ -17,6 +17,7 @@ class UInputMappingContext;
 class UInputAction;
 class URewindComponent;
 class URewindVisualizationComponent;
+class URewindInputRecorderComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -41,6 +42,10 @@ class ARewindCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (AllowPrivateAccess = "true"))
 	URewindVisualizationComponent* RewindVisualizationComponent;
 
+	// Component for recording the player's input and replaying it without a player
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (AllowPrivateAccess = "true"))
+	URewindInputRecorderComponent* InputRecorderComponent;
+
 	/** MappingContext */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputMappingContext* DefaultMappingContext;
@@ -2,9 +2,11 @@
 
 #include "RewindComponent.h"
 
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "DrawDebugHelpers.h"
+#include "Engine/SkinnedAsset.h"
 #include "Engine/StaticMeshActor.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
@@ -12,10 +14,68 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/MovementComponent.h"
 #include "GameFramework/PawnMovementComponent.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "Rewind.h"
 #include "RewindCharacter.h"
 #include "RewindGameMode.h"
+#include "RewindPhysicsRecorder.h"
 #include "RewindVisualizationComponent.h"
 
+namespace RewindComponent
+{
+	// Snapshot times rebuilt from the time between snapshots drift from event times by rounding; mode changes are recorded
+	// on the frame of a snapshot, so changes this close after a snapshot's time belong to it
+	constexpr double EventTimeTolerance = 1.e-3;
+
+	using FAlignedChannel = TRewindAlignedChannel<URewindComponent>;
+} // namespace RewindComponent
+
+template <typename FunctionType>
+void URewindComponent::ForEachMovementModeChange(double FromTime, double ToTime, bool bReverse, FunctionType&& Function) const
+{
+	// Changes just after a snapshot's time belong to it
+	const double From = FromTime + RewindComponent::EventTimeTolerance;
+	const double To = ToTime + RewindComponent::EventTimeTolerance;
+
+	// Changes restored with a branch replace this component's events on the track up to when the branch was restored
+	const double RestoredTo = RestoredMovementModeTime + RewindComponent::EventTimeTolerance;
+	const auto VisitRestored = [this, From, To, bReverse, &Function]()
+	{
+		const int32 NumChanges = RestoredMovementModeChanges.Num();
+		for (int32 Step = 0; Step < NumChanges; ++Step)
+		{
+			const TPair<double, FRewindMovementModeChange>& Change = RestoredMovementModeChanges[bReverse ? NumChanges - 1 - Step : Step];
+			if (Change.Key > From && Change.Key <= To) { Function(Change.Value, Change.Key); }
+		}
+	};
+	const auto VisitTrack = [this, From, To, RestoredTo, bReverse, &Function]()
+	{
+		if (To <= RestoredTo) { return; }
+		GameMode->GetEventTrack().ForEachEvent(
+			FMath::Max(From, RestoredTo),
+			To,
+			bReverse,
+			[this, &Function](const FRewindEventView& Event)
+			{
+				if (Event.Target == this && Event.Type == MovementModeEventType)
+				{
+					Function(*static_cast<const FRewindMovementModeChange*>(Event.Payload), Event.Time);
+				}
+				return true;
+			});
+	};
+	if (bReverse)
+	{
+		VisitTrack();
+		VisitRestored();
+	}
+	else
+	{
+		VisitRestored();
+		VisitTrack();
+	}
+}
+
 URewindComponent::URewindComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -51,24 +111,143 @@ void URewindComponent::BeginPlay()
 		OwnerMovementComponent = Character ? Cast<UCharacterMovementComponent>(Character->GetMovementComponent()) : nullptr;
 	}
 
-	// If configured to pause animations, grab the owner's skeletal mesh
-	if (bPauseAnimationDuringTimeScrubbing) { OwnerSkeletalMesh = Character ? Character->GetMesh() : nullptr; }
-
-	// Bind to rewind/time scrub start/complete events on the game mode
-	GameMode->OnGlobalRewindStarted.AddUniqueDynamic(this, &URewindComponent::OnGlobalRewindStarted);
-	GameMode->OnGlobalRewindCompleted.AddUniqueDynamic(this, &URewindComponent::OnGlobalRewindCompleted);
-	GameMode->OnGlobalFastForwardStarted.AddUniqueDynamic(this, &URewindComponent::OnGlobalFastForwardStarted);
-	GameMode->OnGlobalFastForwardCompleted.AddUniqueDynamic(this, &URewindComponent::OnGlobalFastForwardCompleted);
-	GameMode->OnGlobalTimeScrubStarted.AddUniqueDynamic(this, &URewindComponent::OnGlobalTimeScrubStarted);
-	GameMode->OnGlobalTimeScrubCompleted.AddUniqueDynamic(this, &URewindComponent::OnGlobalTimeScrubCompleted);
-	
-	// Bind to timeline visualization events on the game mode
-	GameMode->OnGlobalTimelineVisualizationEnabled.AddUniqueDynamic(this, &URewindComponent::OnGlobalTimelineVisualizationEnabled);
-	GameMode->OnGlobalTimelineVisualizationDisabled.AddUniqueDynamic(this, &URewindComponent::OnGlobalTimelineVisualizationDisabled);
+	// Store only the recorded channels that vary, starting from none when detecting invariant channels
+	UpdateRecordingSpace();
+	ReferenceTransform = IsRecordingRelativeToAttachParent() ? GetOwner()->GetRootComponent()->GetRelativeTransform()
+															 : GetOwner()->GetActorTransform();
+	ActiveChannels = bDetectInvariantChannels ? static_cast<int32>(ERewindSnapshotChannels::None) : RecordedChannels;
+	if (bDetectInvariantChannels) { DetectVaryingChannels(); }
+
+	// Compose snapshot channels once, so recording and playback never check which kinds of state this component rewinds
+	if (OwnerMovementComponent)
+	{
+		MovementMode = OwnerMovementComponent->MovementMode;
+		CustomMovementMode = OwnerMovementComponent->CustomMovementMode;
+		MovementModeEventType =
+			GameMode->GetEventTrack().RegisterEventType(TEXT("MovementMode"), &URewindComponent::HandleMovementModeEvent);
+
+		using FChannelSet =
+			TRewindChannelSet<&URewindComponent::TransformAndVelocitySnapshots, &URewindComponent::MovementVelocityAndModeSnapshots>;
+		ChannelOps = TRewindChannelOps<URewindComponent>::Make<FChannelSet>();
+	}
+	else { ChannelOps = TRewindChannelOps<URewindComponent>::Make<TRewindChannelSet<&URewindComponent::TransformAndVelocitySnapshots>>(); }
+
+	// If configured to pause animations or record poses or bodies, grab the owner's skeletal mesh
+	if (bPauseAnimationDuringTimeScrubbing || bRecordPose || bRecordPhysicsAssetBodies) { OwnerSkeletalMesh = Character ? Character->GetMesh() : nullptr; }
+
+	// If configured to record instances, grab the owner's instanced static mesh, skipping the timeline visualization
+	if (bRecordInstances)
+	{
+		TInlineComponentArray<UInstancedStaticMeshComponent*> InstancedMeshes(GetOwner());
+		for (UInstancedStaticMeshComponent* InstancedMesh : InstancedMeshes)
+		{
+			if (!InstancedMesh->IsA<URewindVisualizationComponent>())
+			{
+				OwnerInstancedMesh = InstancedMesh;
+				break;
+			}
+		}
+	}
+
+	// If configured to record fracture, grab the owner's geometry collection
+	if (bRecordFracture) { OwnerGeometryCollection = GetOwner()->FindComponentByClass<UGeometryCollectionComponent>(); }
+
+	// Register with the game mode, which drives global rewind/time scrub/visualization state changes natively
+	GameMode->RegisterRewindComponent(this);
 	bIsVisualizingTimeline = GameMode->IsGlobalTimelineVisualizationEnabled();
 
+	// Record at full rate until the game mode evaluates significance
+	SnapshotIntervalSeconds = SnapshotFrequencySeconds;
+
+	// Spread the first snapshot of components across the snapshot interval using a low discrepancy sequence
+	constexpr float GoldenRatioConjugate = 0.618034f;
+	RecordingPhaseSeconds =
+		GameMode->bStaggerRecording ? SnapshotFrequencySeconds * FMath::Frac(RegistryIndex * GoldenRatioConjugate) : 0.0f;
+
 	// Preallocate the space required in the ring buffers
 	InitializeRingBuffers(GameMode->MaxRewindSeconds);
+
+	// Attachment is only tracked for owners that can be attached
+	if (bRecordRelativeToAttachParent && GetOwner()->GetRootComponent())
+	{
+		AttachmentTimeline.Initialize(MaxSnapshots, GameMode->bEnableFlightRecorder);
+	}
+
+	// Resolve rewound property paths once, so recording them is a plain copy
+	if (RewoundProperties.Num() > 0) { PropertyTimeline.Compile(*GetOwner(), RewoundProperties, MaxSnapshots); }
+
+	// Optional timelines only cover the newest snapshots; registering them with the channels keeps them in step however the
+	// snapshots are dropped, erased or replaced
+	using RewindComponent::FAlignedChannel;
+	if (AttachmentTimeline.IsInitialized())
+	{
+		ChannelOps.AlignedChannels.Add(FAlignedChannel::Make<&URewindComponent::AttachmentTimeline>(
+			[](URewindComponent& Owner) { Owner.AttachmentTimeline.Record(*Owner.GetOwner()->GetRootComponent()); }, nullptr));
+	}
+	if (bRecordPose && OwnerSkeletalMesh)
+	{
+		ChannelOps.AlignedChannels.Add(
+			FAlignedChannel::Make<&URewindComponent::PoseTimeline>([](URewindComponent& Owner) { Owner.RecordPose(); }, nullptr));
+	}
+	if (bRecordPhysicsAssetBodies && OwnerSkeletalMesh)
+	{
+		ChannelOps.AlignedChannels.Add(
+			FAlignedChannel::Make<&URewindComponent::BodyTimeline>([](URewindComponent& Owner) { Owner.RecordBodies(); }, nullptr));
+	}
+	if (bRecordInstances && OwnerInstancedMesh)
+	{
+		ChannelOps.AlignedChannels.Add(FAlignedChannel::Make<&URewindComponent::InstanceTimeline>(
+			[](URewindComponent& Owner) { Owner.RecordInstances(); },
+			[](URewindComponent& Owner, int32 IndexA, int32 IndexB, float Alpha)
+			{ Owner.InstanceTimeline.Apply(IndexA, IndexB, Alpha, *Owner.OwnerInstancedMesh); }));
+	}
+	if (bRecordFracture && OwnerGeometryCollection)
+	{
+		ChannelOps.AlignedChannels.Add(FAlignedChannel::Make<&URewindComponent::FractureTimeline>(
+			[](URewindComponent& Owner) { Owner.RecordFracture(); },
+			[](URewindComponent& Owner, int32 IndexA, int32 IndexB, float Alpha) { Owner.ApplyFracture(IndexA, IndexB, Alpha); }));
+	}
+	if (PropertyTimeline.HasProperties())
+	{
+		ChannelOps.AlignedChannels.Add(FAlignedChannel::Make<&URewindComponent::PropertyTimeline>(
+			[](URewindComponent& Owner) { Owner.PropertyTimeline.Record(); },
+			[](URewindComponent& Owner, int32 IndexA, int32 IndexB, float Alpha) { Owner.PropertyTimeline.Apply(IndexA, IndexB, Alpha); }));
+	}
+
+	// Compress snapshots once they age out of the raw window; decompression happens ahead of the playhead while rewinding
+	const int32 RawWindowSnapshots = FMath::CeilToInt32(GameMode->RawSnapshotWindowSeconds / SnapshotFrequencySeconds);
+	TransformAndVelocitySnapshots.SetCompression(GameMode->bCompressAgedSnapshots, RawWindowSnapshots, RawWindowSnapshots);
+	MovementVelocityAndModeSnapshots.SetCompression(GameMode->bCompressAgedSnapshots, RawWindowSnapshots, RawWindowSnapshots);
+
+	// Physics driven props can be sampled at the fixed physics step rather than read back on the game thread
+	if (bRecordOnPhysicsThread && !bSnapshotMovementVelocityAndMode) { RegisterPhysicsBody(); }
+
+	// Spill snapshots older than MaxRewindSeconds to disk instead of dropping them
+	if (GameMode->bEnableFlightRecorder) { FlightRecorder.Initialize(GameMode->GetOrCreateSpillFile(), GameMode->FlightRecorderBlockSnapshots); }
+
+	// Owners streamed back in pick up the history they had when their level was unloaded
+	GameMode->RestoreUnloadedTimeline(*this);
+
+	// Actors spawned within the rewind window are removed again by rewinding past their spawn
+	GameMode->RecordActorSpawned(*this);
+}
+
+void URewindComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (GameMode)
+	{
+		// The game mode keeps the timeline of destroyed owners, so rewinding past their destruction can resurrect them
+		if (EndPlayReason == EEndPlayReason::Destroyed) { GameMode->RecordActorDestroyed(*this); }
+
+		// Streaming levels and World Partition cells unload their actors, which keep their history until they stream back in
+		else if (EndPlayReason == EEndPlayReason::RemovedFromWorld) { GameMode->StoreUnloadedTimeline(*this); }
+		GameMode->UnregisterRewindComponent(this);
+	}
+
+	// Must happen before the owner's physics state is destroyed
+	UnregisterPhysicsBody();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void URewindComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -77,10 +256,21 @@ void URewindComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (bIsRewinding) { PlaySnapshots(DeltaTime, true /*bRewinding*/); }
-	else if (bIsFastForwarding) { PlaySnapshots(DeltaTime, false /*bRewinding*/); }
-	else if (bIsTimeScrubbing) { PauseTime(DeltaTime, bLastTimeManipulationWasRewind); }
-	else { RecordSnapshot(DeltaTime); }
+	if (!IsTimeBeingManipulated()) { RecordSnapshot(DeltaTime); }
+	else if (ConsumePlaybackDeltaTime(DeltaTime))
+	{
+		if (bIsRewinding) { PlaySnapshots(DeltaTime, true /*bRewinding*/); }
+		else if (bIsFastForwarding) { PlaySnapshots(DeltaTime, false /*bRewinding*/); }
+		else { PauseTime(DeltaTime, bLastTimeManipulationWasRewind); }
+	}
+
+	const int32 PlayheadIndex = IsTimeBeingManipulated() ? LatestSnapshotIndex : INDEX_NONE;
+	TransformAndVelocitySnapshots.UpdateCompression(PlayheadIndex);
+	MovementVelocityAndModeSnapshots.UpdateCompression(PlayheadIndex);
+
+	// Hand this frame's window to concurrent readers; no-op unless a read handle has been requested
+	TransformAndVelocitySnapshots.Publish();
+	MovementVelocityAndModeSnapshots.Publish();
 
 	if (bIsVisualizingTimeline) { VisualizeTimeline(); }
 }
@@ -114,6 +304,24 @@ void URewindComponent::SetIsRewindingEnabled(bool bEnabled)
 	}
 }
 
+void URewindComponent::SetSignificance(ERewindSignificance InSignificance, const FRewindSignificanceTierSettings& Settings)
+{
+	// Snapshots store the time since the previous one, so the recording rate can change at any point without
+	// invalidating the timeline; playback keeps accumulating skipped time, so it stays in sync across tier changes
+	Significance = InSignificance;
+	SnapshotIntervalSeconds = SnapshotFrequencySeconds * FMath::Max(Settings.RecordRateDivisor, 1);
+	const int32 PreviousPlaybackFrameInterval = PlaybackFrameInterval;
+	PlaybackFrameInterval = FMath::Max(Settings.PlaybackFrameInterval, 1);
+	if (PhysicsBodyBuffer) { PhysicsBodyBuffer->IntervalSeconds = SnapshotIntervalSeconds; }
+
+	// Stagger playback updates across components sharing a tier; only on entering it, as restarting the count on every
+	// evaluation would delay updates
+	if (PlaybackFrameInterval != PreviousPlaybackFrameInterval && PlaybackFrameInterval > 1 && RegistryIndex != INDEX_NONE)
+	{
+		PlaybackFramesSinceUpdate = RegistryIndex % PlaybackFrameInterval;
+	}
+}
+
 void URewindComponent::OnGlobalRewindStarted()
 {
 	// Attempt to start rewinding; reset TimeSinceSnapshostsChanged if not time scrubbing
@@ -251,51 +459,448 @@ void URewindComponent::RecordSnapshot(float DeltaTime)
 
 	TimeSinceSnapshotsChanged += DeltaTime;
 
+	// The physics thread has already done the sampling; recording is just a drain
+	if (PhysicsBodyBuffer)
+	{
+		RecordPhysicsSamples();
+		return;
+	}
+
 	// Early out if last snapshot was taken within the desired snapshot cadence
-	if (TimeSinceSnapshotsChanged < SnapshotFrequencySeconds && TransformAndVelocitySnapshots.Num() != 0) { return; }
+	if (TimeSinceSnapshotsChanged < GetSnapshotDueSeconds()) { return; }
 
-	// If the buffer is full, drop the oldest snapshot
-	if (TransformAndVelocitySnapshots.Num() == MaxSnapshots) { TransformAndVelocitySnapshots.PopFront(); }
+	// Defer to a later frame once this frame's recording budget is spent; the snapshot then stores the time that actually
+	// elapsed, so interpolation stays correct, and components can only be deferred for so long before recording anyway.
+	// Deferred components are queued to record at the end of the frame, first from the next frame's budget, so it doesn't
+	// go to whichever tick first
+	if (NumDeferredRecordingFrames < GameMode->MaxRecordingDeferralFrames && !GameMode->HasRecordingBudget())
+	{
+		if (NumDeferredRecordingFrames++ == 0) { GameMode->DeferRecording(*this); }
+		return;
+	}
 
-	// Record the transform and velocity
-	FTransform Transform = GetOwner()->GetActorTransform();
-	FVector LinearVelocity = OwnerRootComponent ? OwnerRootComponent->GetPhysicsLinearVelocity() : FVector::Zero();
-	FVector AngularVelocityInRadians = OwnerRootComponent ? OwnerRootComponent->GetPhysicsAngularVelocityInRadians() : FVector::Zero();
-	LatestSnapshotIndex =
-		TransformAndVelocitySnapshots.Emplace(TimeSinceSnapshotsChanged, Transform, LinearVelocity, AngularVelocityInRadians);
+	RecordDueSnapshot();
+}
 
-	if (bSnapshotMovementVelocityAndMode && OwnerMovementComponent)
+void URewindComponent::RecordDeferredSnapshot()
+{
+	// The snapshot may have been recorded, or stopped being due, since it was queued; the component is queued again the
+	// next time it is deferred
+	if (NumDeferredRecordingFrames == 0) { return; }
+	if (IsTimeBeingManipulated() || bIsPooled || PhysicsBodyBuffer || TimeSinceSnapshotsChanged < GetSnapshotDueSeconds())
 	{
-		// If the buffer is full, drop the oldest snapshot
-		if (MovementVelocityAndModeSnapshots.Num() == MaxSnapshots) { MovementVelocityAndModeSnapshots.PopFront(); }
+		NumDeferredRecordingFrames = 0;
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::RecordDeferredSnapshot);
+
+	RecordDueSnapshot();
+}
+
+float URewindComponent::GetSnapshotDueSeconds() const
+{
+	// The first snapshot waits for this component's phase so components spawned together don't all record on the same frames
+	if (TransformAndVelocitySnapshots.Num() == 0) { return RecordingPhaseSeconds; }
+	return SnapshotIntervalSeconds - SnapshotLatenessSeconds;
+}
+
+void URewindComponent::RecordDueSnapshot()
+{
+	// Carry lateness into the next deadline to hold the component's phase, but never enough to record on back to back frames
+	const bool bIsFirstSnapshot = TransformAndVelocitySnapshots.Num() == 0;
+	const float DueSeconds = GetSnapshotDueSeconds();
+	SnapshotLatenessSeconds =
+		bIsFirstSnapshot ? 0.0f : FMath::Clamp(TimeSinceSnapshotsChanged - DueSeconds, 0.0f, SnapshotIntervalSeconds * 0.5f);
+	WriteSnapshot();
+}
 
-		// Record the movement velocity and movement mode
-		FVector MovementVelocity = OwnerMovementComponent->Velocity;
-		TEnumAsByte<EMovementMode> MovementMode = OwnerMovementComponent->MovementMode;
-		int32 LatestMovementSnapshotIndex =
-			MovementVelocityAndModeSnapshots.Emplace(TimeSinceSnapshotsChanged, MovementVelocity, MovementMode);
-		check(LatestSnapshotIndex == LatestMovementSnapshotIndex);
+void URewindComponent::RecordSnapshotNow()
+{
+	if (IsTimeBeingManipulated() || bIsPooled) { return; }
+
+	// Samples from the physics thread can't be taken on demand, so take whatever has arrived since the last drain
+	if (PhysicsBodyBuffer)
+	{
+		RecordPhysicsSamples();
+		return;
 	}
 
+	// A snapshot taken on the frame of the last one would have no time to interpolate over
+	if (TransformAndVelocitySnapshots.Num() == 0 || TimeSinceSnapshotsChanged <= 0.0f) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::RecordSnapshotNow);
+
+	// The next snapshot is due a full interval from this one
+	SnapshotLatenessSeconds = 0.0f;
+	WriteSnapshot();
+}
+
+void URewindComponent::WriteSnapshot()
+{
+	const double RecordingStartSeconds = FPlatformTime::Seconds();
+
+	// If the buffer is full, drop the oldest snapshot; after streaming in spilled history it may be over capacity
+	while (TransformAndVelocitySnapshots.Num() >= MaxSnapshots) { DropOldestSnapshot(); }
+
+	UpdateRecordingSpace();
+	if (ActiveChannels != RecordedChannels) { DetectVaryingChannels(); }
+
+	// Record the transform and velocity, along with movement velocity and mode if they are being snapshotted
+	FRewindChannelContext Context = MakeChannelContext();
+	Context.TimeSinceLastSnapshot = TimeSinceSnapshotsChanged;
+	LatestSnapshotIndex = ChannelOps.Record(*this, Context);
+	ChannelOps.RecordAligned(*this);
+
+	if (OwnerMovementComponent) { RecordMovementMode(); }
+
+	NumDeferredRecordingFrames = 0;
 	TimeSinceSnapshotsChanged = 0.0f;
+
+	GameMode->ChargeRecordingTime(FPlatformTime::Seconds() - RecordingStartSeconds);
 }
 
-void URewindComponent::EraseFutureSnapshots()
+void URewindComponent::UpdateRecordingSpace()
+{
+	// Whether a parent is rewindable is found by searching its owner's components, so it's only checked when the owner is
+	// attached to something else; a parent that was destroyed needs checking again too
+	const USceneComponent* Root = GetOwner()->GetRootComponent();
+	const USceneComponent* Parent = bRecordRelativeToAttachParent && Root ? Root->GetAttachParent() : nullptr;
+	const FName SocketName = Parent ? Root->GetAttachSocketName() : NAME_None;
+	const bool bParentDestroyed = !Parent && bRecordingRelativeToAttachParent;
+	if (Parent == LastAttachParent.Get() && SocketName == LastAttachSocketName && !bParentDestroyed) { return; }
+
+	LastAttachParent = Parent;
+	LastAttachSocketName = SocketName;
+	const bool bWasRelative = bRecordingRelativeToAttachParent;
+	bRecordingRelativeToAttachParent = FRewindAttachmentTimeline::IsRewindableParent(Parent);
+	if (!bWasRelative && !bRecordingRelativeToAttachParent) { return; }
+
+	// Parts of the transform that aren't stored stand for constant values in the space snapshots are recorded in, so the
+	// new space needs its own; substituting the old ones would place those parts in the wrong space
+	ReferenceTransform = bRecordingRelativeToAttachParent ? Root->GetRelativeTransform() : GetOwner()->GetActorTransform();
+}
+
+void URewindComponent::DetectVaryingChannels()
+{
+	// Channels never stop being stored once they vary, since snapshots recorded afterwards depend on them
+	ERewindSnapshotChannels Channels = static_cast<ERewindSnapshotChannels>(ActiveChannels);
+	const FTransform Transform = IsRecordingRelativeToAttachParent() ? GetOwner()->GetRootComponent()->GetRelativeTransform()
+																	 : GetOwner()->GetActorTransform();
+	if (!Transform.GetTranslation().Equals(ReferenceTransform.GetTranslation())) { Channels |= ERewindSnapshotChannels::Location; }
+	if (!Transform.GetRotation().Equals(ReferenceTransform.GetRotation())) { Channels |= ERewindSnapshotChannels::Rotation; }
+	if (!Transform.GetScale3D().Equals(ReferenceTransform.GetScale3D())) { Channels |= ERewindSnapshotChannels::Scale; }
+	if (OwnerRootComponent && OwnerRootComponent->IsSimulatingPhysics()) { Channels |= ERewindSnapshotChannels::Velocity; }
+	ActiveChannels = static_cast<int32>(Channels) & RecordedChannels;
+}
+
+void URewindComponent::RecordPhysicsSamples()
+{
+	// Samples are recorded through the channels like any snapshot, so varying channel masks apply to them and the optional
+	// timelines, which read the game thread's state, record a frame for each
+	UpdateRecordingSpace();
+	FRewindPhysicsSample Sample;
+	while (PhysicsBodyBuffer->Samples.Dequeue(Sample))
+	{
+		while (TransformAndVelocitySnapshots.Num() >= MaxSnapshots) { DropOldestSnapshot(); }
+
+		// Samples are step aligned, so their spacing comes from simulation time; the first sample after playback is
+		// measured from when recording resumed
+		const float TimeSinceLastSnapshot =
+			LatestPhysicsSampleTime >= 0.0 ? static_cast<float>(Sample.Time - LatestPhysicsSampleTime) : TimeSinceSnapshotsChanged;
+		LatestPhysicsSampleTime = Sample.Time;
+
+		if (ActiveChannels != RecordedChannels) { DetectVaryingChannels(); }
+		FRewindChannelContext Context = MakeChannelContext();
+		Context.TimeSinceLastSnapshot = TimeSinceLastSnapshot;
+		Context.PhysicsSample = &Sample;
+		LatestSnapshotIndex = ChannelOps.Record(*this, Context);
+		ChannelOps.RecordAligned(*this);
+		TimeSinceSnapshotsChanged = 0.0f;
+	}
+}
+
+void URewindComponent::RegisterPhysicsBody()
+{
+	if (!OwnerRootComponent || !OwnerRootComponent->IsSimulatingPhysics()) { return; }
+
+	TSharedPtr<FRewindPhysicsRecorder> PhysicsRecorder = GameMode->GetOrCreatePhysicsRecorder();
+	if (!PhysicsRecorder) { return; }
+
+	PhysicsBodyBuffer = PhysicsRecorder->RegisterBody(OwnerRootComponent->BodyInstance, SnapshotIntervalSeconds);
+	LatestPhysicsSampleTime = -1.0;
+}
+
+void URewindComponent::UnregisterPhysicsBody()
+{
+	if (!PhysicsBodyBuffer) { return; }
+
+	if (TSharedPtr<FRewindPhysicsRecorder> PhysicsRecorder = GameMode->GetOrCreatePhysicsRecorder())
+	{
+		PhysicsRecorder->UnregisterBody(PhysicsBodyBuffer);
+	}
+	PhysicsBodyBuffer.Reset();
+}
+
+void URewindComponent::DropOldestSnapshot()
+{
+	// Spilling captures whole pages, so aged pages go to disk without being decompressed here
+	if (FlightRecorder.IsEnabled())
+	{
+		const bool bHasMovementSnapshots = MovementVelocityAndModeSnapshots.Num() > 0;
+		FlightRecorder.Spill(TransformAndVelocitySnapshots, bHasMovementSnapshots ? &MovementVelocityAndModeSnapshots : nullptr);
+	}
+
+	ChannelOps.PopFrontAligned(*this, TransformAndVelocitySnapshots.Num());
+	ChannelOps.PopFront(*this);
+}
+
+void URewindComponent::StreamInColdSnapshots()
 {
-	// Pop snapshots until the latest snapshot is the last one in the buffer
-	while (LatestSnapshotIndex < TransformAndVelocitySnapshots.Num() - 1)
+	if (!FlightRecorder.HasColdHistory()) { return; }
+
+	// Start reading the next block well before the playhead reaches the oldest resident snapshot
+	if (LatestSnapshotIndex < FlightRecorder.GetBlockSize()) { FlightRecorder.Prefetch(); }
+
+	TRewindTimeline<FMovementVelocityAndModeSnapshot>* MovementSnapshots =
+		MovementVelocityAndModeSnapshots.Num() > 0 ? &MovementVelocityAndModeSnapshots : nullptr;
+	const bool bAttachmentsCoverSnapshots = AttachmentTimeline.Num() == TransformAndVelocitySnapshots.Num();
+	int32 NumRestored = FlightRecorder.RestoreReady(TransformAndVelocitySnapshots, MovementSnapshots);
+	if (NumRestored == 0) { return; }
+	LatestSnapshotIndex += NumRestored;
+	if (MovementModeSnapshotIndex != INDEX_NONE) { MovementModeSnapshotIndex += NumRestored; }
+
+	// Attachment frames of the restored snapshots come back from cold history, unless frames are missing between them and
+	// the resident ones, in which case the restored snapshots' space is unknown and they are never applied
+	if (AttachmentTimeline.IsInitialized())
+	{
+		if (bAttachmentsCoverSnapshots) { AttachmentTimeline.RestoreColdHistory(NumRestored); }
+		else { AttachmentTimeline.DiscardColdHistory(); }
+	}
+
+	// Keep memory bounded during deep rewinds by dropping the newest snapshots beyond the playhead; this limits how far
+	// a subsequent fast forward can go, but those snapshots would be erased as soon as the rewind completes anyway
+	const int32 MaxResidentSnapshots = static_cast<int32>(MaxSnapshots) + FlightRecorder.GetBlockSize();
+	FlightRecorder.EndCapture();
+	int32 NumDropped = 0;
+	while (TransformAndVelocitySnapshots.Num() > MaxResidentSnapshots && LatestSnapshotIndex < TransformAndVelocitySnapshots.Num() - 2)
 	{
 		TransformAndVelocitySnapshots.Pop();
+		if (MovementSnapshots) { MovementSnapshots->Pop(); }
+		++NumDropped;
 	}
+	if (NumDropped > 0) { ChannelOps.TruncateAligned(*this, NumDropped); }
+}
 
-	if (bSnapshotMovementVelocityAndMode)
+void URewindComponent::EraseFutureSnapshots()
+{
+	const int32 NumSnapshotsToKeep = LatestSnapshotIndex + 1;
+	if (NumSnapshotsToKeep >= TransformAndVelocitySnapshots.Num()) { return; }
+
+	// Keep the rewound-over future as a branch; it shares pages with the timeline, so nothing is copied
+	if (GameMode->bKeepAbandonedFuture) { AbandonedFuture = CaptureBranch(TransformAndVelocitySnapshots.Num()); }
+
+	ChannelOps.TruncateAligned(*this, TransformAndVelocitySnapshots.Num() - NumSnapshotsToKeep);
+
+	// Drop whole pages rather than popping snapshots one at a time; the flight recorder stops spilling from the oldest page
+	// first, as it may hold some of the erased snapshots
+	FlightRecorder.EndCapture();
+	ChannelOps.Truncate(*this, NumSnapshotsToKeep);
+}
+
+FRewindComponentBranch URewindComponent::CaptureBranch(int32 NumSnapshots)
+{
+	FRewindComponentBranch Branch;
+	Branch.TransformAndVelocitySnapshots = TransformAndVelocitySnapshots.Branch(NumSnapshots);
+	if (MovementVelocityAndModeSnapshots.Num() > 0)
+	{
+		Branch.MovementVelocityAndModeSnapshots = MovementVelocityAndModeSnapshots.Branch(NumSnapshots);
+	}
+	if (AttachmentTimeline.Num() > 0)
+	{
+		const int32 NumSnapshotsAfterBranch = TransformAndVelocitySnapshots.Num() - NumSnapshots;
+		Branch.Attachments = AttachmentTimeline.Branch(AttachmentTimeline.Num() - NumSnapshotsAfterBranch);
+	}
+	if (OwnerMovementComponent && NumSnapshots > 0)
 	{
-		// Pop snapshots until the latest snapshot is the last one in the buffer
-		while (LatestSnapshotIndex < MovementVelocityAndModeSnapshots.Num() - 1)
+		const double NewestTime = GetSnapshotEventTime(NumSnapshots - 1);
+		const double ModeTime = MovementModeSnapshotIndex != INDEX_NONE ? MovementModeSnapshotTime : NewestSnapshotEventTime;
+		Branch.MovementMode = MovementMode;
+		Branch.CustomMovementMode = CustomMovementMode;
+		StepMovementMode(ModeTime, NewestTime, Branch.MovementMode, Branch.CustomMovementMode);
+		ForEachMovementModeChange(
+			GetSnapshotEventTime(0),
+			NewestTime,
+			false,
+			[&Branch, NewestTime](const FRewindMovementModeChange& Change, double Time)
+			{ Branch.MovementModeChanges.Emplace(Time - NewestTime, Change); });
+	}
+	return Branch;
+}
+
+bool URewindComponent::RestoreBranch(const FRewindComponentBranch& Branch)
+{
+	// Branches replace the present, so they can only be restored while time is flowing normally
+	if (!Branch.IsValid() || IsTimeBeingManipulated()) { return false; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::RestoreBranch);
+
+	TransformAndVelocitySnapshots.Restore(Branch.TransformAndVelocitySnapshots);
+	if (Branch.MovementVelocityAndModeSnapshots.IsValid())
+	{
+		MovementVelocityAndModeSnapshots.Restore(Branch.MovementVelocityAndModeSnapshots);
+	}
+	else { MovementVelocityAndModeSnapshots.Empty(); }
+
+	// Spilled history belongs to the timeline that was just replaced; poses, bodies, instances, pieces and properties
+	// aren't part of branches, so they start over too, while attachments come with the branch so its snapshots are
+	// applied in the space they were recorded in
+	FlightRecorder.DiscardColdHistory();
+	if (PoseTimeline.Num() > 0 || BodyTimeline.Num() > 0 || InstanceTimeline.Num() > 0 || FractureTimeline.Num() > 0
+		|| PropertyTimeline.Num() > 0)
+	{
+		UE_LOG(
+			LogRewind,
+			Log,
+			TEXT("Restoring a branch of %s discards its pose, body, instance, fracture and property history, which branches don't hold"),
+			*GetNameSafe(GetOwner()));
+	}
+	ChannelOps.EmptyAligned(*this);
+	if (AttachmentTimeline.IsInitialized()) { AttachmentTimeline.Restore(Branch.Attachments); }
+
+	// The branch's present becomes the event track's, and its mode changes replace this component's events on the track,
+	// which belong to the replaced timeline
+	LatestSnapshotIndex = TransformAndVelocitySnapshots.Num() - 1;
+	NewestSnapshotEventTime = GameMode->GetEventTrack().GetPresentTime();
+	RestoredMovementModeTime = NewestSnapshotEventTime;
+	RestoredMovementModeChanges.Reset(Branch.MovementModeChanges.Num());
+	for (const TPair<double, FRewindMovementModeChange>& Change : Branch.MovementModeChanges)
+	{
+		RestoredMovementModeChanges.Emplace(RestoredMovementModeTime + Change.Key, Change.Value);
+	}
+	if (OwnerMovementComponent && Branch.MovementVelocityAndModeSnapshots.IsValid())
+	{
+		MovementMode = Branch.MovementMode;
+		CustomMovementMode = Branch.CustomMovementMode;
+	}
+
+	// Snap to the branch's present, applying its movement mode, and resume recording from it
+	TimeSinceSnapshotsChanged = 0.0f;
+	if (LatestSnapshotIndex >= 0)
+	{
+		ApplySnapshots(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f, ERewindApplyMode::Resume);
+	}
+	UpdateRecordingSpace();
+
+	return true;
+}
+
+void URewindComponent::RestoreUnloadedBranch(const FRewindComponentBranch& Branch, double SecondsSinceUnload)
+{
+	if (!RestoreBranch(Branch)) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::RestoreUnloadedBranch);
+
+	if (SecondsSinceUnload > 0.0)
+	{
+		// Hold the state the owner was unloaded in across the time it was away, keeping the timeline in step with the world;
+		// the branch's present, and so its mode changes, were that long ago
+		NewestSnapshotEventTime -= SecondsSinceUnload;
+		RestoredMovementModeTime -= SecondsSinceUnload;
+		for (TPair<double, FRewindMovementModeChange>& Change : RestoredMovementModeChanges) { Change.Key -= SecondsSinceUnload; }
+		while (TransformAndVelocitySnapshots.Num() >= MaxSnapshots) { DropOldestSnapshot(); }
+		FRewindChannelContext Context = MakeChannelContext();
+		Context.TimeSinceLastSnapshot = SecondsSinceUnload;
+		LatestSnapshotIndex = ChannelOps.Record(*this, Context);
+		ChannelOps.RecordAligned(*this);
+		if (OwnerMovementComponent) { RecordMovementMode(); }
+	}
+	else if (SecondsSinceUnload < 0.0 && LatestSnapshotIndex > 0)
+	{
+		// Streamed back in by rewinding to before the unload; seek back to the snapshot at the playhead
+		double SecondsToSeek = -SecondsSinceUnload;
+		while (LatestSnapshotIndex > 0 && SecondsToSeek > 0.0)
 		{
-			MovementVelocityAndModeSnapshots.Pop();
+			SecondsToSeek -= TransformAndVelocitySnapshots[LatestSnapshotIndex].TimeSinceLastSnapshot;
+			--LatestSnapshotIndex;
 		}
+		ApplySnapshots(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f, ERewindApplyMode::Resume);
+
+		// If time has resumed since the rewind, the future past the playhead has been overwritten
+		if (!GameMode->IsGlobalRewinding() && !GameMode->IsGlobalFastForwarding() && !GameMode->IsGlobalTimeScrubbing())
+		{
+			EraseFutureSnapshots();
+		}
+	}
+
+	if (bIsRewindingEnabled) { SetIsRewindingEnabled(true); }
+}
+
+bool URewindComponent::SwitchToAbandonedFuture()
+{
+	if (!AbandonedFuture.IsValid() || IsTimeBeingManipulated()) { return false; }
+
+	// The current timeline becomes the abandoned future, so switching again returns to it
+	FRewindComponentBranch Future = MoveTemp(AbandonedFuture);
+	AbandonedFuture = CaptureBranch();
+	return RestoreBranch(Future);
+}
+
+void URewindComponent::EnterPool()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::EnterPool);
+
+	// Stopping time manipulation first restores simulation, which is then switched off along with everything else
+	SetIsRewindingEnabled(false);
+	bIsPooled = true;
+	NumDeferredRecordingFrames = 0;
+	SetComponentTickEnabled(false);
+	PausePhysics();
+	if (OwnerMovementComponent) { OwnerMovementComponent->SetComponentTickEnabled(false); }
+
+	AActor* Owner = GetOwner();
+	Owner->SetActorHiddenInGame(true);
+	Owner->SetActorEnableCollision(false);
+	Owner->SetActorTickEnabled(false);
+}
+
+void URewindComponent::LeavePool(const FRewindComponentBranch& Branch, bool bAtStart)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::LeavePool);
+
+	check(bIsPooled);
+	bIsPooled = false;
+
+	AActor* Owner = GetOwner();
+	Owner->SetActorHiddenInGame(false);
+	Owner->SetActorEnableCollision(true);
+	Owner->SetActorTickEnabled(true);
+	if (OwnerMovementComponent) { OwnerMovementComponent->SetComponentTickEnabled(true); }
+	SetComponentTickEnabled(true);
+
+	// Restoring snaps to the end of the timeline, which is where actors resurrected by rewinding past their destruction
+	// belong; actors brought back by fast forwarding past their spawn start from the beginning instead
+	RestoreBranch(Branch);
+	if (bAtStart && TransformAndVelocitySnapshots.Num() > 0)
+	{
+		LatestSnapshotIndex = 0;
+		ApplySnapshots(0, 0, 0.0f, ERewindApplyMode::Resume);
 	}
+
+	// Physics stays paused from entering the pool, and resumes when the time manipulation the owner joins ends
+	SetIsRewindingEnabled(true);
+	if (!IsTimeBeingManipulated()) { UnpausePhysics(); }
+}
+
+bool URewindComponent::ConsumePlaybackDeltaTime(float& DeltaTime)
+{
+	PendingPlaybackDeltaTime += DeltaTime;
+	if (++PlaybackFramesSinceUpdate < PlaybackFrameInterval) { return false; }
+
+	DeltaTime = PendingPlaybackDeltaTime;
+	PendingPlaybackDeltaTime = 0.0f;
+	PlaybackFramesSinceUpdate = 0;
+	return true;
 }
 
 void URewindComponent::PlaySnapshots(float DeltaTime, bool bRewinding)
@@ -304,6 +909,9 @@ void URewindComponent::PlaySnapshots(float DeltaTime, bool bRewinding)
 
 	UnpauseAnimation();
 
+	// Bring spilled history back in ahead of the playhead
+	if (bRewinding) { StreamInColdSnapshots(); }
+
 	if (HandleInsufficientSnapshots()) { return; }
 
 	// Apply time dilation to delta time
@@ -325,15 +933,18 @@ void URewindComponent::PlaySnapshots(float DeltaTime, bool bRewinding)
 		// If we don't have any snapshots in the future, we can't interpolate, so just snap to the latest snapshot
 		if (LatestSnapshotIndex == TransformAndVelocitySnapshots.Num() - 1)
 		{
-			ApplySnapshot(TransformAndVelocitySnapshots[LatestSnapshotIndex], false /*bApplyPhysics*/);
-			if (bSnapshotMovementVelocityAndMode)
-			{
-				ApplySnapshot(MovementVelocityAndModeSnapshots[LatestSnapshotIndex], true /*bApplyTimeDilationToVelocity*/);
-			}
+			ApplySnapshots(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f, ERewindApplyMode::Playback);
+			ApplyChannels(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f);
 			return;
 		}
 
-		bReachedEndOfTrack = LatestSnapshotIndex == 0;
+		// Not the end of the track if there is still spilled history to stream in; hold at the oldest resident snapshot
+		// until it arrives, so playback carries on from there rather than jumping by the time spent waiting
+		bReachedEndOfTrack = LatestSnapshotIndex == 0 && !FlightRecorder.HasColdHistory();
+		if (LatestSnapshotIndex == 0 && !bReachedEndOfTrack)
+		{
+			TimeSinceSnapshotsChanged = FMath::Min(TimeSinceSnapshotsChanged, LatestSnapshotTime);
+		}
 	}
 	else
 	{
@@ -369,11 +980,8 @@ void URewindComponent::PauseTime(float DeltaTime, bool bRewinding)
 		// If we don't have any snapshots in the future, use the latest snapshot
 		if (LatestSnapshotIndex == TransformAndVelocitySnapshots.Num() - 1)
 		{
-			ApplySnapshot(TransformAndVelocitySnapshots[LatestSnapshotIndex], false /*bApplyPhysics*/);
-			if (bSnapshotMovementVelocityAndMode)
-			{
-				ApplySnapshot(MovementVelocityAndModeSnapshots[LatestSnapshotIndex], true /*bApplyTimeDilationToVelocity*/);
-			}
+			ApplySnapshots(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f, ERewindApplyMode::Playback);
+			ApplyChannels(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f);
 			PauseAnimation();
 			return;
 		}
@@ -396,6 +1004,7 @@ void URewindComponent::PauseTime(float DeltaTime, bool bRewinding)
 bool URewindComponent::TryStartTimeManipulation(bool& bStateToSet, bool bResetTimeSinceSnapshotsChanged)
 {
 	if (!bIsRewindingEnabled || bStateToSet) { return false; }
+	const bool bWasManipulatingTime = IsTimeBeingManipulated();
 
 	// Turn on requested time manipulation (i.e. bIsRewinding, bIsFastForwarding, bIsTimeScrubbing)
 	bStateToSet = true;
@@ -403,8 +1012,32 @@ bool URewindComponent::TryStartTimeManipulation(bool& bStateToSet, bool bResetTi
 	// Caller may want to maintain current interpolation (ex. during time scrubbing)
 	if (bResetTimeSinceSnapshotsChanged) { TimeSinceSnapshotsChanged = 0.0f; }
 
-	// Physics simulation disabled during rewinding
+	// Start playback on the first frame rather than waiting out the significance tier's interval
+	if (!bWasManipulatingTime)
+	{
+		PendingPlaybackDeltaTime = 0.0f;
+		PlaybackFramesSinceUpdate = PlaybackFrameInterval - 1;
+	}
+
+	// Physics simulation disabled during rewinding; a deferred snapshot is no longer recorded
 	PausePhysics();
+	NumDeferredRecordingFrames = 0;
+
+	// Recorded poses and bodies replace the anim graph and physics asset simulation until time flows normally again
+	if (!bWasManipulatingTime)
+	{
+		SuspendMovementSimulation();
+		PauseBodySimulation();
+		PauseFractureSimulation();
+		SuspendAnimGraph();
+
+		// Playback steps the movement mode from the newest snapshot, which it belongs to while time flows normally
+		if (OwnerMovementComponent && LatestSnapshotIndex >= 0)
+		{
+			MovementModeSnapshotIndex = TransformAndVelocitySnapshots.Num() - 1;
+			MovementModeSnapshotTime = NewestSnapshotEventTime;
+		}
+	}
 
 	// Check whether animations were paused when we started this time manipulation operation
 	bAnimationsPausedAtStartOfTimeManipulation = bPausedAnimation;
@@ -429,22 +1062,42 @@ bool URewindComponent::TryStopTimeManipulation(bool& bStateToSet, bool bResetTim
 
 		// Restore animation
 		UnpauseAnimation();
+		ResumeAnimGraph();
 
 		// Snap to the last snapshot before exiting rewind
 		if (LatestSnapshotIndex >= 0)
 		{
-			ApplySnapshot(TransformAndVelocitySnapshots[LatestSnapshotIndex], true /*bApplyPhysics*/);
-			if (bSnapshotMovementVelocityAndMode)
-			{
-				ApplySnapshot(MovementVelocityAndModeSnapshots[LatestSnapshotIndex], false /*bApplyTimeDilationToVelocity*/);
+			ApplySnapshots(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f, ERewindApplyMode::Resume);
 
-				// Players will be surprised if they continue moving after time scrubbing; clear movement velocity
-				if (bResetMovementVelocity && OwnerMovementComponent) { OwnerMovementComponent->Velocity = FVector::ZeroVector; }
-			}
+			// Players will be surprised if they continue moving after time scrubbing; clear movement velocity
+			if (bResetMovementVelocity && OwnerMovementComponent) { OwnerMovementComponent->Velocity = FVector::ZeroVector; }
+			ApplyChannels(LatestSnapshotIndex, LatestSnapshotIndex, 0.0f);
 		}
 
+		// The snapshot resumed from becomes the newest once the future is erased below
+		if (MovementModeSnapshotIndex != INDEX_NONE)
+		{
+			NewestSnapshotEventTime = MovementModeSnapshotTime;
+			MovementModeSnapshotIndex = INDEX_NONE;
+
+			// Restored mode changes ahead of it go with the future, and the track's events are recorded from its playhead
+			RestoredMovementModeTime =
+				FMath::Min3(RestoredMovementModeTime, NewestSnapshotEventTime, GameMode->GetEventTrack().GetPlayheadTime());
+			const double ErasedAfterTime = RestoredMovementModeTime + RewindComponent::EventTimeTolerance;
+			RestoredMovementModeChanges.RemoveAll(
+				[ErasedAfterTime](const TPair<double, FRewindMovementModeChange>& Change) { return Change.Key > ErasedAfterTime; });
+		}
+
+		// Movement, bodies and pieces are restored after the owner snaps so they start from the restored state
+		ResumeMovementSimulation();
+		ResumeBodySimulation();
+		ResumeFractureSimulation();
+
 		// Delete any future snapshots on the timeline that should be overwritten by new snapshots
 		EraseFutureSnapshots();
+
+		// A block still being streamed in would land in front of history spilled from now on, which is newer than it
+		FlightRecorder.CancelRead();
 	}
 
 	return true;
@@ -467,8 +1120,38 @@ void URewindComponent::UnpausePhysics()
 
 	check(OwnerRootComponent);
 	bPausedPhysics = false;
+
+	// Recreating physics state replaces the body being sampled on the physics thread, along with any stale samples
+	const bool bWasRecordingOnPhysicsThread = PhysicsBodyBuffer.IsValid();
+	UnregisterPhysicsBody();
 	OwnerRootComponent->SetSimulatePhysics(true);
 	OwnerRootComponent->RecreatePhysicsState();
+	if (bWasRecordingOnPhysicsThread) { RegisterPhysicsBody(); }
+}
+
+void URewindComponent::SuspendMovementSimulation()
+{
+	if (!bKinematicMovementPlayback || !OwnerMovementComponent || !OwnerMovementComponent->IsComponentTickEnabled()) { return; }
+
+	bSuspendedMovementSimulation = true;
+	OwnerMovementComponent->SetComponentTickEnabled(false);
+}
+
+void URewindComponent::ResumeMovementSimulation()
+{
+	if (!bSuspendedMovementSimulation) { return; }
+
+	check(OwnerMovementComponent);
+	bSuspendedMovementSimulation = false;
+
+	// Forces and floor found before time was manipulated no longer apply where the owner was restored to
+	OwnerMovementComponent->ClearAccumulatedForces();
+	OwnerMovementComponent->bForceNextFloorCheck = true;
+
+	// Input given while movement was suspended accumulated without being consumed; don't apply it all at once
+	if (APawn* Pawn = OwnerMovementComponent->GetPawnOwner()) { Pawn->ConsumeMovementInputVector(); }
+	OwnerMovementComponent->UpdateComponentVelocity();
+	OwnerMovementComponent->SetComponentTickEnabled(true);
 }
 
 void URewindComponent::PauseAnimation()
@@ -489,17 +1172,193 @@ void URewindComponent::UnpauseAnimation()
 	OwnerSkeletalMesh->bPauseAnims = false;
 }
 
+void URewindComponent::SuspendAnimGraph()
+{
+	if (!OwnerSkeletalMesh || (PoseTimeline.Num() == 0 && BodyTimeline.Num() == 0)) { return; }
+
+	bSuspendedAnimGraph = true;
+	OwnerSkeletalMesh->bNoSkeletonUpdate = true;
+}
+
+void URewindComponent::ResumeAnimGraph()
+{
+	if (!bSuspendedAnimGraph) { return; }
+
+	check(OwnerSkeletalMesh);
+	bSuspendedAnimGraph = false;
+	OwnerSkeletalMesh->bNoSkeletonUpdate = false;
+}
+
+void URewindComponent::RecordPose()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::RecordPose);
+
+	// Poses of a different mesh can't be played back, so history starts over if the mesh changes
+	const TArray<FTransform>& BoneSpaceTransforms = OwnerSkeletalMesh->GetBoneSpaceTransforms();
+	if (BoneSpaceTransforms.Num() != PoseTimeline.GetNumBones())
+	{
+		PoseTimeline.Initialize(BoneSpaceTransforms.Num(), PoseRotationToleranceDegrees, PoseTranslationTolerance, MaxPoseKeyGap);
+	}
+	PoseTimeline.Add(BoneSpaceTransforms);
+}
+
+void URewindComponent::RecordBodies()
+{
+	// Recreated physics state can bring a different set of bodies, which recorded frames can't be applied to
+	if (!BodyTimeline.IsCompatible(*OwnerSkeletalMesh)) { BodyTimeline.Initialize(*OwnerSkeletalMesh, MaxSnapshots); }
+	if (BodyTimeline.GetNumBodies() > 0) { BodyTimeline.Record(*OwnerSkeletalMesh); }
+}
+
+void URewindComponent::PauseBodySimulation()
+{
+	if (!OwnerSkeletalMesh || BodyTimeline.Num() == 0) { return; }
+
+	bPausedBodySimulation = true;
+	bWasSimulatingBodiesWhenPaused = OwnerSkeletalMesh->IsSimulatingPhysics();
+	if (bWasSimulatingBodiesWhenPaused) { OwnerSkeletalMesh->SetSimulatePhysics(false); }
+}
+
+void URewindComponent::ResumeBodySimulation()
+{
+	if (!bPausedBodySimulation) { return; }
+
+	check(OwnerSkeletalMesh);
+	bPausedBodySimulation = false;
+
+	// Without a frame for the latest snapshot, the bodies go back to how they were paused, simulating from wherever they are
+	// or following animation
+	const int32 BodyIndex = LatestSnapshotIndex - (TransformAndVelocitySnapshots.Num() - BodyTimeline.Num());
+	if (BodyIndex < 0 || !BodyTimeline.IsCompatible(*OwnerSkeletalMesh))
+	{
+		if (bWasSimulatingBodiesWhenPaused) { OwnerSkeletalMesh->SetSimulatePhysics(true); }
+		return;
+	}
+
+	// Rewinding to before a ragdoll started leaves the bodies following animation again
+	const bool bWasSimulating = BodyTimeline.GetFrame(BodyIndex).bIsSimulating;
+	OwnerSkeletalMesh->SetSimulatePhysics(bWasSimulating);
+	if (bWasSimulating) { BodyTimeline.Apply(BodyIndex, *OwnerSkeletalMesh, bRestoreSleepState); }
+}
+
+void URewindComponent::RecordInstances()
+{
+	// Adding or removing instances reorders them, so history starts over rather than being applied to the wrong pieces
+	if (!InstanceTimeline.IsCompatible(*OwnerInstancedMesh)) { InstanceTimeline.Initialize(*OwnerInstancedMesh); }
+	if (InstanceTimeline.IsCompatible(*OwnerInstancedMesh)) { InstanceTimeline.Record(*OwnerInstancedMesh); }
+}
+
+void URewindComponent::RecordFracture()
+{
+	// Recreated physics state can swap the collection's dynamic state for one with different pieces
+	if (!FractureTimeline.IsCompatible(*OwnerGeometryCollection)) { FractureTimeline.Initialize(*OwnerGeometryCollection); }
+	if (FractureTimeline.IsCompatible(*OwnerGeometryCollection)) { FractureTimeline.Record(*OwnerGeometryCollection); }
+}
+
+void URewindComponent::PauseFractureSimulation()
+{
+	if (!OwnerGeometryCollection || FractureTimeline.Num() == 0) { return; }
+
+	// Tearing down and rebuilding the collection's physics hitches, so it's left running until playback reaches a frame
+	// where the pieces differ from the present
+	bPlayingBackFracture = true;
+}
+
+void URewindComponent::ResumeFractureSimulation()
+{
+	bPlayingBackFracture = false;
+	if (!bPausedFractureSimulation) { return; }
+
+	check(OwnerGeometryCollection);
+	bPausedFractureSimulation = false;
+
+	// The rest state holds the pieces as they were at the latest snapshot, so rebuilding physics from it reassembles every
+	// cluster in place; clusters that were already broken at that point are then broken again
+	OwnerGeometryCollection->RecreatePhysicsState();
+	FractureTimeline.ReapplyBreaks(*OwnerGeometryCollection);
+}
+
+void URewindComponent::ApplyChannels(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha)
+{
+	ApplyPose(SnapshotIndexA, SnapshotIndexB, Alpha);
+	ChannelOps.ApplyAligned(*this, TransformAndVelocitySnapshots.Num(), SnapshotIndexA, SnapshotIndexB, Alpha);
+}
+
+void URewindComponent::ApplyFracture(int32 FractureIndexA, int32 FractureIndexB, float Alpha)
+{
+	if (!bPlayingBackFracture) { return; }
+
+	// Pieces are posed through the collection's rest state during playback, which the solver would otherwise overwrite
+	if (!bPausedFractureSimulation && FractureTimeline.HasChangesAfter(FMath::Min(FractureIndexA, FractureIndexB)))
+	{
+		bPausedFractureSimulation = true;
+		OwnerGeometryCollection->DestroyPhysicsState();
+	}
+	if (bPausedFractureSimulation) { FractureTimeline.Apply(FractureIndexA, FractureIndexB, Alpha, *OwnerGeometryCollection); }
+}
+
+void URewindComponent::ApplyPose(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha)
+{
+	if (!bSuspendedAnimGraph) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::ApplyPose);
+
+	const USkinnedAsset* SkinnedAsset = OwnerSkeletalMesh->GetSkinnedAsset();
+	TArray<FTransform>& ComponentSpaceTransforms = OwnerSkeletalMesh->GetEditableComponentSpaceTransforms();
+	if (!SkinnedAsset) { return; }
+
+	// Snapshots streamed back in by the flight recorder predate the oldest pose and body frame, which are held for them
+	const int32 NumSnapshots = TransformAndVelocitySnapshots.Num();
+	if (PoseTimeline.Num() > 0 && PoseTimeline.GetNumBones() == ComponentSpaceTransforms.Num())
+	{
+		const int32 PoseIndexA = RewindComponent::FAlignedChannel::AlignIndex(SnapshotIndexA, NumSnapshots, PoseTimeline.Num());
+		const int32 PoseIndexB = RewindComponent::FAlignedChannel::AlignIndex(SnapshotIndexB, NumSnapshots, PoseTimeline.Num());
+		PoseTimeline.Sample(PoseIndexA, PoseIndexB, Alpha, PlaybackBoneSpaceTransforms);
+	}
+	else { PlaybackBoneSpaceTransforms = OwnerSkeletalMesh->GetBoneSpaceTransforms(); }
+	if (PlaybackBoneSpaceTransforms.Num() != ComponentSpaceTransforms.Num()) { return; }
+
+	// Bones driven by simulated bodies take the bodies' transforms, like physics blending would if it were simulating
+	bool bApplyBodies = false;
+	if (BodyTimeline.Num() > 0 && BodyTimeline.GetBoneBodyIndices().Num() == ComponentSpaceTransforms.Num())
+	{
+		const int32 BodyIndexA = RewindComponent::FAlignedChannel::AlignIndex(SnapshotIndexA, NumSnapshots, BodyTimeline.Num());
+		const int32 BodyIndexB = RewindComponent::FAlignedChannel::AlignIndex(SnapshotIndexB, NumSnapshots, BodyTimeline.Num());
+		bApplyBodies = BodyTimeline.GetFrame(Alpha < 0.5f ? BodyIndexA : BodyIndexB).bIsSimulating;
+		if (bApplyBodies) { BodyTimeline.SampleTransforms(BodyIndexA, BodyIndexB, Alpha, PlaybackBodyTransforms); }
+	}
+
+	// Bones are ordered parents first, so component space can be built in a single pass
+	const FReferenceSkeleton& RefSkeleton = SkinnedAsset->GetRefSkeleton();
+	const FTransform& ComponentToWorld = OwnerSkeletalMesh->GetComponentTransform();
+	for (int32 BoneIndex = 0; BoneIndex < ComponentSpaceTransforms.Num(); ++BoneIndex)
+	{
+		const int32 BodyIndex = bApplyBodies ? BodyTimeline.GetBoneBodyIndices()[BoneIndex] : INDEX_NONE;
+		if (BodyIndex != INDEX_NONE)
+		{
+			ComponentSpaceTransforms[BoneIndex] = PlaybackBodyTransforms[BodyIndex].GetRelativeTransform(ComponentToWorld);
+			ComponentSpaceTransforms[BoneIndex].SetScale3D(PlaybackBoneSpaceTransforms[BoneIndex].GetScale3D());
+			continue;
+		}
+
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		ComponentSpaceTransforms[BoneIndex] = ParentIndex == INDEX_NONE
+			? PlaybackBoneSpaceTransforms[BoneIndex]
+			: PlaybackBoneSpaceTransforms[BoneIndex] * ComponentSpaceTransforms[ParentIndex];
+	}
+	OwnerSkeletalMesh->ApplyEditedComponentSpaceTransforms();
+}
+
 bool URewindComponent::HandleInsufficientSnapshots()
 {
 	// Nothing to do if no snapshots are available
-	check(!bSnapshotMovementVelocityAndMode || TransformAndVelocitySnapshots.Num() == MovementVelocityAndModeSnapshots.Num());
+	check(!OwnerMovementComponent || TransformAndVelocitySnapshots.Num() == MovementVelocityAndModeSnapshots.Num());
 	if (LatestSnapshotIndex < 0 || TransformAndVelocitySnapshots.Num() == 0) { return true; }
 
 	// If only one snapshot is available, snap to it
 	if (TransformAndVelocitySnapshots.Num() == 1)
 	{
-		ApplySnapshot(TransformAndVelocitySnapshots[0], false /*bApplyPhysics*/);
-		if (bSnapshotMovementVelocityAndMode) { ApplySnapshot(MovementVelocityAndModeSnapshots[0], true /*bApplyTimeDilationToVelocity*/); }
+		ApplySnapshots(0, 0, 0.0f, ERewindApplyMode::Playback);
+		ApplyChannels(0, 0, 0.0f);
 		return true;
 	}
 
@@ -516,74 +1375,177 @@ void URewindComponent::InterpolateAndApplySnapshots(bool bRewinding)
 	check(bRewinding && LatestSnapshotIndex < TransformAndVelocitySnapshots.Num() - 1 || !bRewinding && LatestSnapshotIndex > 0);
 	int PreviousIndex = bRewinding ? LatestSnapshotIndex + 1 : LatestSnapshotIndex - 1;
 
-	// Blend and apply transform and velocity snapshots (scoped to avoid variable shadowing)
+	// Blend and apply every channel's snapshots
+	const float Alpha = TimeSinceSnapshotsChanged / TransformAndVelocitySnapshots[LatestSnapshotIndex].TimeSinceLastSnapshot;
+	ApplySnapshots(PreviousIndex, LatestSnapshotIndex, Alpha, ERewindApplyMode::Playback);
+	ApplyChannels(PreviousIndex, LatestSnapshotIndex, FMath::Clamp(Alpha, 0.0f, 1.0f));
+}
+
+FRewindChannelContext URewindComponent::MakeChannelContext() const
+{
+	FRewindChannelContext Context;
+	Context.Owner = GetOwner();
+	Context.RootComponent = OwnerRootComponent;
+	Context.MovementComponent = OwnerMovementComponent;
+	Context.RewindSpeed = GameMode->GetGlobalRewindSpeed();
+	Context.MovementMode = MovementMode;
+	Context.CustomMovementMode = CustomMovementMode;
+	Context.bRestoreSleepState = bRestoreSleepState;
+	Context.RestoreSleepSpeedThreshold = RestoreSleepSpeedThreshold;
+	Context.bRelativeToAttachParent = IsRecordingRelativeToAttachParent();
+	Context.Channels = static_cast<ERewindSnapshotChannels>(ActiveChannels);
+	Context.ReferenceTransform = ReferenceTransform;
+	return Context;
+}
+
+void URewindComponent::RecordMovementMode()
+{
+	NewestSnapshotEventTime = GameMode->GetEventTrack().GetPresentTime();
+
+	const EMovementMode NewMode = OwnerMovementComponent->MovementMode;
+	const uint8 NewCustomMode = OwnerMovementComponent->CustomMovementMode;
+	if (NewMode == MovementMode && NewCustomMode == CustomMovementMode) { return; }
+
+	FRewindMovementModeChange Change;
+	Change.PreviousMode = MovementMode;
+	Change.PreviousCustomMode = CustomMovementMode;
+	Change.Mode = NewMode;
+	Change.CustomMode = NewCustomMode;
+	GameMode->GetEventTrack().Record(MovementModeEventType, this, Change);
+
+	MovementMode = NewMode;
+	CustomMovementMode = NewCustomMode;
+}
+
+void URewindComponent::UpdatePlaybackMovementMode(int32 SnapshotIndex)
+{
+	if (SnapshotIndex == MovementModeSnapshotIndex) { return; }
+
+	// Walk to the snapshot's time from the snapshot the mode belongs to, which is usually an adjacent one
+	const double SnapshotTime = GetSnapshotEventTime(SnapshotIndex);
+	StepMovementMode(MovementModeSnapshotTime, SnapshotTime, MovementMode, CustomMovementMode);
+	MovementModeSnapshotIndex = SnapshotIndex;
+	MovementModeSnapshotTime = SnapshotTime;
+}
+
+double URewindComponent::GetSnapshotEventTime(int32 SnapshotIndex) const
+{
+	const bool bIsPlayingBack = MovementModeSnapshotIndex != INDEX_NONE;
+	const int32 StartIndex = bIsPlayingBack ? MovementModeSnapshotIndex : TransformAndVelocitySnapshots.Num() - 1;
+	double SnapshotTime = bIsPlayingBack ? MovementModeSnapshotTime : NewestSnapshotEventTime;
+	for (int32 Index = StartIndex; Index > SnapshotIndex; --Index)
 	{
-		const FTransformAndVelocitySnapshot& PreviousSnapshot = TransformAndVelocitySnapshots[PreviousIndex];
-		const FTransformAndVelocitySnapshot& NextSnapshot = TransformAndVelocitySnapshots[LatestSnapshotIndex];
-		ApplySnapshot(
-			BlendSnapshots(PreviousSnapshot, NextSnapshot, TimeSinceSnapshotsChanged / NextSnapshot.TimeSinceLastSnapshot),
-			false /*bApplyPhysics*/);
+		SnapshotTime -= TransformAndVelocitySnapshots[Index].TimeSinceLastSnapshot;
 	}
-
-	// Blend and apply movement velocity and mode snapshots
-	if (bSnapshotMovementVelocityAndMode)
+	for (int32 Index = StartIndex + 1; Index <= SnapshotIndex; ++Index)
 	{
-		const FMovementVelocityAndModeSnapshot& PreviousSnapshot = MovementVelocityAndModeSnapshots[PreviousIndex];
-		const FMovementVelocityAndModeSnapshot& NextSnapshot = MovementVelocityAndModeSnapshots[LatestSnapshotIndex];
-		ApplySnapshot(
-			BlendSnapshots(PreviousSnapshot, NextSnapshot, TimeSinceSnapshotsChanged / NextSnapshot.TimeSinceLastSnapshot),
-			true /*bApplyTimeDilationToVelocity*/);
+		SnapshotTime += TransformAndVelocitySnapshots[Index].TimeSinceLastSnapshot;
 	}
+	return SnapshotTime;
 }
 
-FTransformAndVelocitySnapshot URewindComponent::BlendSnapshots(
-	const FTransformAndVelocitySnapshot& A,
-	const FTransformAndVelocitySnapshot& B,
-	float Alpha)
+void URewindComponent::StepMovementMode(double FromTime, double ToTime, TEnumAsByte<EMovementMode>& InOutMode, uint8& InOutCustomMode) const
 {
-	Alpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
-	FTransformAndVelocitySnapshot BlendedSnapshot;
-	BlendedSnapshot.Transform.Blend(A.Transform, B.Transform, Alpha);
-	BlendedSnapshot.LinearVelocity = FMath::Lerp(A.LinearVelocity, B.LinearVelocity, Alpha);
-	BlendedSnapshot.AngularVelocityInRadians = FMath::Lerp(A.AngularVelocityInRadians, B.AngularVelocityInRadians, Alpha);
-	return BlendedSnapshot;
+	const bool bReverse = ToTime < FromTime;
+	ForEachMovementModeChange(
+		FMath::Min(FromTime, ToTime),
+		FMath::Max(FromTime, ToTime),
+		bReverse,
+		[&InOutMode, &InOutCustomMode, bReverse](const FRewindMovementModeChange& Change, double)
+		{
+			InOutMode = static_cast<EMovementMode>(bReverse ? Change.PreviousMode : Change.Mode);
+			InOutCustomMode = bReverse ? Change.PreviousCustomMode : Change.CustomMode;
+		});
 }
 
-FMovementVelocityAndModeSnapshot URewindComponent::BlendSnapshots(
-	const FMovementVelocityAndModeSnapshot& A,
-	const FMovementVelocityAndModeSnapshot& B,
-	float Alpha)
+void URewindComponent::GetSnapshotMovementModes(TArray<TEnumAsByte<EMovementMode>>& OutModes) const
 {
-	Alpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
-	FMovementVelocityAndModeSnapshot BlendedSnapshot;
-	BlendedSnapshot.MovementVelocity = FMath::Lerp(A.MovementVelocity, B.MovementVelocity, Alpha);
-	BlendedSnapshot.MovementMode = Alpha < 0.5f ? A.MovementMode : B.MovementMode;
-	return BlendedSnapshot;
-}
+	OutModes.Init(MOVE_None, TransformAndVelocitySnapshots.Num());
+	if (!OwnerMovementComponent || !GameMode || OutModes.Num() == 0) { return; }
 
-void URewindComponent::ApplySnapshot(const FTransformAndVelocitySnapshot& Snapshot, bool bApplyPhysics)
-{
-	GetOwner()->SetActorTransform(Snapshot.Transform);
-	if (OwnerRootComponent && bApplyPhysics)
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::GetSnapshotMovementModes);
+
+	// Walk out from the snapshot the current mode belongs to in both directions, crossing each mode change once
+	const bool bIsPlayingBack = MovementModeSnapshotIndex != INDEX_NONE;
+	const int32 StartIndex = bIsPlayingBack ? MovementModeSnapshotIndex : OutModes.Num() - 1;
+	const double StartTime = bIsPlayingBack ? MovementModeSnapshotTime : NewestSnapshotEventTime;
+	OutModes[StartIndex] = MovementMode;
+
+	uint8 Mode = MovementMode;
+	double SnapshotTime = StartTime;
+	for (int32 Index = StartIndex + 1; Index < OutModes.Num(); ++Index)
+	{
+		const double NextSnapshotTime = SnapshotTime + TransformAndVelocitySnapshots[Index].TimeSinceLastSnapshot;
+		ForEachMovementModeChange(
+			SnapshotTime,
+			NextSnapshotTime,
+			false,
+			[&Mode](const FRewindMovementModeChange& Change, double) { Mode = Change.Mode; });
+		OutModes[Index] = static_cast<EMovementMode>(Mode);
+		SnapshotTime = NextSnapshotTime;
+	}
+
+	Mode = MovementMode;
+	SnapshotTime = StartTime;
+	for (int32 Index = StartIndex - 1; Index >= 0; --Index)
 	{
-		OwnerRootComponent->SetPhysicsLinearVelocity(Snapshot.LinearVelocity);
-		OwnerRootComponent->SetPhysicsAngularVelocityInRadians(Snapshot.AngularVelocityInRadians);
+		const double PreviousSnapshotTime = SnapshotTime - TransformAndVelocitySnapshots[Index + 1].TimeSinceLastSnapshot;
+		ForEachMovementModeChange(
+			PreviousSnapshotTime,
+			SnapshotTime,
+			true,
+			[&Mode](const FRewindMovementModeChange& Change, double) { Mode = Change.PreviousMode; });
+		OutModes[Index] = static_cast<EMovementMode>(Mode);
+		SnapshotTime = PreviousSnapshotTime;
 	}
 }
 
-void URewindComponent::ApplySnapshot(const FMovementVelocityAndModeSnapshot& Snapshot, bool bApplyTimeDilationToVelocity)
+void URewindComponent::ApplySnapshots(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha, ERewindApplyMode Mode)
 {
-	if (OwnerMovementComponent)
+	// The movement mode follows this component's own playhead rather than the world's, which it can lag or lead
+	if (MovementModeSnapshotIndex != INDEX_NONE) { UpdatePlaybackMovementMode(Alpha < 0.5f ? SnapshotIndexA : SnapshotIndexB); }
+
+	FRewindChannelContext Context = MakeChannelContext();
+	if (AttachmentTimeline.IsInitialized())
 	{
-		OwnerMovementComponent->Velocity =
-			bApplyTimeDilationToVelocity ? Snapshot.MovementVelocity * GameMode->GetGlobalRewindSpeed() : Snapshot.MovementVelocity;
-		OwnerMovementComponent->SetMovementMode(Snapshot.MovementMode);
+		// Snapshots older than the oldest attachment frame were recorded in a space that isn't known, so they are stepped
+		// over, or the owner stays where it is, rather than being placed in what may be the wrong space
+		const int32 AttachmentIndexOffset = TransformAndVelocitySnapshots.Num() - AttachmentTimeline.Num();
+		if (SnapshotIndexA < AttachmentIndexOffset && SnapshotIndexB < AttachmentIndexOffset) { return; }
+		if (SnapshotIndexA < AttachmentIndexOffset) { SnapshotIndexA = SnapshotIndexB; }
+		else if (SnapshotIndexB < AttachmentIndexOffset) { SnapshotIndexB = SnapshotIndexA; }
+		int32 AttachmentIndexA = SnapshotIndexA - AttachmentIndexOffset;
+		int32 AttachmentIndexB = SnapshotIndexB - AttachmentIndexOffset;
+
+		// Snapshots either side of an attach or detach are in different spaces, so playback steps across it
+		if (!AttachmentTimeline.IsSameAttachment(AttachmentIndexA, AttachmentIndexB))
+		{
+			if (Alpha < 0.5f)
+			{
+				SnapshotIndexB = SnapshotIndexA;
+				AttachmentIndexB = AttachmentIndexA;
+			}
+			else { SnapshotIndexA = SnapshotIndexB; }
+		}
+
+		// Relative transforms can't be placed once their parent is gone, so the owner stays where it is
+		if (!AttachmentTimeline.Apply(AttachmentIndexB, *GetOwner()->GetRootComponent())) { return; }
+		Context.bRelativeToAttachParent = AttachmentTimeline.IsRelative(AttachmentIndexB);
 	}
+
+	ChannelOps.Apply(*this, Context, SnapshotIndexA, SnapshotIndexB, Alpha, Mode);
 }
 
 void URewindComponent::VisualizeTimeline()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(URewindComponent::VisualizeTimeline);
 	if (!OwnerVisualizationComponent || !bIsVisualizingTimeline) { return; }
-	OwnerVisualizationComponent->SetInstancesFromSnapshots(TransformAndVelocitySnapshots);
+
+	// Snapshots of attached owners are relative to their parent, whose own timeline shows where they went
+	if (IsRecordingRelativeToAttachParent()) { return; }
+
+	// Visualization walks the whole timeline, so it reads the published window, which decodes compressed pages into the
+	// reader instead of making them resident again
+	const TRewindTimeline<FTransformAndVelocitySnapshot>::FReader Snapshots(TransformAndVelocitySnapshots.GetReadHandle());
+	OwnerVisualizationComponent->SetInstancesFromSnapshots(Snapshots);
 }
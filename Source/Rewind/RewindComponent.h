@@ -5,68 +5,71 @@
 #include "CoreMinimal.h"
 
 #include "Components/ActorComponent.h"
-#include "Runtime/Core/Public/Containers/RingBuffer.h"
+#include "RewindAttachmentTimeline.h"
+#include "RewindBodyTimeline.h"
+#include "RewindChannel.h"
+#include "RewindEventTrack.h"
+#include "RewindFlightRecorder.h"
+#include "RewindFractureTimeline.h"
+#include "RewindInstanceTimeline.h"
+#include "RewindPoseTimeline.h"
+#include "RewindPropertyTimeline.h"
+#include "RewindSignificance.h"
+#include "RewindSnapshots.h"
+#include "RewindTimeline.h"
 
 #include "RewindComponent.generated.h"
 
 class UCharacterMovementComponent;
+class UGeometryCollectionComponent;
+class UInstancedStaticMeshComponent;
 class URewindVisualizationComponent;
 class USkeletalMeshComponent;
 class ARewindGameMode;
+struct FRewindPhysicsBodyBuffer;
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeManipulationStarted);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeManipulationCompleted);
-
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRewindStarted);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRewindCompleted);
-
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnFastForwardStarted);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnFastForwardCompleted);
-
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeScrubStarted);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeScrubCompleted);
+// A change of an owner's movement mode; the payload of movement mode events on the world's event track
+struct FRewindMovementModeChange
+{
+	uint8 PreviousMode = MOVE_None;
+	uint8 PreviousCustomMode = 0;
+	uint8 Mode = MOVE_None;
+	uint8 CustomMode = 0;
+};
 
-	// State snapshots used when rewinding transforms and velocity
-USTRUCT()
-struct FTransformAndVelocitySnapshot
+// History of a component captured without copying snapshots; the last snapshot in the branch is its present
+struct FRewindComponentBranch
 {
-	GENERATED_BODY();
+	TRewindTimeline<FTransformAndVelocitySnapshot>::FBranch TransformAndVelocitySnapshots;
 
-	// Time since the last snapshot was recorded
-	UPROPERTY(Transient)
-	float TimeSinceLastSnapshot = 0.0f;
+	// Null unless movement is being snapshotted
+	TRewindTimeline<FMovementVelocityAndModeSnapshot>::FBranch MovementVelocityAndModeSnapshots;
 
-	// Transform at time snapshot was recorded
-	UPROPERTY(Transient)
-	FTransform Transform{ FVector::ZeroVector };
+	// What the owner was attached to for the newest snapshots, which says which space they are in; empty unless recording
+	// relative to attach parents
+	FRewindAttachmentTimeline::FBranch Attachments;
 
-	// Linear velocity from the owner's root primitive component at time snapshot was recorded
-	UPROPERTY(Transient)
-	FVector LinearVelocity = FVector::ZeroVector;
+	// Movement mode at the newest snapshot, and the mode changes between the snapshots timed in seconds relative to it; the
+	// event track only holds the changes of the present timeline, so branches carry their own. Unset unless movement is
+	// being snapshotted
+	TEnumAsByte<EMovementMode> MovementMode = MOVE_None;
+	uint8 CustomMovementMode = 0;
+	TArray<TPair<double, FRewindMovementModeChange>> MovementModeChanges;
 
-	// Angular velocity from the owner's root primitive component at time snapshot was recorded
-	UPROPERTY(Transient)
-	FVector AngularVelocityInRadians = FVector::ZeroVector;
+	bool IsValid() const { return TransformAndVelocitySnapshots.IsValid(); }
 };
 
-// State snapshots used when rewinding movement
-USTRUCT()
-struct FMovementVelocityAndModeSnapshot
-{
-	GENERATED_BODY();
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeManipulationStarted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeManipulationCompleted);
 
-	// Time since the last snapshot was recorded
-	UPROPERTY(Transient)
-	float TimeSinceLastSnapshot = 0.0f;
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRewindStarted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRewindCompleted);
 
-	// Movement velocity from the owner's movement component at time snapshot was recorded
-	UPROPERTY(Transient)
-	FVector MovementVelocity = FVector::ZeroVector;
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnFastForwardStarted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnFastForwardCompleted);
 
-	// Movement mode from the owner's movement component at time snapshot was recorded
-	UPROPERTY(Transient)
-	TEnumAsByte<enum EMovementMode> MovementMode = EMovementMode::MOVE_None;
-};
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeScrubStarted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTimeScrubCompleted);
 
 // Tracks snapshots of actor state to support rewinding time
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -83,10 +86,80 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
 	bool bSnapshotMovementVelocityAndMode = false;
 
+	// Whether the owner's character movement stops simulating while time is manipulated, so playback only writes the
+	// recorded transform and velocity instead of simulating movement that is overwritten every frame
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind", meta = (EditCondition = "bSnapshotMovementVelocityAndMode"))
+	bool bKinematicMovementPlayback = true;
+
+	// Whether a simulating root body should be recorded from the physics thread at the fixed physics step instead of being
+	// polled on the game thread; ignored when snapshotting movement
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
+	bool bRecordOnPhysicsThread = false;
+
+	// Parts of the owner's transform and root body velocity that are recorded and rewound; parts left out are neither stored
+	// nor restored, so a door that only swings can record just its rotation
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind", meta = (Bitmask, BitmaskEnum = "/Script/Rewind.ERewindSnapshotChannels"))
+	int32 RecordedChannels = static_cast<int32>(ERewindSnapshotChannels::All);
+
+	// Whether recorded channels are only stored once they vary, so the scale of actors that are never scaled, the location of
+	// actors that only rotate and the velocity of bodies that don't simulate cost nothing until they change
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
+	bool bDetectInvariantChannels = true;
+
+	// Whether actors attached to another rewindable actor record their transform relative to it, so they follow their
+	// parent during playback; attaching and detaching are rewound too
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
+	bool bRecordRelativeToAttachParent = true;
+
+	// Whether bodies that were asleep when a snapshot was recorded are put back to sleep when it is restored
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Physics")
+	bool bRestoreSleepState = true;
+
+	// Bodies restored with linear speed (cm/s) and angular speed (deg/s) below this are also put to sleep; 0 disables
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Physics", meta = (ClampMin = "0.0"))
+	float RestoreSleepSpeedThreshold = 0.0f;
+
+	// Whether every body of the owner's skeletal mesh physics asset should be recorded so ragdolls can be rewound; bodies
+	// are only stored for snapshots taken while the mesh is simulating
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Physics")
+	bool bRecordPhysicsAssetBodies = false;
+
+	// Whether per-instance transforms of the owner's instanced static mesh should be recorded, so large numbers of
+	// pieces such as debris can be rewound by a single component
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Instances")
+	bool bRecordInstances = false;
+
+	// Whether the pieces of the owner's geometry collection should be recorded, so fractured objects can be rewound and
+	// reassembled
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Fracture")
+	bool bRecordFracture = false;
+
+	// Paths of extra properties of the owner or its components to rewind, such as "Health" or "HealthComponent.Health";
+	// only plain data properties are supported, and floats, doubles, vectors, rotators and colors are interpolated
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Properties")
+	TArray<FString> RewoundProperties;
+
 	// Whether actor should pause animations during time scrubbing
 	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
 	bool bPauseAnimationDuringTimeScrubbing = false;
 
+	// Whether the owner's skeletal mesh pose should be recorded and played back directly, without evaluating the anim graph
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Pose")
+	bool bRecordPose = false;
+
+	// Largest rotation error (degrees) a bone may have when its recorded pose keys are reduced
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Pose", meta = (ClampMin = "0.0", EditCondition = "bRecordPose"))
+	float PoseRotationToleranceDegrees = 0.5f;
+
+	// Largest translation error (cm) a bone may have when its recorded pose keys are reduced
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Pose", meta = (ClampMin = "0.0", EditCondition = "bRecordPose"))
+	float PoseTranslationTolerance = 0.1f;
+
+	// Most snapshots a bone's rotation, translation or scale can go without a key; deciding whether a key is needed takes
+	// the same time however long the gap is, so this only keys bones that barely move now and again
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Pose", meta = (ClampMin = "1", EditCondition = "bRecordPose"))
+	int32 MaxPoseKeyGap = 900;
+
 	// Called when the component begins time manipulation
 	UPROPERTY(BlueprintAssignable, Category = "Rewind")
 	FOnTimeManipulationStarted OnTimeManipulationStarted;
@@ -177,6 +250,68 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rewind")
 	void SetIsRewindingEnabled(bool bEnabled);
 
+public:
+	// Returns the recorded transform and velocity snapshots
+	const TRewindTimeline<FTransformAndVelocitySnapshot>& GetTransformAndVelocitySnapshots() const { return TransformAndVelocitySnapshots; }
+
+	// Returns the recorded movement velocity and mode snapshots; empty unless movement is being snapshotted
+	const TRewindTimeline<FMovementVelocityAndModeSnapshot>& GetMovementVelocityAndModeSnapshots() const
+	{
+		return MovementVelocityAndModeSnapshots;
+	}
+
+	// Returns a handle for reading transform and velocity snapshots from other threads; request it on the game thread
+	TRewindTimeline<FTransformAndVelocitySnapshot>::FReadHandle GetTransformAndVelocityReadHandle()
+	{
+		return TransformAndVelocitySnapshots.GetReadHandle();
+	}
+
+	// Returns a handle for reading movement velocity and mode snapshots from other threads; request it on the game thread
+	TRewindTimeline<FMovementVelocityAndModeSnapshot>::FReadHandle GetMovementVelocityAndModeReadHandle()
+	{
+		return MovementVelocityAndModeSnapshots.GetReadHandle();
+	}
+
+	// Fills one movement mode per snapshot, the mode the owner had when it was recorded; walks the owner's mode changes
+	// alongside the snapshots once rather than searching for each. MOVE_None unless snapshotting movement
+	void GetSnapshotMovementModes(TArray<TEnumAsByte<EMovementMode>>& OutModes) const;
+
+	// Returns the recorded poses; these cover the newest snapshots, as poses aren't spilled by the flight recorder
+	const FRewindPoseTimeline& GetPoseTimeline() const { return PoseTimeline; }
+
+	// Returns what the owner was attached to for the newest snapshots; uninitialized unless recording relative to attach
+	// parents
+	const FRewindAttachmentTimeline& GetAttachmentTimeline() const { return AttachmentTimeline; }
+
+	// Records a snapshot of the owner's current state ahead of the regular cadence, so a branch captured straight after ends
+	// at the present rather than up to a snapshot interval before it; does nothing while manipulating time
+	void RecordSnapshotNow();
+
+	// Captures the timeline up to and including the current snapshot; cost is proportional to pages, not snapshots
+	FRewindComponentBranch CaptureBranch() { return CaptureBranch(LatestSnapshotIndex + 1); }
+
+	// Captures the whole timeline, including any future ahead of the playhead
+	FRewindComponentBranch CaptureWholeBranch() { return CaptureBranch(TransformAndVelocitySnapshots.Num()); }
+
+	// Replaces the timeline with a captured branch and snaps the owner to its present; fails while manipulating time.
+	// Branches don't hold poses, bodies, instances, pieces or properties, so that history is discarded and starts over
+	bool RestoreBranch(const FRewindComponentBranch& Branch);
+
+	// Restores the timeline the owner had when its level was unloaded; SecondsSinceUnload is how far the global playhead
+	// has moved since then, negative if it was rewound to before the unload. Joins any time manipulation in progress
+	void RestoreUnloadedBranch(const FRewindComponentBranch& Branch, double SecondsSinceUnload);
+
+	// Returns whether the future abandoned by the last rewind is still available
+	UFUNCTION(BlueprintCallable, Category = "Rewind")
+	bool HasAbandonedFuture() const { return AbandonedFuture.IsValid(); }
+
+	// Swaps the current timeline with the future abandoned by the last rewind; calling it again swaps back
+	UFUNCTION(BlueprintCallable, Category = "Rewind")
+	bool SwitchToAbandonedFuture();
+
+	// Returns the time since the latest snapshot was recorded (or, while manipulating time, the interpolation progress)
+	float GetTimeSinceSnapshotsChanged() const { return TimeSinceSnapshotsChanged; }
+
 public:
 	// Sets default values for this component's properties
 	URewindComponent();
@@ -189,12 +324,132 @@ public:
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+protected:
+	// Called when the component is removed from play
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Index of this component in the game mode's registry; maintained by the game mode
+	int32 RegistryIndex = INDEX_NONE;
+
+	// Game mode record of the owner's lifetime, if it was spawned or destroyed within the rewind window
+	int32 LifetimeRecordIndex = INDEX_NONE;
+
+	// Deactivates the owner so the game mode can keep it in an actor pool
+	void EnterPool();
+
+	// Reactivates a pooled owner with a timeline, snapped to its first snapshot if bAtStart or its last one otherwise, and
+	// joins any time manipulation in progress
+	void LeavePool(const FRewindComponentBranch& Branch, bool bAtStart);
+
+	// Returns whether the owner is deactivated in an actor pool
+	bool IsPooled() const { return bIsPooled; }
+
+	// Called by the game mode once every rewind component has ticked to record a snapshot deferred by the recording budget
+	void RecordDeferredSnapshot();
+
+	// Called by the game mode when the owner's significance is re-evaluated
+	void SetSignificance(ERewindSignificance InSignificance, const FRewindSignificanceTierSettings& Settings);
+
+	// Returns the significance tier the game mode last placed the owner in
+	UFUNCTION(BlueprintCallable, Category = "Rewind")
+	ERewindSignificance GetSignificance() const { return Significance; }
+
+	// Called by the game mode when rewinding starts
+	void OnGlobalRewindStarted();
+
+	// Called by the game mode when fast forwarding starts
+	void OnGlobalFastForwardStarted();
+
+	// Called by the game mode when time scrubbing starts
+	void OnGlobalTimeScrubStarted();
+
+	// Called by the game mode when rewinding completes
+	void OnGlobalRewindCompleted();
+
+	// Called by the game mode when fast forwarding completes
+	void OnGlobalFastForwardCompleted();
+
+	// Called by the game mode when time scrubbing completes
+	void OnGlobalTimeScrubCompleted();
+
+	// Called by the game mode when timeline visualization is enabled
+	void OnGlobalTimelineVisualizationEnabled();
+
+	// Called by the game mode when timeline visualization is disabled
+	void OnGlobalTimelineVisualizationDisabled();
+
 private:
-	// Buffer storing transform and velocity snapshots for rewinding
-	TRingBuffer<FTransformAndVelocitySnapshot> TransformAndVelocitySnapshots;
+	// Timeline storing transform and velocity snapshots for rewinding
+	FRewindTransformAndVelocityChannel TransformAndVelocitySnapshots;
+
+	// Timeline storing movement velocity and mode snapshots for rewinding
+	FRewindMovementVelocityAndModeChannel MovementVelocityAndModeSnapshots;
+
+	// Movement mode of the owner at the latest snapshot, or at the playhead while manipulating time; changes are recorded
+	// on the world's event track rather than with every snapshot
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	TEnumAsByte<EMovementMode> MovementMode = MOVE_None;
+	uint8 CustomMovementMode = 0;
 
-	// Buffer storing movement velocity and mode snapshots for rewinding
-	TRingBuffer<FMovementVelocityAndModeSnapshot> MovementVelocityAndModeSnapshots;
+	// Event type of movement mode changes on the world's event track
+	int32 MovementModeEventType = INDEX_NONE;
+
+	// Time on the world's event track the newest snapshot was recorded at
+	double NewestSnapshotEventTime = 0.0;
+
+	// Snapshot MovementMode belongs to during playback, and its time on the world's event track; INDEX_NONE while time
+	// flows normally, when MovementMode belongs to the newest snapshot
+	int32 MovementModeSnapshotIndex = INDEX_NONE;
+	double MovementModeSnapshotTime = 0.0;
+
+	// Mode changes of the last restored branch at their times on the world's event track; they stand in for this
+	// component's events on the track up to RestoredMovementModeTime, which belong to the timeline the branch replaced
+	TArray<TPair<double, FRewindMovementModeChange>> RestoredMovementModeChanges;
+	double RestoredMovementModeTime = TNumericLimits<double>::Lowest();
+
+	// Snapshot channels this component records, along with the optional timelines aligned with them, composed in BeginPlay;
+	// all share LatestSnapshotIndex
+	TRewindChannelOps<URewindComponent> ChannelOps;
+
+	// Rewindable actors the owner was attached to, aligned with the newest snapshots; empty unless recording relative to
+	// attach parents
+	FRewindAttachmentTimeline AttachmentTimeline;
+
+	// Skeletal poses of the owner, aligned with the newest transform and velocity snapshots; empty unless recording poses
+	FRewindPoseTimeline PoseTimeline;
+
+	// Scratch space for sampling poses during playback
+	TArray<FTransform> PlaybackBoneSpaceTransforms;
+
+	// Bodies of the owner's skeletal mesh physics asset, aligned with the newest snapshots; empty unless recording bodies
+	FRewindBodyTimeline BodyTimeline;
+
+	// Scratch space for sampling body transforms during playback
+	TArray<FTransform> PlaybackBodyTransforms;
+
+	// Instance transforms of the owner's instanced static mesh, aligned with the newest snapshots; empty unless recording
+	// instances
+	FRewindInstanceTimeline InstanceTimeline;
+
+	// Pieces and breaks of the owner's geometry collection, aligned with the newest snapshots; empty unless recording
+	// fracture
+	FRewindFractureTimeline FractureTimeline;
+
+	// Values of RewoundProperties, aligned with the newest snapshots; empty unless properties are listed
+	FRewindPropertyTimeline PropertyTimeline;
+
+	// Timeline as it was before the last rewind erased its future; shares pages with the current timeline
+	FRewindComponentBranch AbandonedFuture;
+
+	// Samples of the owner's root body recorded on the physics thread; null unless recording on the physics thread
+	TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe> PhysicsBodyBuffer;
+
+	// Simulation time of the latest physics thread sample turned into a snapshot; negative after playback
+	double LatestPhysicsSampleTime = -1.0;
+
+	// Spills snapshots that age out of the buffers to disk when the game mode's flight recorder is enabled
+	FRewindFlightRecorder FlightRecorder;
 
 	// Max snapshots to store; computed in BeginPlay
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
@@ -207,6 +462,25 @@ private:
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	int32 LatestSnapshotIndex = -1;
 
+	// Recorded channels that are currently being stored; grows as invariant channels start to vary
+	UPROPERTY(
+		Transient,
+		VisibleAnywhere,
+		Category = "Rewind|Debug",
+		meta = (Bitmask, BitmaskEnum = "/Script/Rewind.ERewindSnapshotChannels"))
+	int32 ActiveChannels = static_cast<int32>(ERewindSnapshotChannels::All);
+
+	// Owner transform when play began, or when it was last attached or detached, in the space snapshots are recorded in;
+	// stands in for parts of the transform that aren't being stored
+	FTransform ReferenceTransform;
+
+	// Parent and socket the owner was attached to when the recording space was last updated
+	TWeakObjectPtr<const USceneComponent> LastAttachParent;
+	FName LastAttachSocketName;
+
+	// Whether snapshots are recorded relative to the owner's attach parent, which is a rewindable actor
+	bool bRecordingRelativeToAttachParent = false;
+
 	// Root primitive component on owner, if one exists
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	UPrimitiveComponent* OwnerRootComponent;
@@ -219,6 +493,14 @@ private:
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	USkeletalMeshComponent* OwnerSkeletalMesh;
 
+	// Instanced static mesh component on owner whose instances are recorded, if one exists
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	UInstancedStaticMeshComponent* OwnerInstancedMesh;
+
+	// Geometry collection component on owner whose pieces are recorded, if one exists
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	UGeometryCollectionComponent* OwnerGeometryCollection;
+
 	// Rewind visualization component on owner, if one exists
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	URewindVisualizationComponent* OwnerVisualizationComponent;
@@ -231,6 +513,35 @@ private:
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	bool bPausedAnimation = false;
 
+	// Whether bone updates of the owner's skeletal mesh are suspended so recorded poses can be played back
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bSuspendedAnimGraph = false;
+
+	// Whether the owner's character movement tick is suspended while recorded movement is played back
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bSuspendedMovementSimulation = false;
+
+	// Whether the owner is deactivated in the game mode's actor pool, standing by to be resurrected by a rewind
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bIsPooled = false;
+
+	// Whether simulation of the owner's physics asset bodies is paused until their recorded state is restored
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bPausedBodySimulation = false;
+
+	// Whether the owner's physics asset bodies were simulating when their simulation was paused
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bWasSimulatingBodiesWhenPaused = false;
+
+	// Whether the owner's geometry collection is being played back; its physics is only torn down once a frame that differs
+	// from the present is applied
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bPlayingBackFracture = false;
+
+	// Whether physics of the owner's geometry collection is torn down while its recorded pieces are played back
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bPausedFractureSimulation = false;
+
 	// Whether animation was paused when the current time manipulation operation began
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	bool bAnimationsPausedAtStartOfTimeManipulation = false;
@@ -239,51 +550,91 @@ private:
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
 	bool bLastTimeManipulationWasRewind = true;
 
-	// Game mode for global rewind state
+	// Significance tier assigned by the game mode
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
-	ARewindGameMode* GameMode;
+	ERewindSignificance Significance = ERewindSignificance::High;
 
-	// Called when rewinding starts
-	UFUNCTION()
-	void OnGlobalRewindStarted();
+	// Snapshot interval for the current significance tier
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	float SnapshotIntervalSeconds = 1.0f / 30.0f;
 
-	// Called when fast forwarding starts
-	UFUNCTION()
-	void OnGlobalFastForwardStarted();
+	// Delay before the first snapshot, staggering recording across components
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	float RecordingPhaseSeconds = 0.0f;
 
-	// Called when time scrubbing starts
-	UFUNCTION()
-	void OnGlobalTimeScrubStarted();
+	// How late the latest snapshot was recorded relative to its deadline
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	float SnapshotLatenessSeconds = 0.0f;
 
-	// Called when rewinding completes
-	UFUNCTION()
-	void OnGlobalRewindCompleted();
+	// Consecutive frames a due snapshot has been deferred because the recording budget was spent
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	int32 NumDeferredRecordingFrames = 0;
 
-	// Called when fast forwarding completes
-	UFUNCTION()
-	void OnGlobalFastForwardCompleted();
+	// Number of frames between playback updates for the current significance tier
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	int32 PlaybackFrameInterval = 1;
 
-	// Called when time scrubbing completes
-	UFUNCTION()
-	void OnGlobalTimeScrubCompleted();
+	// Frames since playback was last updated
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	int32 PlaybackFramesSinceUpdate = 0;
 
-	// Called when timeline visualization is enabled
-	UFUNCTION()
-	void OnGlobalTimelineVisualizationEnabled();
+	// Time skipped since playback was last updated
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	float PendingPlaybackDeltaTime = 0.0f;
 
-	// Called when timeline visualization is disabled
-	UFUNCTION()
-	void OnGlobalTimelineVisualizationDisabled();
+	// Game mode for global rewind state
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	ARewindGameMode* GameMode;
 
 	// Computes required space and initializes the ring buffers
 	void InitializeRingBuffers(float MaxRewindSeconds);
 
-	// Stores a snapshot in the ring buffer
+	// Returns whether the owner's transform is currently recorded relative to the rewindable actor it is attached to
+	bool IsRecordingRelativeToAttachParent() const { return bRecordingRelativeToAttachParent; }
+
+	// Updates whether snapshots are recorded relative to the owner's attach parent, and the reference transform in that
+	// space, after the owner was attached or detached
+	void UpdateRecordingSpace();
+
+	// Adds recorded channels that have started to vary to ActiveChannels
+	void DetectVaryingChannels();
+
+	// Stores a snapshot in the ring buffer once one is due and the recording budget allows it
 	void RecordSnapshot(float DeltaTime);
 
-	// Deletes all snapshots after the latest one
+	// Returns how long after the latest snapshot the next one is due
+	float GetSnapshotDueSeconds() const;
+
+	// Records a due snapshot, carrying its lateness into the next deadline
+	void RecordDueSnapshot();
+
+	// Records the owner's current state into every timeline, regardless of cadence or budget
+	void WriteSnapshot();
+
+	// Turns samples recorded on the physics thread into snapshots
+	void RecordPhysicsSamples();
+
+	// Starts sampling the owner's root body on the physics thread; its physics state is recreated after playback
+	void RegisterPhysicsBody();
+
+	// Stops sampling the owner's root body on the physics thread
+	void UnregisterPhysicsBody();
+
+	// Drops the oldest snapshot from the ring buffers, handing it to the flight recorder if enabled
+	void DropOldestSnapshot();
+
+	// Streams spilled snapshots back into the front of the ring buffers when rewinding close to the oldest resident snapshot
+	void StreamInColdSnapshots();
+
+	// Deletes all snapshots after the latest one, keeping them as the abandoned future if the game mode allows it
 	void EraseFutureSnapshots();
 
+	// Captures the oldest NumSnapshots snapshots as a branch
+	FRewindComponentBranch CaptureBranch(int32 NumSnapshots);
+
+	// Accumulates DeltaTime and returns whether playback should update this frame, replacing DeltaTime with the accumulated time
+	bool ConsumePlaybackDeltaTime(float& DeltaTime);
+
 	// Plays back and forth through time using the snapshots in the ring buffer
 	void PlaySnapshots(float DeltaTime, bool bRewinding);
 
@@ -302,35 +653,95 @@ private:
 	// Recreates physics and movement state
 	void UnpausePhysics();
 
+	// Stops the owner's character movement from simulating during playback
+	void SuspendMovementSimulation();
+
+	// Lets the owner's character movement simulate again from the state restored by the latest snapshot
+	void ResumeMovementSimulation();
+
 	// Disables animation
 	void PauseAnimation();
 
 	// Resumes animation
 	void UnpauseAnimation();
 
+	// Stops the owner's skeletal mesh from evaluating its anim graph while recorded poses are played back
+	void SuspendAnimGraph();
+
+	// Lets the owner's skeletal mesh evaluate its anim graph again
+	void ResumeAnimGraph();
+
+	// Appends the owner's current skeletal pose to the pose timeline
+	void RecordPose();
+
+	// Appends the state of every physics asset body of the owner's skeletal mesh to the body timeline
+	void RecordBodies();
+
+	// Stops the owner's physics asset bodies from simulating during playback
+	void PauseBodySimulation();
+
+	// Restores the bodies recorded with the latest snapshot, simulating them again if they were simulating when recorded
+	void ResumeBodySimulation();
+
+	// Appends the instances of the owner's instanced static mesh that moved since the last snapshot
+	void RecordInstances();
+
+	// Appends the pieces of the owner's geometry collection that broke off or moved since the last snapshot
+	void RecordFracture();
+
+	// Starts playing back the owner's geometry collection; its physics keeps running until a frame that differs from the
+	// present is applied
+	void PauseFractureSimulation();
+
+	// Rebuilds the owner's geometry collection physics from the pieces recorded with the latest snapshot, if it was torn
+	// down during playback
+	void ResumeFractureSimulation();
+
+	// Applies the optional pose, body, instance, fracture and property channels recorded with two snapshots, blended by Alpha
+	void ApplyChannels(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha);
+
+	// Poses the owner's geometry collection at the blend of two fracture frames, tearing down its physics first if they
+	// differ from the present
+	void ApplyFracture(int32 FractureIndexA, int32 FractureIndexB, float Alpha);
+
+	// Blends the poses and simulated bodies recorded with two snapshots and writes the result straight to the owner's
+	// skeletal mesh
+	void ApplyPose(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha);
+
 	// Helper function for PlaySnapshots/PauseTime that handle cases where there are insufficient snapshots to interpolate
 	bool HandleInsufficientSnapshots();
 
 	// Interpolates between the two latest snapshots and applies the result to the owner
 	void InterpolateAndApplySnapshots(bool bRewinding);
 
-	// Blends between two transform and velocity snapshots
-	FTransformAndVelocitySnapshot BlendSnapshots(
-		const FTransformAndVelocitySnapshot& A,
-		const FTransformAndVelocitySnapshot& B,
-		float Alpha);
+	// Returns what snapshot channels capture from and apply to
+	FRewindChannelContext MakeChannelContext() const;
+
+	// Records a movement mode change on the world's event track if the owner's movement mode changed since the last snapshot
+	void RecordMovementMode();
+
+	// Brings MovementMode to the one the owner had at a snapshot, undoing or redoing the mode changes between it and the
+	// snapshot it belonged to
+	void UpdatePlaybackMovementMode(int32 SnapshotIndex);
+
+	// Returns the time on the world's event track a snapshot was recorded at, walking from the snapshot MovementMode
+	// belongs to
+	double GetSnapshotEventTime(int32 SnapshotIndex) const;
+
+	// Steps a movement mode the owner had at FromTime to the one it had at ToTime, which may be earlier
+	void StepMovementMode(double FromTime, double ToTime, TEnumAsByte<EMovementMode>& InOutMode, uint8& InOutCustomMode) const;
 
-	// Blends between two movement velocity and movement mode snapshots
-	FMovementVelocityAndModeSnapshot BlendSnapshots(
-		const FMovementVelocityAndModeSnapshot& A,
-		const FMovementVelocityAndModeSnapshot& B,
-		float Alpha);
+	// Calls Function(const FRewindMovementModeChange&, double Time) for each of the owner's mode changes after FromTime up
+	// to ToTime, newest first when walking back through time
+	template <typename FunctionType>
+	void ForEachMovementModeChange(double FromTime, double ToTime, bool bReverse, FunctionType&& Function) const;
 
-	// Applies the provided transform and velocity snapshot to the owner
-	void ApplySnapshot(const FTransformAndVelocitySnapshot& Snapshot, bool bApplyPhysics);
+	// Handler of movement mode events crossed by the event track's playhead, which ignores them: each component applies
+	// its own mode changes as its snapshots cross them, since its playback can lag or lead the world's playhead
+	static void HandleMovementModeEvent(UObject* Target, const void* Payload, ERewindEventDirection Direction) {}
 
-	// Applies the provided movement velocity and movement mode snapshot to the owner
-	void ApplySnapshot(const FMovementVelocityAndModeSnapshot& Snapshot, bool bApplyTimeDilationToVelocity);
+	// Applies the blend of two snapshots, or a single snapshot when both indices match, from every composed channel
+	void ApplySnapshots(int32 SnapshotIndexA, int32 SnapshotIndexB, float Alpha, ERewindApplyMode Mode);
 
 private:
 	// Debug helper to draw snapshots when `Rewind.VisualizeSnapshots 1` is set
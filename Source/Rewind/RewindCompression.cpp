@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindCompression.h"
+
+#include "Misc/Compression.h"
+
+namespace RewindCompression
+{
+	// Oodle gives the best ratio/speed tradeoff for the small, repetitive blocks produced by snapshots
+	static const FName CompressionFormat = NAME_Oodle;
+} // namespace RewindCompression
+
+bool RewindCompression::Compress(TArrayView<const uint8> Data, TArray<uint8>& OutCompressed)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(RewindCompression::Compress);
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(CompressionFormat, Data.Num());
+	OutCompressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(CompressionFormat, OutCompressed.GetData(), CompressedSize, Data.GetData(), Data.Num()))
+	{
+		OutCompressed.Reset();
+		return false;
+	}
+
+	OutCompressed.SetNum(CompressedSize, false /*bAllowShrinking*/);
+	return true;
+}
+
+bool RewindCompression::Decompress(TArrayView<const uint8> Compressed, int32 UncompressedSize, TArray<uint8>& OutData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(RewindCompression::Decompress);
+
+	OutData.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(CompressionFormat, OutData.GetData(), UncompressedSize, Compressed.GetData(), Compressed.Num()))
+	{
+		OutData.Reset();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace RewindCompression
+{
+	// Compresses Data into OutCompressed; safe to call from worker threads
+	REWIND_API bool Compress(TArrayView<const uint8> Data, TArray<uint8>& OutCompressed);
+
+	// Decompresses a buffer produced by Compress; UncompressedSize must match the original size
+	REWIND_API bool Decompress(TArrayView<const uint8> Compressed, int32 UncompressedSize, TArray<uint8>& OutData);
+} // namespace RewindCompression
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindEventTrack.h"
+
+#include "Algo/BinarySearch.h"
+
+int32 FRewindEventTrack::RegisterEventType(FName Name, FRewindEventHandler Handler)
+{
+	check(Handler);
+
+	const int32 ExistingType = TypeNames.IndexOfByKey(Name);
+	if (ExistingType != INDEX_NONE) { return ExistingType; }
+
+	TypeNames.Add(Name);
+	return Handlers.Add(Handler);
+}
+
+void FRewindEventTrack::Record(int32 Type, UObject* Target, const void* Payload, int32 PayloadSize, int32 PayloadAlignment)
+{
+	check(Handlers.IsValidIndex(Type));
+
+	// Events can only be recorded where time is flowing; while manipulating time, handlers are replaying recorded ones
+	if (!IsAtPresent()) { return; }
+
+	FEvent& Event = Events.AddDefaulted_GetRef();
+	Event.Target = Target;
+	Event.Type = Type;
+	Event.PayloadOffset = Align(Payloads.Num(), PayloadAlignment);
+	Payloads.SetNumUninitialized(Event.PayloadOffset + PayloadSize, false);
+	FMemory::Memcpy(Payloads.GetData() + Event.PayloadOffset, Payload, PayloadSize);
+	Times.Add(PresentTime);
+}
+
+void FRewindEventTrack::Advance(float DeltaTime, float RetentionSeconds)
+{
+	// The future the playhead was moved back over is being overwritten, as it is for snapshots
+	if (PlayheadTime < PresentTime)
+	{
+		RemoveEventsAfter(PlayheadTime);
+		PresentTime = PlayheadTime;
+	}
+
+	PresentTime += DeltaTime;
+	PlayheadTime = PresentTime;
+
+	if (RetentionSeconds > 0.0f && PresentTime - RetentionSeconds > OldestTime)
+	{
+		OldestTime = PresentTime - RetentionSeconds;
+		RemoveEventsUpTo(OldestTime);
+	}
+}
+
+void FRewindEventTrack::MovePlayhead(float DeltaTime)
+{
+	const double FromTime = PlayheadTime;
+	PlayheadTime = FMath::Clamp(PlayheadTime + DeltaTime, OldestTime, PresentTime);
+	if (PlayheadTime == FromTime || Num() == 0) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindEventTrack::MovePlayhead);
+
+	const bool bRewinding = PlayheadTime < FromTime;
+	const ERewindEventDirection Direction = bRewinding ? ERewindEventDirection::Reverse : ERewindEventDirection::Forward;
+	ForEachEvent(
+		FMath::Min(FromTime, PlayheadTime),
+		FMath::Max(FromTime, PlayheadTime),
+		bRewinding,
+		[this, Direction](const FRewindEventView& Event)
+		{
+			// Events whose target was destroyed have nothing left to undo or redo
+			if (Event.Target) { Handlers[Event.Type](Event.Target, Event.Payload, Direction); }
+			return true;
+		});
+}
+
+void FRewindEventTrack::Empty()
+{
+	Times.Empty();
+	Events.Empty();
+	Payloads.Empty();
+	FirstEvent = 0;
+	PresentTime = 0.0;
+	PlayheadTime = 0.0;
+	OldestTime = 0.0;
+}
+
+int32 FRewindEventTrack::FindFirstEventAfter(double Time) const
+{
+	const TArrayView<const double> LiveTimes = MakeArrayView(Times).Slice(FirstEvent, Num());
+	return FirstEvent + Algo::UpperBound(LiveTimes, Time);
+}
+
+FRewindEventView FRewindEventTrack::GetEvent(int32 Index) const
+{
+	const FEvent& Event = Events[Index];
+	FRewindEventView View;
+	View.Time = Times[Index];
+	View.Type = Event.Type;
+	View.Target = Event.Target.Get();
+	View.Payload = Payloads.GetData() + Event.PayloadOffset;
+	return View;
+}
+
+void FRewindEventTrack::RemoveEventsUpTo(double Time)
+{
+	FirstEvent = FindFirstEventAfter(Time);
+
+	// Compact once most of the arrays are forgotten events, so forgetting costs amortized constant time per event
+	if (FirstEvent < 64 || FirstEvent < Times.Num() / 2) { return; }
+
+	const int32 FirstPayloadByte = FirstEvent < Events.Num() ? Events[FirstEvent].PayloadOffset : Payloads.Num();
+	const int32 PayloadShift = FirstPayloadByte & ~15;
+	Times.RemoveAt(0, FirstEvent, false);
+	Events.RemoveAt(0, FirstEvent, false);
+	Payloads.RemoveAt(0, PayloadShift, false);
+	for (FEvent& Event : Events) { Event.PayloadOffset -= PayloadShift; }
+	FirstEvent = 0;
+}
+
+void FRewindEventTrack::RemoveEventsAfter(double Time)
+{
+	const int32 NumToKeep = FindFirstEventAfter(Time);
+	if (NumToKeep == Times.Num()) { return; }
+
+	Payloads.SetNum(Events[NumToKeep].PayloadOffset, false);
+	Times.SetNum(NumToKeep, false);
+	Events.SetNum(NumToKeep, false);
+}
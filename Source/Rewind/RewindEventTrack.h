@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <type_traits>
+
+// Which way the playhead crossed an event
+enum class ERewindEventDirection : uint8
+{
+	// Rewinding over the event; the handler undoes it
+	Reverse,
+
+	// Fast forwarding over the event; the handler redoes it
+	Forward,
+};
+
+// Undoes or redoes one kind of event on its target; Payload points to the payload the event was recorded with
+using FRewindEventHandler = void (*)(UObject* Target, const void* Payload, ERewindEventDirection Direction);
+
+// An event as seen by visitors of the track
+struct FRewindEventView
+{
+	double Time = 0.0;
+	int32 Type = INDEX_NONE;
+	UObject* Target = nullptr;
+	const void* Payload = nullptr;
+};
+
+/**
+ * Sparse, time sorted log of one-shot events of a world, such as impacts, sounds, spawns, damage or movement mode changes,
+ * which can't be interpolated between snapshots.
+ *
+ * Events are recorded at the track's present time while time flows normally. While time is manipulated, the playhead
+ * moves instead, and every event it crosses is dispatched to its type's handler: in reverse, newest first, when
+ * rewinding over it, and forward, oldest first, when fast forwarding over it. Times are kept in their own array so
+ * finding the events crossed each frame is a binary search over contiguous memory, O(log n + k). Payloads are plain
+ * data copied into a single arena, so recording never allocates per event.
+ */
+class REWIND_API FRewindEventTrack
+{
+public:
+	// Registers a kind of event, or returns the existing type registered under Name
+	int32 RegisterEventType(FName Name, FRewindEventHandler Handler);
+
+	// Records an event at the present; ignored while the playhead is away from the present
+	template <typename PayloadType>
+	void Record(int32 Type, UObject* Target, const PayloadType& Payload)
+	{
+		static_assert(std::is_trivially_copyable_v<PayloadType>, "Event payloads are copied as raw bytes");
+		static_assert(alignof(PayloadType) <= 16, "Event payloads are aligned to at most 16 bytes");
+		Record(Type, Target, &Payload, sizeof(PayloadType), alignof(PayloadType));
+	}
+
+	// Returns the time events are recorded at
+	double GetPresentTime() const { return PresentTime; }
+
+	// Returns the time of the playhead; equal to the present unless time is being manipulated
+	double GetPlayheadTime() const { return PlayheadTime; }
+
+	// Returns whether events can be recorded, which is whenever time isn't being manipulated
+	bool IsAtPresent() const { return PlayheadTime == PresentTime; }
+
+	// Returns the oldest time the playhead can be moved to
+	double GetOldestTime() const { return OldestTime; }
+
+	int32 Num() const { return Times.Num() - FirstEvent; }
+
+	// Lets time flow: erases events the playhead was moved back over, then advances the present and forgets events older
+	// than RetentionSeconds; 0 keeps every event
+	void Advance(float DeltaTime, float RetentionSeconds);
+
+	// Moves the playhead by DeltaTime, negative to rewind, dispatching the handlers of every event it crosses
+	void MovePlayhead(float DeltaTime);
+
+	// Calls Visitor for every event with FromTime < Time <= ToTime, in time order or newest first, until it returns false
+	template <typename VisitorType>
+	void ForEachEvent(double FromTime, double ToTime, bool bNewestFirst, VisitorType&& Visitor) const
+	{
+		const int32 Begin = FindFirstEventAfter(FromTime);
+		const int32 End = FindFirstEventAfter(ToTime);
+		for (int32 Step = 0; Step < End - Begin; ++Step)
+		{
+			if (!Visitor(GetEvent(bNewestFirst ? End - 1 - Step : Begin + Step))) { return; }
+		}
+	}
+
+	// Removes every event and restarts time from zero
+	void Empty();
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Times.GetAllocatedSize() + Events.GetAllocatedSize() + Payloads.GetAllocatedSize() + Handlers.GetAllocatedSize()
+			+ TypeNames.GetAllocatedSize();
+	}
+
+private:
+	struct FEvent
+	{
+		TWeakObjectPtr<UObject> Target;
+		int32 PayloadOffset = 0;
+		int32 Type = INDEX_NONE;
+	};
+
+	void Record(int32 Type, UObject* Target, const void* Payload, int32 PayloadSize, int32 PayloadAlignment);
+
+	// Returns the index of the first live event recorded after Time
+	int32 FindFirstEventAfter(double Time) const;
+
+	FRewindEventView GetEvent(int32 Index) const;
+
+	// Forgets events recorded at or before Time
+	void RemoveEventsUpTo(double Time);
+
+	// Erases events recorded after Time
+	void RemoveEventsAfter(double Time);
+
+	// Time of every event, ascending; events before FirstEvent have been forgotten and are compacted away in batches
+	TArray<double> Times;
+	TArray<FEvent> Events;
+	int32 FirstEvent = 0;
+
+	// Payloads of every event, in recording order
+	TArray<uint8> Payloads;
+
+	// Handler and name of every registered event type
+	TArray<FRewindEventHandler> Handlers;
+	TArray<FName> TypeNames;
+
+	double PresentTime = 0.0;
+	double PlayheadTime = 0.0;
+	double OldestTime = 0.0;
+};
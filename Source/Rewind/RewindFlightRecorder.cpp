@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindFlightRecorder.h"
+
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Rewind.h"
+#include "RewindCompression.h"
+
+namespace RewindFlightRecorder
+{
+	// Header at the start of each uncompressed block; padded so the snapshots that follow stay aligned
+	struct FBlockHeader
+	{
+		int32 NumSnapshots = 0;
+		int32 bHasMovement = 0;
+		int32 Padding[2] = { 0, 0 };
+	};
+	static_assert(sizeof(FBlockHeader) % alignof(FTransformAndVelocitySnapshot) == 0, "Snapshots must be aligned within blocks");
+	static_assert(sizeof(FBlockHeader) % alignof(FMovementVelocityAndModeSnapshot) == 0, "Snapshots must be aligned within blocks");
+
+	// Pushes snapshots onto the front of a ring buffer, preserving their order
+	template <typename SnapshotType>
+	void PushFront(TRewindTimeline<SnapshotType>& Buffer, TArrayView<const SnapshotType> Snapshots)
+	{
+		for (int32 Index = Snapshots.Num() - 1; Index >= 0; --Index) { Buffer.AddFront(Snapshots[Index]); }
+	}
+} // namespace RewindFlightRecorder
+
+FRewindSpillFile::~FRewindSpillFile()
+{
+	// Tasks keep the file alive, so nothing can be in flight here; don't wait on the pipe as we may be destroyed from it
+	WriteHandle.Reset();
+	ReadHandle.Reset();
+	if (!FileName.IsEmpty()) { FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FileName); }
+}
+
+bool FRewindSpillFile::Open(const FString& InFileName)
+{
+	check(!WriteHandle.IsValid());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(InFileName));
+	WriteHandle.Reset(PlatformFile.OpenWrite(*InFileName, false /*bAppend*/, true /*bAllowRead*/));
+	ReadHandle.Reset(WriteHandle ? PlatformFile.OpenRead(*InFileName, true /*bAllowWrite*/) : nullptr);
+	if (!WriteHandle || !ReadHandle)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Failed to open rewind spill file %s; flight recorder disabled"), *InFileName);
+		WriteHandle.Reset();
+		ReadHandle.Reset();
+		return false;
+	}
+
+	FileName = InFileName;
+	EndOffset = 0;
+	return true;
+}
+
+void FRewindSpillFile::Close()
+{
+	if (FileName.IsEmpty()) { return; }
+
+	// Spilled history is only meaningful for the current session
+	Pipe.WaitUntilEmpty();
+	WriteHandle.Reset();
+	ReadHandle.Reset();
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FileName);
+	FileName.Reset();
+}
+
+UE::Tasks::TTask<FRewindSpillBlock> FRewindSpillFile::WriteBlockAsync(TFunction<TArray<uint8>()>&& PackBlock)
+{
+	// Pack and compress in parallel with other blocks, then append in order on the pipe
+	UE::Tasks::TTask<TArray<uint8>> CompressTask = UE::Tasks::Launch(
+		UE_SOURCE_LOCATION,
+		[PackBlock = MoveTemp(PackBlock)]()
+		{
+			// Prefix the compressed bytes with the original size so the pipe can fill in the block
+			const TArray<uint8> Data = PackBlock();
+			TArray<uint8> Compressed;
+			RewindCompression::Compress(Data, Compressed);
+			int32 UncompressedSize = Data.Num();
+			Compressed.Insert(reinterpret_cast<const uint8*>(&UncompressedSize), sizeof(UncompressedSize), 0);
+			return Compressed;
+		});
+
+	return Pipe.Launch(
+		UE_SOURCE_LOCATION,
+		[This = AsShared(), CompressTask]() mutable
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FRewindSpillFile::WriteBlock);
+
+			FRewindSpillBlock Block;
+			const TArray<uint8>& Compressed = CompressTask.GetResult();
+			if (!This->WriteHandle || Compressed.Num() <= int32(sizeof(int32))) { return Block; }
+
+			FMemory::Memcpy(&Block.UncompressedSize, Compressed.GetData(), sizeof(int32));
+			Block.Offset = This->EndOffset;
+			Block.CompressedSize = Compressed.Num() - sizeof(int32);
+			This->WriteHandle->Write(Compressed.GetData() + sizeof(int32), Block.CompressedSize);
+			This->WriteHandle->Flush();
+			This->EndOffset += Block.CompressedSize;
+			return Block;
+		},
+		UE::Tasks::Prerequisites(CompressTask));
+}
+
+UE::Tasks::TTask<TArray<uint8>> FRewindSpillFile::ReadBlockAsync(UE::Tasks::TTask<FRewindSpillBlock> WriteTask)
+{
+	return Pipe.Launch(
+		UE_SOURCE_LOCATION,
+		[This = AsShared(), WriteTask]() mutable
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FRewindSpillFile::ReadBlock);
+
+			TArray<uint8> Data;
+			const FRewindSpillBlock& Block = WriteTask.GetResult();
+			if (!This->ReadHandle || Block.CompressedSize == 0) { return Data; }
+
+			TArray<uint8> Compressed;
+			Compressed.SetNumUninitialized(Block.CompressedSize);
+			if (This->ReadHandle->Seek(Block.Offset) && This->ReadHandle->Read(Compressed.GetData(), Compressed.Num()))
+			{
+				RewindCompression::Decompress(Compressed, Block.UncompressedSize, Data);
+			}
+			return Data;
+		},
+		UE::Tasks::Prerequisites(WriteTask));
+}
+
+void FRewindFlightRecorder::Initialize(TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> InSpillFile, int32 InBlockSize)
+{
+	SpillFile = InSpillFile;
+	BlockSize = FMath::Max(InBlockSize, 1);
+}
+
+void FRewindFlightRecorder::Spill(
+	TRewindTimeline<FTransformAndVelocitySnapshot>& TransformAndVelocitySnapshots,
+	TRewindTimeline<FMovementVelocityAndModeSnapshot>* MovementVelocityAndModeSnapshots)
+{
+	check(IsEnabled());
+
+	// Once every snapshot of the captured page has been spilled, the page that now holds the oldest snapshot is captured
+	if (Capture.NumSnapshots == CaptureSize)
+	{
+		EndCapture();
+		if (NumStagedSnapshots >= BlockSize)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FRewindFlightRecorder::Spill);
+
+			SpilledBlocks.Add(SpillFile->WriteBlockAsync([Runs = MoveTemp(StagedRuns)]() { return PackBlock(Runs); }));
+			StagedRuns.Reset();
+			NumStagedSnapshots = 0;
+		}
+
+		CaptureSize = TransformAndVelocitySnapshots.GetNumInOldestPage();
+		Capture.TransformAndVelocity = TransformAndVelocitySnapshots.Branch(CaptureSize);
+		if (MovementVelocityAndModeSnapshots) { Capture.MovementVelocityAndMode = MovementVelocityAndModeSnapshots->Branch(CaptureSize); }
+	}
+	++Capture.NumSnapshots;
+}
+
+void FRewindFlightRecorder::EndCapture()
+{
+	if (Capture.NumSnapshots > 0)
+	{
+		NumStagedSnapshots += Capture.NumSnapshots;
+		StagedRuns.Add(MoveTemp(Capture));
+	}
+	Capture = FRun();
+	CaptureSize = 0;
+}
+
+void FRewindFlightRecorder::Prefetch()
+{
+	if (PendingRead.IsValid()) { return; }
+
+	// Staged runs are the newest cold history, so they come back first; they are packed on a worker like a block read
+	EndCapture();
+	if (StagedRuns.Num() > 0)
+	{
+		PendingReadRuns = MoveTemp(StagedRuns);
+		PendingRead = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Runs = PendingReadRuns]() { return PackBlock(Runs); });
+		StagedRuns.Reset();
+		NumStagedSnapshots = 0;
+	}
+	else if (SpilledBlocks.Num() > 0)
+	{
+		PendingReadBlock = SpilledBlocks.Pop(false /*bAllowShrinking*/);
+		PendingRead = SpillFile->ReadBlockAsync(PendingReadBlock);
+	}
+}
+
+void FRewindFlightRecorder::CancelRead()
+{
+	if (!PendingRead.IsValid()) { return; }
+
+	// Nothing is spilled while time is manipulated, so the block is still the newest cold history and goes back on the
+	// newest end of wherever it came from; the read itself finishes on the worker and is ignored
+	if (PendingReadBlock.IsValid()) { SpilledBlocks.Add(MoveTemp(PendingReadBlock)); }
+	else
+	{
+		for (const FRun& Run : PendingReadRuns) { NumStagedSnapshots += Run.NumSnapshots; }
+		StagedRuns.Insert(MoveTemp(PendingReadRuns), 0);
+	}
+	PendingRead = UE::Tasks::TTask<TArray<uint8>>();
+	PendingReadBlock = UE::Tasks::TTask<FRewindSpillBlock>();
+	PendingReadRuns.Reset();
+}
+
+void FRewindFlightRecorder::DiscardColdHistory()
+{
+	// The spill file is append-only, so discarded blocks simply become unreachable until the session ends
+	Capture = FRun();
+	CaptureSize = 0;
+	StagedRuns.Reset();
+	NumStagedSnapshots = 0;
+	SpilledBlocks.Reset();
+	PendingRead = UE::Tasks::TTask<TArray<uint8>>();
+	PendingReadBlock = UE::Tasks::TTask<FRewindSpillBlock>();
+	PendingReadRuns.Reset();
+}
+
+TArray<uint8> FRewindFlightRecorder::PackBlock(const TArray<FRun>& Runs)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindFlightRecorder::PackBlock);
+
+	// Movement is only kept if every run has it, which is the case unless movement snapshotting changed mid session
+	TArray<FTransformAndVelocitySnapshot> TransformAndVelocity;
+	TArray<FMovementVelocityAndModeSnapshot> MovementVelocityAndMode;
+	bool bHasMovement = true;
+	for (const FRun& Run : Runs)
+	{
+		TRewindTimeline<FTransformAndVelocitySnapshot>::CopyBranch(Run.TransformAndVelocity, Run.NumSnapshots, TransformAndVelocity);
+		bHasMovement &= Run.MovementVelocityAndMode.IsValid();
+		if (bHasMovement)
+		{
+			TRewindTimeline<FMovementVelocityAndModeSnapshot>::CopyBranch(
+				Run.MovementVelocityAndMode,
+				Run.NumSnapshots,
+				MovementVelocityAndMode);
+		}
+	}
+
+	// Snapshots are plain data and the file never outlives the session
+	RewindFlightRecorder::FBlockHeader Header;
+	Header.NumSnapshots = TransformAndVelocity.Num();
+	Header.bHasMovement = bHasMovement;
+
+	TArray<uint8> Data;
+	Data.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	Data.Append(reinterpret_cast<const uint8*>(TransformAndVelocity.GetData()), TransformAndVelocity.NumBytes());
+	if (bHasMovement)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(MovementVelocityAndMode.GetData()), MovementVelocityAndMode.NumBytes());
+	}
+	return Data;
+}
+
+int32 FRewindFlightRecorder::RestoreReady(
+	TRewindTimeline<FTransformAndVelocitySnapshot>& TransformAndVelocitySnapshots,
+	TRewindTimeline<FMovementVelocityAndModeSnapshot>* MovementVelocityAndModeSnapshots)
+{
+	using namespace RewindFlightRecorder;
+
+	// Never wait on the worker; playback simply holds at the oldest resident snapshot until the block arrives
+	if (!PendingRead.IsValid() || !PendingRead.IsCompleted()) { return 0; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindFlightRecorder::RestoreReady);
+
+	TArray<uint8> Data = MoveTemp(PendingRead.GetResult());
+	PendingRead = UE::Tasks::TTask<TArray<uint8>>();
+	PendingReadBlock = UE::Tasks::TTask<FRewindSpillBlock>();
+	PendingReadRuns.Reset();
+
+	// Restored snapshots go in front of the captured page, which has to be captured again from its new front
+	EndCapture();
+
+	FBlockHeader Header;
+	if (Data.Num() < int32(sizeof(Header)))
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Failed to read spilled rewind history; older snapshots are lost"));
+		SpilledBlocks.Reset();
+		return 0;
+	}
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+
+	const uint8* TransformData = Data.GetData() + sizeof(Header);
+	const uint8* MovementData = TransformData + Header.NumSnapshots * sizeof(FTransformAndVelocitySnapshot);
+	PushFront(
+		TransformAndVelocitySnapshots,
+		MakeArrayView(reinterpret_cast<const FTransformAndVelocitySnapshot*>(TransformData), Header.NumSnapshots));
+	if (MovementVelocityAndModeSnapshots)
+	{
+		TArray<FMovementVelocityAndModeSnapshot> MovementSnapshots;
+		MovementSnapshots.SetNum(Header.NumSnapshots);
+		if (Header.bHasMovement) { FMemory::Memcpy(MovementSnapshots.GetData(), MovementData, MovementSnapshots.NumBytes()); }
+		PushFront<FMovementVelocityAndModeSnapshot>(*MovementVelocityAndModeSnapshots, MovementSnapshots);
+	}
+
+	return Header.NumSnapshots;
+}
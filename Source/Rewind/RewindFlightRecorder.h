@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RewindSnapshots.h"
+#include "RewindTimeline.h"
+#include "Tasks/Pipe.h"
+#include "Tasks/Task.h"
+
+class IFileHandle;
+
+// Location of a compressed block of snapshots in the spill file
+struct FRewindSpillBlock
+{
+	// Byte offset of the block in the spill file
+	uint64 Offset = 0;
+
+	// Size of the block on disk
+	int32 CompressedSize = 0;
+
+	// Size of the block once decompressed
+	int32 UncompressedSize = 0;
+};
+
+// Append-only file of compressed snapshot blocks shared by all rewind components in a world
+// All compression and file access is serialized on a worker pipe, so callers never block on I/O
+class REWIND_API FRewindSpillFile : public TSharedFromThis<FRewindSpillFile, ESPMode::ThreadSafe>
+{
+public:
+	~FRewindSpillFile();
+
+	// Creates the spill file, replacing any left over from a previous session
+	bool Open(const FString& InFileName);
+
+	// Waits for outstanding work, then closes and deletes the spill file
+	void Close();
+
+	// Packs a block, compresses it and appends it to the file, all on worker threads
+	UE::Tasks::TTask<FRewindSpillBlock> WriteBlockAsync(TFunction<TArray<uint8>()>&& PackBlock);
+
+	// Reads and decompresses a block on a worker thread; ordered after the write that produced it
+	UE::Tasks::TTask<TArray<uint8>> ReadBlockAsync(UE::Tasks::TTask<FRewindSpillBlock> WriteTask);
+
+private:
+	// Serializes all file access and keeps reads ordered after the writes they depend on
+	UE::Tasks::FPipe Pipe{ UE_SOURCE_LOCATION };
+
+	// Handles used from the pipe only
+	TUniquePtr<IFileHandle> WriteHandle;
+	TUniquePtr<IFileHandle> ReadHandle;
+
+	// End of the file; only touched from the pipe
+	uint64 EndOffset = 0;
+
+	FString FileName;
+};
+
+// Spills snapshots that age out of a component's in-memory window and streams them back when rewinding past it
+class REWIND_API FRewindFlightRecorder
+{
+public:
+	// Enables spilling to the provided file in blocks of BlockSize snapshots
+	void Initialize(TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> InSpillFile, int32 InBlockSize);
+
+	// Returns whether snapshots are spilled instead of dropped
+	bool IsEnabled() const { return SpillFile.IsValid(); }
+
+	// Returns the number of snapshots compressed into each block
+	int32 GetBlockSize() const { return BlockSize; }
+
+	// Returns whether there are snapshots older than the in-memory window
+	bool HasColdHistory() const
+	{
+		return Capture.NumSnapshots > 0 || StagedRuns.Num() > 0 || SpilledBlocks.Num() > 0 || PendingRead.IsValid();
+	}
+
+	// Takes the oldest in-memory snapshot just before it is popped, spilling a block once enough have accumulated
+	// The page holding it is captured as a branch when the first of its snapshots ages out, so aged pages are spilled
+	// without being decompressed or copied on the game thread; workers decode them when the block is packed
+	void Spill(
+		TRewindTimeline<FTransformAndVelocitySnapshot>& TransformAndVelocitySnapshots,
+		TRewindTimeline<FMovementVelocityAndModeSnapshot>* MovementVelocityAndModeSnapshots);
+
+	// Stops spilling from the captured page; call before removing snapshots that haven't been spilled from the timeline
+	void EndCapture();
+
+	// Starts streaming the newest cold history back in if none is already in flight
+	void Prefetch();
+
+	// Puts the block being streamed in back with the cold history, to be read again by the next rewind; call when time
+	// resumes, before newer snapshots are spilled
+	void CancelRead();
+
+	// Forgets all cold history; used when the in-memory timeline is replaced by a branch
+	void DiscardColdHistory();
+
+	// Pushes any cold snapshots that are ready onto the front of the buffers; returns how many were restored
+	int32 RestoreReady(
+		TRewindTimeline<FTransformAndVelocitySnapshot>& TransformAndVelocitySnapshots,
+		TRewindTimeline<FMovementVelocityAndModeSnapshot>* MovementVelocityAndModeSnapshots);
+
+private:
+	TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> SpillFile;
+
+	int32 BlockSize = 256;
+
+	// Spilled snapshots still held by the pages they were recorded in
+	struct FRun
+	{
+		TRewindTimeline<FTransformAndVelocitySnapshot>::FBranch TransformAndVelocity;
+
+		// Null unless movement is being snapshotted
+		TRewindTimeline<FMovementVelocityAndModeSnapshot>::FBranch MovementVelocityAndMode;
+
+		// Number of the branches' oldest snapshots that have been spilled
+		int32 NumSnapshots = 0;
+	};
+
+	// Packs runs into the uncompressed block layout; runs on worker threads
+	static TArray<uint8> PackBlock(const TArray<FRun>& Runs);
+
+	// Page the oldest snapshots are spilled from, and how many snapshots it was captured with
+	FRun Capture;
+	int32 CaptureSize = 0;
+
+	// Runs waiting to fill a block, oldest first; these are newer than anything already spilled
+	TArray<FRun> StagedRuns;
+	int32 NumStagedSnapshots = 0;
+
+	// Spilled blocks, oldest first; rewinding streams them back newest first
+	TArray<UE::Tasks::TTask<FRewindSpillBlock>> SpilledBlocks;
+
+	// Block currently being read back in, and the spilled block or staged runs it is read from
+	UE::Tasks::TTask<TArray<uint8>> PendingRead;
+	UE::Tasks::TTask<FRewindSpillBlock> PendingReadBlock;
+	TArray<FRun> PendingReadRuns;
+};
@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindFractureTimeline.h"
+
+#include "Algo/StableSort.h"
+#include "GeometryCollection/GeometryCollection.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+
+FRewindFractureTimeline::FCompactRotation::FCompactRotation(const FQuat4f& Rotation)
+{
+	Components[0] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Rotation.X, -1.0f, 1.0f) * MAX_int16));
+	Components[1] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Rotation.Y, -1.0f, 1.0f) * MAX_int16));
+	Components[2] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Rotation.Z, -1.0f, 1.0f) * MAX_int16));
+	Components[3] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Rotation.W, -1.0f, 1.0f) * MAX_int16));
+}
+
+FQuat4f FRewindFractureTimeline::FCompactRotation::Get() const
+{
+	constexpr float Scale = 1.0f / MAX_int16;
+	return FQuat4f(Components[0] * Scale, Components[1] * Scale, Components[2] * Scale, Components[3] * Scale).GetNormalized();
+}
+
+void FRewindFractureTimeline::Initialize(const UGeometryCollectionComponent& Collection)
+{
+	Movement.Empty();
+	Activation.Empty();
+	Locations.Reset();
+	Rotations.Reset();
+	Active.Reset();
+	Held.Reset();
+	Parents.Reset();
+	RestTransforms.Reset();
+	HierarchyOrder.Reset();
+
+	const FGeometryDynamicCollection* DynamicCollection = Collection.GetDynamicCollection();
+	const UGeometryCollection* RestCollection = Collection.GetRestCollection();
+	if (!DynamicCollection || !RestCollection || !RestCollection->GetGeometryCollection().IsValid()) { return; }
+
+	const FGeometryCollection& RestGeometry = *RestCollection->GetGeometryCollection();
+	const TArray<FMatrix>& GlobalMatrices = Collection.GetGlobalMatrices();
+	const int32 NumPieces = DynamicCollection->Active.Num();
+	if (RestGeometry.Parent.Num() != NumPieces || GlobalMatrices.Num() != NumPieces) { return; }
+
+	Locations.SetNumUninitialized(NumPieces);
+	Rotations.SetNumUninitialized(NumPieces);
+	Active.Init(false, NumPieces);
+	Parents.SetNumUninitialized(NumPieces);
+	RestTransforms.SetNumUninitialized(NumPieces);
+	TArray<int32> Depths;
+	Depths.SetNumZeroed(NumPieces);
+	for (int32 Piece = 0; Piece < NumPieces; ++Piece)
+	{
+		const FTransform3f Transform(FMatrix44f(GlobalMatrices[Piece]));
+		Locations[Piece] = Transform.GetLocation();
+		Rotations[Piece] = FCompactRotation(Transform.GetRotation());
+		Active[Piece] = DynamicCollection->Active[Piece];
+		Parents[Piece] = RestGeometry.Parent[Piece];
+		RestTransforms[Piece] = FTransform(RestGeometry.Transform[Piece]);
+		for (int32 Ancestor = Parents[Piece]; Ancestor != INDEX_NONE; Ancestor = RestGeometry.Parent[Ancestor]) { ++Depths[Piece]; }
+	}
+
+	HierarchyOrder.SetNumUninitialized(NumPieces);
+	for (int32 Piece = 0; Piece < NumPieces; ++Piece) { HierarchyOrder[Piece] = Piece; }
+	Algo::StableSortBy(HierarchyOrder, [&Depths](int32 Piece) { return Depths[Piece]; });
+
+	Held.Init(false, NumPieces);
+	UpdateHeld();
+}
+
+bool FRewindFractureTimeline::IsCompatible(const UGeometryCollectionComponent& Collection) const
+{
+	const FGeometryDynamicCollection* DynamicCollection = Collection.GetDynamicCollection();
+	return Locations.Num() > 0 && DynamicCollection && DynamicCollection->Active.Num() == Locations.Num()
+		&& Collection.GetGlobalMatrices().Num() == Locations.Num();
+}
+
+void FRewindFractureTimeline::Record(const UGeometryCollectionComponent& Collection)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindFractureTimeline::Record);
+
+	check(IsCompatible(Collection));
+
+	const FGeometryDynamicCollection& DynamicCollection = *Collection.GetDynamicCollection();
+	const TArray<FMatrix>& GlobalMatrices = Collection.GetGlobalMatrices();
+
+	Movement.AddFrame();
+	Activation.AddFrame();
+	bool bActivationChanged = false;
+	for (int32 Piece = 0; Piece < Locations.Num(); ++Piece)
+	{
+		const bool bIsActive = DynamicCollection.Active[Piece];
+		if (bIsActive != Active[Piece])
+		{
+			Activation.AddChange(Piece, !bIsActive, bIsActive);
+			Active[Piece] = bIsActive;
+			bActivationChanged = true;
+		}
+	}
+	if (bActivationChanged) { UpdateHeld(); }
+
+	for (int32 Piece = 0; Piece < Locations.Num(); ++Piece)
+	{
+		// Pieces held by an active cluster move with it, and sleeping or static pieces can't have moved; when anything broke
+		// every piece that isn't held is read, since pieces that were just let go haven't been read while they were held
+		if (Held[Piece]) { continue; }
+		const Chaos::EObjectStateType State = static_cast<Chaos::EObjectStateType>(DynamicCollection.DynamicState[Piece]);
+		const bool bSettled = State == Chaos::EObjectStateType::Sleeping || State == Chaos::EObjectStateType::Static;
+		if (Active[Piece] && bSettled && !bActivationChanged) { continue; }
+
+		const FTransform3f Transform(FMatrix44f(GlobalMatrices[Piece]));
+		const FPieceState PieceState = {Transform.GetLocation(), FCompactRotation(Transform.GetRotation())};
+		const bool bMoved = !PieceState.Location.Equals(Locations[Piece], RewindChangeLog::LocationTolerance);
+		const bool bRotated = !PieceState.Rotation.Get().Equals(Rotations[Piece].Get(), RewindChangeLog::RotationTolerance);
+		if (!bMoved && !bRotated) { continue; }
+
+		Movement.AddChange(Piece, {Locations[Piece], Rotations[Piece]}, PieceState);
+		Locations[Piece] = PieceState.Location;
+		Rotations[Piece] = PieceState.Rotation;
+	}
+}
+
+void FRewindFractureTimeline::PopFront()
+{
+	Movement.PopFront();
+	Activation.PopFront();
+}
+
+void FRewindFractureTimeline::Truncate(int32 Count)
+{
+	// The current state must stay on a frame that still exists
+	if (Movement.GetCurrentIndex() >= Count && Count > 0) { Seek(Count - 1); }
+
+	Movement.Truncate(Count, [](int32, const FPieceState&) {});
+	Activation.Truncate(Count, [](int32, bool) {});
+}
+
+void FRewindFractureTimeline::Empty()
+{
+	Movement.Empty();
+	Activation.Empty();
+}
+
+void FRewindFractureTimeline::Seek(int32 Index)
+{
+	Movement.Seek(
+		Index,
+		[this](int32 Piece, const FPieceState& PieceState)
+		{
+			Locations[Piece] = PieceState.Location;
+			Rotations[Piece] = PieceState.Rotation;
+		});
+
+	bool bActivationChanged = false;
+	Activation.Seek(
+		Index,
+		[this, &bActivationChanged](int32 Piece, bool bIsActive)
+		{
+			Active[Piece] = bIsActive;
+			bActivationChanged = true;
+		});
+	if (bActivationChanged) { UpdateHeld(); }
+}
+
+void FRewindFractureTimeline::UpdateHeld()
+{
+	// Parents come first, so each piece sees whether its parent is held; pieces of a broken cluster that weren't released
+	// are regrouped by Chaos into internal clusters and move on their own even though they aren't active
+	for (const int32 Piece : HierarchyOrder)
+	{
+		const int32 Parent = Parents[Piece];
+		Held[Piece] = !Active[Piece] && Parent != INDEX_NONE && (Active[Parent] || Held[Parent]);
+	}
+}
+
+void FRewindFractureTimeline::Apply(int32 IndexA, int32 IndexB, float Alpha, UGeometryCollectionComponent& Collection)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindFractureTimeline::Apply);
+
+	if (!IsCompatible(Collection) || Num() == 0) { return; }
+
+	// Settle on the older frame; pieces that moved on the way to the newer one are blended on top of it
+	const int32 OlderIndex = FMath::Min(IndexA, IndexB);
+	const int32 NewerIndex = FMath::Max(IndexA, IndexB);
+	check(NewerIndex - OlderIndex <= 1);
+	Seek(OlderIndex);
+
+	const int32 NumPieces = Locations.Num();
+	ComponentSpaceTransforms.SetNumUninitialized(NumPieces, false);
+	for (int32 Piece = 0; Piece < NumPieces; ++Piece)
+	{
+		ComponentSpaceTransforms[Piece] = FTransform(FQuat(Rotations[Piece].Get()), FVector(Locations[Piece]));
+	}
+	if (NewerIndex != OlderIndex)
+	{
+		const float NewerAlpha = IndexB == NewerIndex ? Alpha : 1.0f - Alpha;
+		Movement.ForEachChange(
+			NewerIndex,
+			[this, NewerAlpha](int32 Piece, const FPieceState& From, const FPieceState& To)
+			{
+				const FQuat4f Rotation = FQuat4f::FastLerp(From.Rotation.Get(), To.Rotation.Get(), NewerAlpha).GetNormalized();
+				const FVector3f Location = FMath::Lerp(From.Location, To.Location, NewerAlpha);
+				ComponentSpaceTransforms[Piece] = FTransform(FQuat(Rotation), FVector(Location));
+			});
+	}
+
+	// The rest state is relative to each piece's parent in the unbroken hierarchy: free pieces are expressed relative to
+	// wherever their parent is, and pieces held by an active cluster keep their original offset from it
+	PlaybackRestTransforms.SetNumUninitialized(NumPieces, false);
+	for (const int32 Piece : HierarchyOrder)
+	{
+		const int32 Parent = Parents[Piece];
+		if (Parent == INDEX_NONE) { PlaybackRestTransforms[Piece] = ComponentSpaceTransforms[Piece]; }
+		else if (!Held[Piece])
+		{
+			PlaybackRestTransforms[Piece] = ComponentSpaceTransforms[Piece].GetRelativeTransform(ComponentSpaceTransforms[Parent]);
+		}
+		else
+		{
+			PlaybackRestTransforms[Piece] = RestTransforms[Piece];
+			ComponentSpaceTransforms[Piece] = RestTransforms[Piece] * ComponentSpaceTransforms[Parent];
+		}
+	}
+
+	// The collection copies the rest state it's given, so the scratch buffer keeps its allocation for the next frame
+	Collection.SetRestState(MoveTemp(PlaybackRestTransforms));
+}
+
+void FRewindFractureTimeline::ReapplyBreaks(UGeometryCollectionComponent& Collection) const
+{
+	if (!IsCompatible(Collection) || Movement.GetCurrentIndex() == INDEX_NONE) { return; }
+
+	// Crumbling a cluster would release every child, so only the pieces that are active, or hold active pieces, are
+	// released; children are visited first so each piece sees whether anything below it was released
+	TBitArray<> Released(false, Locations.Num());
+	for (int32 OrderIndex = HierarchyOrder.Num() - 1; OrderIndex >= 0; --OrderIndex)
+	{
+		const int32 Piece = HierarchyOrder[OrderIndex];
+		Released[Piece] = Released[Piece] || Active[Piece];
+		if (Released[Piece] && Parents[Piece] != INDEX_NONE) { Released[Parents[Piece]] = true; }
+	}
+
+	// Parents come first, so outer clusters are released before the clusters inside them; the children left behind are
+	// regrouped by the solver as they were when recorded
+	const FTransform& ComponentTransform = Collection.GetComponentTransform();
+	for (const int32 Piece : HierarchyOrder)
+	{
+		if (!Released[Piece] || Parents[Piece] == INDEX_NONE) { continue; }
+
+		Collection.ApplyExternalStrain(
+			FGeometryCollectionItemIndex::CreateTransformItemIndex(Piece).GetItemIndex(),
+			ComponentTransform.TransformPosition(FVector(Locations[Piece])),
+			0.0f /*Radius*/,
+			0 /*PropagationDepth*/,
+			1.0f /*PropagationFactor*/,
+			TNumericLimits<float>::Max() /*Strain*/);
+	}
+}
+
+SIZE_T FRewindFractureTimeline::GetAllocatedSize() const
+{
+	return Movement.GetAllocatedSize() + Activation.GetAllocatedSize() + Locations.GetAllocatedSize() + Rotations.GetAllocatedSize()
+		+ Active.GetAllocatedSize() + Held.GetAllocatedSize() + Parents.GetAllocatedSize() + RestTransforms.GetAllocatedSize()
+		+ HierarchyOrder.GetAllocatedSize() + ComponentSpaceTransforms.GetAllocatedSize() + PlaybackRestTransforms.GetAllocatedSize();
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RewindChangeLog.h"
+
+class UGeometryCollectionComponent;
+
+/**
+ * Timeline of the pieces of a fractured geometry collection.
+ *
+ * Like FRewindInstanceTimeline, frames store only what changed since the previous frame in change logs, so playback can
+ * step in either direction. Pieces held by an active cluster follow their parent and sleeping pieces can't move, so a
+ * settled pile of debris costs nothing to record; every other piece is read, including the members of internal clusters
+ * Chaos forms from the leftovers of a break, which no longer follow their rest parent. Breaks are stored as changes too,
+ * which lets playback reassemble clusters in place by restoring the collection's rest state. Locations are stored at
+ * single precision in component space and rotations are quantized to 16 bits per component.
+ */
+class REWIND_API FRewindFractureTimeline
+{
+public:
+	// Reads every piece of Collection as the starting state and discards any history
+	void Initialize(const UGeometryCollectionComponent& Collection);
+
+	// Returns whether frames recorded so far can be applied to Collection's pieces
+	bool IsCompatible(const UGeometryCollectionComponent& Collection) const;
+
+	int32 Num() const { return Movement.Num(); }
+
+	// Returns whether the collection at any frame after Index differs from the collection at Index
+	bool HasChangesAfter(int32 Index) const
+	{
+		return FMath::Max(Movement.GetNewestChangedIndex(), Activation.GetNewestChangedIndex()) > Index;
+	}
+
+	// Appends a frame holding the pieces of Collection that broke off or moved since the newest frame; must be at the
+	// newest frame
+	void Record(const UGeometryCollectionComponent& Collection);
+
+	// Removes the oldest frame
+	void PopFront();
+
+	// Keeps the oldest Count frames
+	void Truncate(int32 Count);
+
+	// Removes all frames, keeping the current state as the starting point for new ones
+	void Empty();
+
+	// Poses the pieces of Collection at the blend of two adjacent frames by replacing its rest state; physics must not be
+	// running on Collection
+	void Apply(int32 IndexA, int32 IndexB, float Alpha, UGeometryCollectionComponent& Collection);
+
+	// Releases the pieces that were broken off at the frame last applied; call after Collection's physics state has been
+	// rebuilt from the applied rest state, which starts with every cluster whole. Pieces are released from their clusters
+	// by strain, which the solver resolves one level of the hierarchy per step, so deeply nested breaks take a few steps
+	void ReapplyBreaks(UGeometryCollectionComponent& Collection) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Rotation quantized to 16 bits per component
+	struct FCompactRotation
+	{
+		int16 Components[4] = { 0, 0, 0, 0 };
+
+		FCompactRotation() = default;
+		explicit FCompactRotation(const FQuat4f& Rotation);
+		FQuat4f Get() const;
+	};
+
+	struct FPieceState
+	{
+		FVector3f Location;
+		FCompactRotation Rotation;
+	};
+
+	// Steps the current state to a frame by undoing or redoing changes
+	void Seek(int32 Index);
+
+	// Marks the pieces held in place by an active cluster, which follow their rest parent, from the current active states
+	void UpdateHeld();
+
+	// Pieces that moved in each frame, and pieces that became active or inactive in each frame; both always hold the
+	// same frames
+	TRewindChangeLog<FPieceState> Movement;
+	TRewindChangeLog<bool> Activation;
+
+	// Component space state of every piece at the change logs' current frame; locations and rotations are only
+	// meaningful for pieces that aren't held
+	TArray<FVector3f> Locations;
+	TArray<FCompactRotation> Rotations;
+	TBitArray<> Active;
+
+	// Whether each piece is held by an active cluster at the change logs' current frame
+	TBitArray<> Held;
+
+	// Rest hierarchy of the collection, and its pieces ordered so parents come before their children
+	TArray<int32> Parents;
+	TArray<FTransform> RestTransforms;
+	TArray<int32> HierarchyOrder;
+
+	// Scratch space for building component space transforms and rest states during playback
+	TArray<FTransform> ComponentSpaceTransforms;
+	TArray<FTransform> PlaybackRestTransforms;
+};
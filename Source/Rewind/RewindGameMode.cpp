@@ -2,14 +2,588 @@
 
 #include "RewindGameMode.h"
 
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/Paths.h"
+#include "Rewind.h"
 #include "RewindCharacter.h"
+#include "RewindComponent.h"
+#include "RewindFlightRecorder.h"
+#include "RewindPhysicsRecorder.h"
+#include "RewindTimelineFile.h"
 #include "UObject/ConstructorHelpers.h"
 
+// Branches of every rewind component in the world, captured at the same moment
+struct FRewindCheckpoint
+{
+	TArray<TPair<TWeakObjectPtr<URewindComponent>, FRewindComponentBranch>> ComponentBranches;
+};
+
+// Spawn and destruction of an actor within the rewind window
+struct FRewindLifetimeRecord
+{
+	// Class to resurrect the actor as
+	TWeakObjectPtr<UClass> ActorClass;
+
+	// The actor, or the pooled actor standing in for it since it was last resurrected
+	TWeakObjectPtr<AActor> Actor;
+
+	// Timeline of the actor while it isn't alive; pages are shared with the timeline it was captured from
+	FRewindComponentBranch Timeline;
+
+	// Event track times of the actor's spawn and destruction; unset once their events are forgotten or overwritten
+	TOptional<double> SpawnTime;
+	TOptional<double> DestroyTime;
+
+	// Whether the actor was placed in a level, which sets it up beyond its class defaults; it is resurrected as a copy of
+	// itself rather than as a pooled actor of its class
+	bool bHasOwnStandIn = false;
+};
+
+// Timeline of an actor whose level was unloaded
+struct FRewindUnloadedTimeline
+{
+	// Pages are shared with the timeline the branch was captured from, so aged snapshots stay compressed
+	FRewindComponentBranch Timeline;
+
+	// Event track time of the branch's last snapshot
+	double EndTime = 0.0;
+};
+
+namespace RewindGameMode
+{
+	// Payload of actor lifetime events
+	struct FLifetimeEvent
+	{
+		int32 RecordIndex = INDEX_NONE;
+		bool bSpawned = false;
+
+		// Time of the spawn or destruction; the record's index may have been reused since its events were pruned
+		double Time = 0.0;
+	};
+} // namespace RewindGameMode
+
 ARewindGameMode::ARewindGameMode()
 {
 	// set default pawn class to our Blueprinted character
 	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter"));
 	if (PlayerPawnBPClass.Class != NULL) { DefaultPawnClass = PlayerPawnBPClass.Class; }
+
+	// Tick to evaluate the significance of rewindable actors
+	PrimaryActorTick.bCanEverTick = true;
+
+	MediumSignificance.MinDistance = 3000.0f;
+	MediumSignificance.RecordRateDivisor = 2;
+	MediumSignificance.PlaybackFrameInterval = 2;
+
+	LowSignificance.MinDistance = 10000.0f;
+	LowSignificance.RecordRateDivisor = 4;
+	LowSignificance.PlaybackFrameInterval = 4;
+}
+
+void ARewindGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UpdateEventTrack(DeltaSeconds);
+	RefillActorPools();
+	UpdateSignificance(DeltaSeconds);
+}
+
+void ARewindGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	LifetimeEventType = EventTrack.RegisterEventType(TEXT("ActorLifetime"), &ARewindGameMode::ApplyLifetimeEvent);
+
+	// Rewind components tick after physics, so deferred snapshots are recorded after all of them
+	DeferredRecordingTickFunction.GameMode = this;
+	DeferredRecordingTickFunction.bCanEverTick = true;
+	DeferredRecordingTickFunction.TickGroup = TG_PostUpdateWork;
+	DeferredRecordingTickFunction.RegisterTickFunction(GetLevel());
+
+	// Spawn pooled actors up front, so resurrecting them while rewinding through a firefight doesn't hitch
+	if (bRecordActorLifetimes)
+	{
+		for (const TPair<TSubclassOf<AActor>, int32>& PrewarmedPool : PrewarmedActorPools)
+		{
+			FillActorPool(PrewarmedPool.Key, PrewarmedPool.Value);
+		}
+	}
+}
+
+void ARewindGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	DeferredRecordingTickFunction.UnRegisterTickFunction();
+
+	// Checkpoints and lifetime records hold snapshot pages that are no longer needed
+	Checkpoints.Empty();
+	LifetimeRecords.Empty();
+	UnloadedTimelines.Empty();
+	DeferredRecordings.Empty();
+	ActorPools.Empty();
+	ActorPoolsToRefill.Empty();
+
+	// Stop sampling on the physics thread before the physics scene goes away
+	if (PhysicsRecorder)
+	{
+		PhysicsRecorder->Shutdown();
+		PhysicsRecorder.Reset();
+	}
+
+	// Spilled history only lives as long as the session
+	if (SpillFile)
+	{
+		SpillFile->Close();
+		SpillFile.Reset();
+	}
+}
+
+void ARewindGameMode::UpdateEventTrack(float DeltaSeconds)
+{
+	// Time scrubbing without rewinding or fast forwarding holds the playhead where it is
+	if (bIsGlobalRewinding) { EventTrack.MovePlayhead(-DeltaSeconds * GlobalRewindSpeed); }
+	else if (bIsGlobalFastForwarding) { EventTrack.MovePlayhead(DeltaSeconds * GlobalRewindSpeed); }
+	else if (!bIsGlobalTimeScrubbing)
+	{
+		PruneLifetimeRecords();
+		PruneUnloadedTimelines();
+
+		// Spilled snapshots can be rewound to indefinitely, so their events are kept for as long
+		EventTrack.Advance(DeltaSeconds, bEnableFlightRecorder ? 0.0f : MaxRewindSeconds);
+	}
+}
+
+void ARewindGameMode::RecordActorSpawned(URewindComponent& Component)
+{
+	// Actors that spawned with the oldest time on the track, such as those placed in the level, can't be rewound past
+	if (!bRecordActorLifetimes || bFillingActorPools || LifetimeEventType == INDEX_NONE) { return; }
+	if (!EventTrack.IsAtPresent() || EventTrack.GetPresentTime() <= EventTrack.GetOldestTime()) { return; }
+
+	// Actors loaded with their level, including those streamed back in, weren't spawned by the game
+	AActor* Actor = Component.GetOwner();
+	if (Actor->IsNetStartupActor()) { return; }
+	TSharedPtr<FRewindLifetimeRecord> Record = MakeShared<FRewindLifetimeRecord>();
+	Record->ActorClass = Actor->GetClass();
+	Record->Actor = Actor;
+	Record->SpawnTime = EventTrack.GetPresentTime();
+	Component.LifetimeRecordIndex = LifetimeRecords.Add(MoveTemp(Record));
+
+	const RewindGameMode::FLifetimeEvent Event{ Component.LifetimeRecordIndex, true, EventTrack.GetPresentTime() };
+	EventTrack.Record(LifetimeEventType, this, Event);
+}
+
+void ARewindGameMode::RecordActorDestroyed(URewindComponent& Component)
+{
+	if (!bRecordActorLifetimes || bFillingActorPools || Component.IsPooled() || LifetimeEventType == INDEX_NONE) { return; }
+	if (!EventTrack.IsAtPresent() || EventTrack.GetPresentTime() <= EventTrack.GetOldestTime()) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::RecordActorDestroyed);
+
+	// Actors that spawned within the rewind window already have a record
+	AActor* Actor = Component.GetOwner();
+	int32 RecordIndex = Component.LifetimeRecordIndex;
+	if (!LifetimeRecords.IsValidIndex(RecordIndex))
+	{
+		RecordIndex = LifetimeRecords.Add(MakeShared<FRewindLifetimeRecord>());
+		LifetimeRecords[RecordIndex]->ActorClass = Actor->GetClass();
+	}
+
+	FRewindLifetimeRecord& Record = *LifetimeRecords[RecordIndex];
+	Record.Actor.Reset();
+	Record.Timeline = Component.CaptureBranch();
+	Record.DestroyTime = EventTrack.GetPresentTime();
+	Component.LifetimeRecordIndex = INDEX_NONE;
+
+	EventTrack.Record(LifetimeEventType, this, RewindGameMode::FLifetimeEvent{ RecordIndex, false, Record.DestroyTime.GetValue() });
+
+	// Make sure an actor is ready to stand in for this one if a rewind resurrects it; pooled actors only have their class's
+	// setup, so placed actors, and the copies standing in for them, are copied while they are still around
+	Record.bHasOwnStandIn |= Actor->IsNetStartupActor();
+	if (!Record.bHasOwnStandIn) { ActorPoolsToRefill.AddUnique(Actor->GetClass()); }
+	else if (AActor* StandIn = SpawnStandIn(*Actor))
+	{
+		Record.Actor = StandIn;
+		StandIn->FindComponentByClass<URewindComponent>()->LifetimeRecordIndex = RecordIndex;
+	}
+}
+
+void ARewindGameMode::ApplyLifetimeEvent(UObject* Target, const void* Payload, ERewindEventDirection Direction)
+{
+	ARewindGameMode* GameMode = CastChecked<ARewindGameMode>(Target);
+	const RewindGameMode::FLifetimeEvent& Event = *static_cast<const RewindGameMode::FLifetimeEvent*>(Payload);
+	if (!GameMode->LifetimeRecords.IsValidIndex(Event.RecordIndex)) { return; }
+
+	// Events outlive their records when the flight recorder keeps events past the rewind window
+	const FRewindLifetimeRecord& Record = *GameMode->LifetimeRecords[Event.RecordIndex];
+	const TOptional<double>& RecordTime = Event.bSpawned ? Record.SpawnTime : Record.DestroyTime;
+	if (!RecordTime || *RecordTime != Event.Time) { return; }
+
+	// Actors are alive after fast forwarding over their spawn or rewinding over their destruction
+	if (Event.bSpawned == (Direction == ERewindEventDirection::Forward)) { GameMode->ResurrectActor(Event.RecordIndex, Event.bSpawned); }
+	else { GameMode->BuryActor(Event.RecordIndex); }
+}
+
+void ARewindGameMode::ResurrectActor(int32 RecordIndex, bool bAtStart)
+{
+	FRewindLifetimeRecord& Record = *LifetimeRecords[RecordIndex];
+	if (!Record.Timeline.IsValid()) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::ResurrectActor);
+
+	// Prefer the actor that was buried, which stays in its pool until it is handed out to stand in for another record
+	AActor* Actor = Record.Actor.Get();
+	URewindComponent* Component = Actor ? Actor->FindComponentByClass<URewindComponent>() : nullptr;
+	if (Component && Component->IsPooled() && Component->LifetimeRecordIndex == RecordIndex)
+	{
+		if (FRewindActorPool* Pool = ActorPools.Find(Actor->GetClass())) { Pool->Actors.RemoveSingleSwap(Actor, false); }
+	}
+	else
+	{
+		// A placed actor's copy can still be destroyed by other means, leaving only a pooled actor with its class's setup
+		if (Record.bHasOwnStandIn)
+		{
+			UE_LOG(LogRewind, Warning, TEXT("Resurrecting a placed %s without its own setup"), *GetNameSafe(Record.ActorClass.Get()));
+		}
+		Actor = AcquirePooledActor(Record.ActorClass.Get());
+		Component = Actor ? Actor->FindComponentByClass<URewindComponent>() : nullptr;
+	}
+	if (!Component) { return; }
+
+	// The timeline now lives in the actor again
+	Component->LifetimeRecordIndex = RecordIndex;
+	Component->LeavePool(Record.Timeline, bAtStart);
+	Record.Actor = Actor;
+	Record.Timeline = FRewindComponentBranch();
+}
+
+void ARewindGameMode::BuryActor(int32 RecordIndex)
+{
+	FRewindLifetimeRecord& Record = *LifetimeRecords[RecordIndex];
+	AActor* Actor = Record.Actor.Get();
+	URewindComponent* Component = Actor ? Actor->FindComponentByClass<URewindComponent>() : nullptr;
+	if (!Component || Component->IsPooled() || Component->LifetimeRecordIndex != RecordIndex) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::BuryActor);
+
+	// Keep the future ahead of the playhead too, so fast forwarding can bring the actor back along it
+	Record.Timeline = Component->CaptureWholeBranch();
+	Component->EnterPool();
+	if (!Record.bHasOwnStandIn) { ActorPools.FindOrAdd(Actor->GetClass()).Actors.Add(Actor); }
+}
+
+double ARewindGameMode::GetOldestRewindableTime() const
+{
+	// The flight recorder keeps events for as long as the session, but actor timelines stored here only hold the snapshots
+	// that were in memory, so they are released once they age out of the rewind window regardless
+	return FMath::Max(EventTrack.GetOldestTime(), EventTrack.GetPlayheadTime() - MaxRewindSeconds);
+}
+
+void ARewindGameMode::PruneLifetimeRecords()
+{
+	// Called before the event track advances, which erases events after the playhead
+	const double OldestTime = GetOldestRewindableTime();
+	const double PlayheadTime = EventTrack.GetPlayheadTime();
+	auto ResetIfOffTrack = [OldestTime, PlayheadTime](TOptional<double>& Time)
+	{
+		if (Time && (*Time <= OldestTime || *Time > PlayheadTime)) { Time.Reset(); }
+	};
+
+	for (auto It = LifetimeRecords.CreateIterator(); It; ++It)
+	{
+		FRewindLifetimeRecord& Record = **It;
+		ResetIfOffTrack(Record.SpawnTime);
+		ResetIfOffTrack(Record.DestroyTime);
+		if (Record.SpawnTime || Record.DestroyTime) { continue; }
+
+		// Actors buried by rewinding past their spawn stay in their pool, as that spawn is no longer part of the timeline
+		AActor* Actor = Record.Actor.Get();
+		URewindComponent* Component = Actor ? Actor->FindComponentByClass<URewindComponent>() : nullptr;
+		if (Component && Component->LifetimeRecordIndex == It.GetIndex())
+		{
+			Component->LifetimeRecordIndex = INDEX_NONE;
+
+			// Stand-ins copied from placed actors aren't in any pool, so nothing else would hand them out
+			if (Record.bHasOwnStandIn && Component->IsPooled()) { Actor->Destroy(); }
+		}
+		It.RemoveCurrent();
+	}
+}
+
+void ARewindGameMode::FillActorPool(UClass* ActorClass, int32 Count)
+{
+	if (!ActorClass || Count <= 0) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::FillActorPool);
+
+	TGuardValue<bool> FillingActorPoolsGuard(bFillingActorPools, true);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	FRewindActorPool& Pool = ActorPools.FindOrAdd(ActorClass);
+	for (int32 NumSpawned = 0; NumSpawned < Count; ++NumSpawned)
+	{
+		AActor* Actor = GetWorld()->SpawnActor(ActorClass, &FTransform::Identity, SpawnParameters);
+		URewindComponent* Component = Actor ? Actor->FindComponentByClass<URewindComponent>() : nullptr;
+		if (!Component)
+		{
+			UE_LOG(LogRewind, Warning, TEXT("Cannot pool %s, which has no rewind component"), *ActorClass->GetName());
+			if (Actor) { Actor->Destroy(); }
+			return;
+		}
+
+		Component->EnterPool();
+		Pool.Actors.Add(Actor);
+	}
+}
+
+void ARewindGameMode::RefillActorPools()
+{
+	if (ActorPoolsToRefill.Num() == 0 || bIsGlobalRewinding || bIsGlobalFastForwarding || bIsGlobalTimeScrubbing) { return; }
+
+	// Pools are kept at their prewarmed size, or one spare actor for classes that weren't prewarmed
+	UClass* ActorClass = ActorPoolsToRefill.Last().Get();
+	const FRewindActorPool* Pool = ActorClass ? ActorPools.Find(ActorClass) : nullptr;
+	const int32 TargetSize = FMath::Max(PrewarmedActorPools.FindRef(ActorClass), 1);
+	if (!ActorClass || (Pool && Pool->Actors.Num() >= TargetSize))
+	{
+		ActorPoolsToRefill.Pop(false);
+		return;
+	}
+	FillActorPool(ActorClass, 1);
+}
+
+AActor* ARewindGameMode::AcquirePooledActor(UClass* ActorClass)
+{
+	if (!ActorClass) { return nullptr; }
+
+	// Pooled actors can still be destroyed by other means, such as their level streaming out
+	FRewindActorPool& Pool = ActorPools.FindOrAdd(ActorClass);
+	ActorPoolsToRefill.AddUnique(ActorClass);
+	while (Pool.Actors.Num() > 0)
+	{
+		AActor* Actor = Pool.Actors.Pop(false);
+		if (IsValid(Actor)) { return Actor; }
+	}
+
+	// An empty pool hitches on spawning, but the actor is still resurrected
+	FillActorPool(ActorClass, 1);
+	return Pool.Actors.Num() > 0 ? Pool.Actors.Pop(false) : nullptr;
+}
+
+AActor* ARewindGameMode::SpawnStandIn(AActor& Actor)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::SpawnStandIn);
+
+	// Spawning from the actor as a template copies its per-instance setup, such as a placed mesh actor's mesh; the actor
+	// is still valid while its components end play
+	TGuardValue<bool> FillingActorPoolsGuard(bFillingActorPools, true);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Template = &Actor;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* StandIn = GetWorld()->SpawnActor(Actor.GetClass(), &FTransform::Identity, SpawnParameters);
+	URewindComponent* Component = StandIn ? StandIn->FindComponentByClass<URewindComponent>() : nullptr;
+	if (!Component)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Cannot copy %s to stand in for it, so it can't be resurrected"), *Actor.GetName());
+		if (StandIn) { StandIn->Destroy(); }
+		return nullptr;
+	}
+
+	Component->EnterPool();
+	return StandIn;
+}
+
+void ARewindGameMode::StoreUnloadedTimeline(URewindComponent& Component)
+{
+	if (!bKeepUnloadedTimelines || Component.IsPooled()) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::StoreUnloadedTimeline);
+
+	// Capturing a branch only references pages, so unloading never waits on copying or serializing history
+	TSharedPtr<FRewindUnloadedTimeline> Unloaded = MakeShared<FRewindUnloadedTimeline>();
+	Unloaded->Timeline = Component.CaptureBranch();
+	if (!Unloaded->Timeline.IsValid()) { return; }
+
+	// While time is manipulated, the latest snapshot is the one at the playhead, to within a snapshot
+	const double PlayheadTime = EventTrack.GetPlayheadTime();
+	Unloaded->EndTime = Component.IsTimeBeingManipulated() ? PlayheadTime : PlayheadTime - Component.GetTimeSinceSnapshotsChanged();
+	EarliestUnloadedEndTime = FMath::Min(EarliestUnloadedEndTime, Unloaded->EndTime);
+	LatestUnloadedEndTime = FMath::Max(LatestUnloadedEndTime, Unloaded->EndTime);
+	UnloadedTimelines.Add(Component.GetOwner()->GetPathName(), MoveTemp(Unloaded));
+}
+
+void ARewindGameMode::RestoreUnloadedTimeline(URewindComponent& Component)
+{
+	if (UnloadedTimelines.Num() == 0) { return; }
+
+	TSharedPtr<FRewindUnloadedTimeline> Unloaded;
+	if (!UnloadedTimelines.RemoveAndCopyValue(Component.GetOwner()->GetPathName(), Unloaded)) { return; }
+
+	Component.RestoreUnloadedBranch(Unloaded->Timeline, EventTrack.GetPlayheadTime() - Unloaded->EndTime);
+}
+
+void ARewindGameMode::PruneUnloadedTimelines()
+{
+	// Only walk the map once the oldest timeline in it has aged out, or time resumed before the newest one ended
+	const double OldestTime = GetOldestRewindableTime();
+	const double PlayheadTime = EventTrack.GetPlayheadTime();
+	if (UnloadedTimelines.Num() == 0 || (OldestTime < EarliestUnloadedEndTime && PlayheadTime >= LatestUnloadedEndTime)) { return; }
+
+	// Called before the event track advances, which erases events after the playhead; timelines stored while rewound end
+	// in that erased future, so they would be held across time that never happened and are released too
+	EarliestUnloadedEndTime = TNumericLimits<double>::Max();
+	LatestUnloadedEndTime = TNumericLimits<double>::Lowest();
+	for (auto It = UnloadedTimelines.CreateIterator(); It; ++It)
+	{
+		const double EndTime = It.Value()->EndTime;
+		if (EndTime <= OldestTime || EndTime > PlayheadTime) { It.RemoveCurrent(); }
+		else
+		{
+			EarliestUnloadedEndTime = FMath::Min(EarliestUnloadedEndTime, EndTime);
+			LatestUnloadedEndTime = FMath::Max(LatestUnloadedEndTime, EndTime);
+		}
+	}
+}
+
+void ARewindGameMode::UpdateSignificance(float DeltaSeconds)
+{
+	if (!bEnableSignificance || RewindComponents.Num() == 0) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::UpdateSignificance);
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController || !PlayerController->PlayerCameraManager) { return; }
+	const FVector ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+
+	// Visit a slice of the registry each frame so every component is evaluated once per SignificanceUpdateSeconds
+	const float UpdateFraction = SignificanceUpdateSeconds > 0.0f ? DeltaSeconds / SignificanceUpdateSeconds : 1.0f;
+	const int32 NumToUpdate = FMath::Clamp(FMath::CeilToInt32(RewindComponents.Num() * UpdateFraction), 1, RewindComponents.Num());
+	for (int32 Count = 0; Count < NumToUpdate; ++Count)
+	{
+		if (SignificanceCursor >= RewindComponents.Num()) { SignificanceCursor = 0; }
+		URewindComponent* Component = RewindComponents[SignificanceCursor++];
+
+		const ERewindSignificance Significance = EvaluateSignificance(*Component, ViewLocation);
+		if (Significance == ERewindSignificance::Low) { Component->SetSignificance(Significance, LowSignificance); }
+		else if (Significance == ERewindSignificance::Medium) { Component->SetSignificance(Significance, MediumSignificance); }
+		else { Component->SetSignificance(Significance, FRewindSignificanceTierSettings()); }
+	}
+}
+
+ERewindSignificance ARewindGameMode::EvaluateSignificance(const URewindComponent& Component, const FVector& ViewLocation) const
+{
+	const AActor* Owner = Component.GetOwner();
+	for (const FName& Tag : HighSignificanceActorTags)
+	{
+		if (Owner->ActorHasTag(Tag)) { return ERewindSignificance::High; }
+	}
+
+	// Tier by distance, then drop a tier for actors that haven't been rendered recently
+	const double DistanceSquared = FVector::DistSquared(Owner->GetActorLocation(), ViewLocation);
+	int32 Tier = 0;
+	if (DistanceSquared >= FMath::Square(LowSignificance.MinDistance)) { Tier = 2; }
+	else if (DistanceSquared >= FMath::Square(MediumSignificance.MinDistance)) { Tier = 1; }
+
+	constexpr float RecentlyRenderedSeconds = 0.2f;
+	if (!Owner->WasRecentlyRendered(RecentlyRenderedSeconds)) { Tier = FMath::Min(Tier + 1, 2); }
+	return static_cast<ERewindSignificance>(Tier);
+}
+
+bool ARewindGameMode::HasRecordingBudget()
+{
+	if (RecordingBudgetMs <= 0.0f) { return true; }
+
+	UpdateRecordingBudgetFrame();
+	return RecordingSecondsThisFrame * 1000.0 < RecordingBudgetMs;
+}
+
+void ARewindGameMode::ChargeRecordingTime(double Seconds)
+{
+	UpdateRecordingBudgetFrame();
+	RecordingSecondsThisFrame += Seconds;
+}
+
+void ARewindGameMode::UpdateRecordingBudgetFrame()
+{
+	// The budget resets lazily on the first use of each frame; deferred snapshots flushed at the end of the previous frame
+	// have already started on it
+	if (RecordingBudgetFrame >= GFrameCounter) { return; }
+	RecordingBudgetFrame = GFrameCounter;
+	RecordingSecondsThisFrame = 0.0;
+}
+
+void FRewindDeferredRecordingTickFunction::ExecuteTick(
+	float DeltaTime,
+	ELevelTick TickType,
+	ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (GameMode) { GameMode->FlushDeferredRecordings(); }
+}
+
+void ARewindGameMode::FlushDeferredRecordings()
+{
+	if (DeferredRecordings.Num() == 0) { return; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::FlushDeferredRecordings);
+
+	// Every component has added this frame's time, so deferred snapshots store it regardless of tick order. They are
+	// charged to the next frame's budget before components that tick then can spend it; each charges what it spends, and
+	// any left over stay at the front of the queue
+	RecordingBudgetFrame = GFrameCounter + 1;
+	RecordingSecondsThisFrame = 0.0;
+	int32 NumRecorded = 0;
+	while (NumRecorded < DeferredRecordings.Num() && RecordingSecondsThisFrame * 1000.0 < RecordingBudgetMs)
+	{
+		if (URewindComponent* Component = DeferredRecordings[NumRecorded].Get()) { Component->RecordDeferredSnapshot(); }
+		++NumRecorded;
+	}
+	DeferredRecordings.RemoveAt(0, NumRecorded, false /*bAllowShrinking*/);
+}
+
+void ARewindGameMode::RegisterRewindComponent(URewindComponent* Component)
+{
+	check(Component && Component->RegistryIndex == INDEX_NONE);
+	Component->RegistryIndex = RewindComponents.Add(Component);
+}
+
+void ARewindGameMode::UnregisterRewindComponent(URewindComponent* Component)
+{
+	check(Component);
+	if (Component->RegistryIndex == INDEX_NONE) { return; }
+
+	// Swap the last component into the vacated slot so removal stays constant time
+	const int32 Index = Component->RegistryIndex;
+	check(RewindComponents[Index] == Component);
+	RewindComponents.RemoveAtSwap(Index, 1, false /*bAllowShrinking*/);
+	if (Index < RewindComponents.Num()) { RewindComponents[Index]->RegistryIndex = Index; }
+	Component->RegistryIndex = INDEX_NONE;
+}
+
+TSharedPtr<FRewindPhysicsRecorder> ARewindGameMode::GetOrCreatePhysicsRecorder()
+{
+	// Only try once, so components don't each retry (and warn) when physics isn't available
+	if (!PhysicsRecorder && !bTriedCreatingPhysicsRecorder)
+	{
+		bTriedCreatingPhysicsRecorder = true;
+		PhysicsRecorder = MakeShared<FRewindPhysicsRecorder>();
+		if (!PhysicsRecorder->Initialize(GetWorld())) { PhysicsRecorder.Reset(); }
+	}
+	return PhysicsRecorder;
+}
+
+TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> ARewindGameMode::GetOrCreateSpillFile()
+{
+	if (!SpillFile)
+	{
+		SpillFile = MakeShared<FRewindSpillFile, ESPMode::ThreadSafe>();
+		FString FileName = FPaths::ProjectSavedDir() / TEXT("Rewind") / FString::Printf(TEXT("FlightRecorder_%s.spill"), *GetWorld()->GetName());
+		if (!SpillFile->Open(FileName)) { SpillFile.Reset(); }
+	}
+	return SpillFile;
 }
 
 void ARewindGameMode::StartGlobalRewind()
@@ -17,6 +591,7 @@ void ARewindGameMode::StartGlobalRewind()
 	TRACE_BOOKMARK(TEXT("ARewindGameMode::StartGlobalRewind"));
 
 	bIsGlobalRewinding = true;
+	ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalRewindStarted(); });
 	OnGlobalRewindStarted.Broadcast();
 }
 
@@ -25,6 +600,7 @@ void ARewindGameMode::StopGlobalRewind()
 	TRACE_BOOKMARK(TEXT("ARewindGameMode::StopGlobalRewind"));
 
 	bIsGlobalRewinding = false;
+	ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalRewindCompleted(); });
 	OnGlobalRewindCompleted.Broadcast();
 }
 
@@ -33,6 +609,7 @@ void ARewindGameMode::StartGlobalFastForward()
 	TRACE_BOOKMARK(TEXT("ARewindGameMode::StartGlobalFastForward"));
 
 	bIsGlobalFastForwarding = true;
+	ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalFastForwardStarted(); });
 	OnGlobalFastForwardStarted.Broadcast();
 }
 
@@ -41,6 +618,7 @@ void ARewindGameMode::StopGlobalFastForward()
 	TRACE_BOOKMARK(TEXT("ARewindGameMode::StopGlobalFastForward"));
 
 	bIsGlobalFastForwarding = false;
+	ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalFastForwardCompleted(); });
 	OnGlobalFastForwardCompleted.Broadcast();
 }
 
@@ -75,11 +653,13 @@ void ARewindGameMode::ToggleTimeScrub()
 	if (bIsGlobalTimeScrubbing)
 	{
 		TRACE_BOOKMARK(TEXT("ARewindGameMode::ToggleTimeScrub - Start Time Scrubbing"));
+		ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalTimeScrubStarted(); });
 		OnGlobalTimeScrubStarted.Broadcast();
 	}
 	else
 	{
 		TRACE_BOOKMARK(TEXT("ARewindGameMode::ToggleTimeScrub - Stop Time Scrubbing"));
+		ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalTimeScrubCompleted(); });
 		OnGlobalTimeScrubCompleted.Broadcast();
 	}
 }
@@ -90,11 +670,116 @@ void ARewindGameMode::ToggleGlobalTimelineVisualization()
 	if (bIsGlobalTimelineVisualizationEnabled)
 	{
 		TRACE_BOOKMARK(TEXT("ARewindGameMode::ToggleGlobalTimelineVisualization - Enable Timeline Visualization"));
+		ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalTimelineVisualizationEnabled(); });
 		OnGlobalTimelineVisualizationEnabled.Broadcast();
 	}
 	else
 	{
 		TRACE_BOOKMARK(TEXT("ARewindGameMode::ToggleGlobalTimelineVisualization - Disable Timeline Visualization"));
+		ForEachRewindComponent([](URewindComponent* Component) { Component->OnGlobalTimelineVisualizationDisabled(); });
 		OnGlobalTimelineVisualizationDisabled.Broadcast();
 	}
-}
\ No newline at end of file
+}
+
+bool ARewindGameMode::SaveGlobalTimelines(const FString& FileName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::SaveGlobalTimelines);
+
+	// Snapshot times are only well defined while recording
+	if (bIsGlobalRewinding || bIsGlobalFastForwarding || bIsGlobalTimeScrubbing)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Cannot save rewind timelines while time is being manipulated"));
+		return false;
+	}
+
+	TSharedRef<FRewindTimelineFileWriter, ESPMode::ThreadSafe> Writer = MakeShared<FRewindTimelineFileWriter, ESPMode::ThreadSafe>();
+	if (!Writer->Open(FPaths::ProjectSavedDir() / TEXT("Rewind") / FileName)) { return false; }
+
+	// Gather samples from every rewind component in this world, timestamped relative to the oldest possible snapshot
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const double StartTime = FMath::Max(0.0, CurrentTime - MaxRewindSeconds);
+	TArray<FRewindTimelineFileSample> Samples;
+	for (URewindComponent* Component : RewindComponents)
+	{
+		if (Component->IsPooled()) { continue; }
+
+		uint32 TimelineIndex = Writer->AddTimeline(Component->GetOwner()->GetPathName());
+		RewindTimelineFile::AppendComponentSamples(*Component, TimelineIndex, CurrentTime, StartTime, Samples);
+	}
+
+	// Bucket samples into fixed length chunks, which is linear rather than sorting every sample
+	const float ChunkSeconds = FMath::Max(TimelineFileChunkSeconds, KINDA_SMALL_NUMBER);
+	const int32 NumChunks = FMath::Max(1, FMath::CeilToInt32((CurrentTime - StartTime) / ChunkSeconds) + 1);
+	TArray<TArray<FRewindTimelineFileSample>> Chunks;
+	Chunks.SetNum(NumChunks);
+	for (const FRewindTimelineFileSample& Sample : Samples)
+	{
+		int32 ChunkIndex = FMath::Clamp(FMath::FloorToInt32(Sample.Time / ChunkSeconds), 0, NumChunks - 1);
+		Chunks[ChunkIndex].Add(Sample);
+	}
+
+	// Chunks are small, so sorting within each one is cheap; the writer hands full buffers to a worker thread
+	for (TArray<FRewindTimelineFileSample>& Chunk : Chunks)
+	{
+		Chunk.Sort([](const FRewindTimelineFileSample& A, const FRewindTimelineFileSample& B) { return A.Time < B.Time; });
+		Writer->WriteChunk(Chunk);
+	}
+
+	// The writer keeps itself alive until the final write completes
+	Writer->CloseAsync();
+	return true;
+}
+
+void ARewindGameMode::SaveCheckpoint(FName Name)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::SaveCheckpoint);
+
+	TSharedPtr<FRewindCheckpoint> Checkpoint = MakeShared<FRewindCheckpoint>();
+	Checkpoint->ComponentBranches.Reserve(RewindComponents.Num());
+	for (URewindComponent* Component : RewindComponents)
+	{
+		// Pooled actors aren't part of the world; their history belongs to lifetime records
+		if (Component->IsPooled()) { continue; }
+
+		// Without a fresh snapshot, restoring would put the actor back where it was up to a snapshot interval earlier
+		Component->RecordSnapshotNow();
+		Checkpoint->ComponentBranches.Emplace(Component, Component->CaptureBranch());
+	}
+	Checkpoints.Add(Name, Checkpoint);
+}
+
+bool ARewindGameMode::RestoreCheckpoint(FName Name)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::RestoreCheckpoint);
+
+	// Restoring replaces the present, which is only well defined while time is flowing normally
+	if (bIsGlobalRewinding || bIsGlobalFastForwarding || bIsGlobalTimeScrubbing)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Cannot restore rewind checkpoint %s while time is being manipulated"), *Name.ToString());
+		return false;
+	}
+
+	const TSharedPtr<FRewindCheckpoint>* Checkpoint = Checkpoints.Find(Name);
+	if (!Checkpoint) { return false; }
+
+	// Branches stay valid after restoring, so the same checkpoint can be restored any number of times
+	for (const TPair<TWeakObjectPtr<URewindComponent>, FRewindComponentBranch>& ComponentBranch : (*Checkpoint)->ComponentBranches)
+	{
+		if (URewindComponent* Component = ComponentBranch.Key.Get()) { Component->RestoreBranch(ComponentBranch.Value); }
+	}
+	return true;
+}
+
+void ARewindGameMode::DeleteCheckpoint(FName Name)
+{
+	Checkpoints.Remove(Name);
+}
+
+void ARewindGameMode::SwitchToAbandonedFutures()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ARewindGameMode::SwitchToAbandonedFutures);
+
+	if (bIsGlobalRewinding || bIsGlobalFastForwarding || bIsGlobalTimeScrubbing) { return; }
+
+	ForEachRewindComponent([](URewindComponent* Component) { Component->SwitchToAbandonedFuture(); });
+}
@@ -5,6 +5,9 @@
 #include "CoreMinimal.h"
 
 #include "GameFramework/GameModeBase.h"
+#include "RewindEventTrack.h"
+#include "RewindSignificance.h"
+#include "Templates/SharedPointer.h"
 
 #include "RewindGameMode.generated.h"
 
@@ -20,6 +23,49 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGlobalTimeScrubCompleted);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGlobalTimelineVisualizationEnabled);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGlobalTimelineVisualizationDisabled);
 
+class ARewindGameMode;
+class FRewindPhysicsRecorder;
+class FRewindSpillFile;
+class URewindComponent;
+struct FRewindCheckpoint;
+struct FRewindLifetimeRecord;
+struct FRewindUnloadedTimeline;
+
+// Records snapshots deferred by the recording budget once every rewind component has ticked
+USTRUCT()
+struct FRewindDeferredRecordingTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	ARewindGameMode* GameMode = nullptr;
+
+	virtual void ExecuteTick(
+		float DeltaTime,
+		ELevelTick TickType,
+		ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override { return TEXT("FRewindDeferredRecordingTickFunction"); }
+};
+
+template <>
+struct TStructOpsTypeTraits<FRewindDeferredRecordingTickFunction> : public TStructOpsTypeTraitsBase2<FRewindDeferredRecordingTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+// Deactivated actors of one class, standing by to be resurrected by a rewind
+USTRUCT()
+struct FRewindActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AActor*> Actors;
+};
+
 UCLASS(minimalapi)
 class ARewindGameMode : public AGameModeBase
 {
@@ -87,6 +133,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rewind")
 	void ToggleGlobalTimelineVisualization();
 
+	// Adds a component to the registry; the global functions above update registered components directly and then fire
+	// the events below once, so Blueprints observe global state changes without a per-component dynamic broadcast
+	void RegisterRewindComponent(URewindComponent* Component);
+
+	// Removes a component from the registry; called from EndPlay
+	void UnregisterRewindComponent(URewindComponent* Component);
+
+	// Returns every rewind component that has begun play in this world
+	const TArray<URewindComponent*>& GetRewindComponents() const { return RewindComponents; }
+
 	// Event for when global rewinds start
 	UPROPERTY(BlueprintAssignable, Category = "Rewind")
 	FOnGlobalRewindStarted OnGlobalRewindStarted;
@@ -123,6 +179,148 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Rewind")
 	float MaxRewindSeconds = 120.0f;
 
+	// Spills snapshots older than MaxRewindSeconds to disk instead of dropping them, so rewinds can go past the in-memory window
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Flight Recorder")
+	bool bEnableFlightRecorder = false;
+
+	// Number of snapshots compressed together into each spilled block
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Flight Recorder", meta = (ClampMin = "1"))
+	int32 FlightRecorderBlockSnapshots = 256;
+
+	// Compresses snapshots older than RawSnapshotWindowSeconds on worker threads to reduce resident memory
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Compression")
+	bool bCompressAgedSnapshots = true;
+
+	// Most recent history (and history around the playhead while manipulating time) that is kept uncompressed
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Compression", meta = (ClampMin = "0.0"))
+	float RawSnapshotWindowSeconds = 5.0f;
+
+	// Keeps the future that a rewind overwrites as a branch, so it can be switched back to without re-recording it; off by
+	// default, as the branch holds on to pages the timeline would otherwise free
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Branching")
+	bool bKeepAbandonedFuture = false;
+
+	// Captures the timeline of every rewind component under Name, recording a snapshot of each first so the checkpoint
+	// holds the present; pages are shared rather than copied
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Branching")
+	void SaveCheckpoint(FName Name);
+
+	// Restores every actor captured by the checkpoint to its state when the checkpoint was saved; actors spawned since are
+	// untouched, and actors destroyed since aren't brought back, as lifetime records only resurrect them by rewinding.
+	// Checkpoints hold transforms, movement and attachments; recorded poses, bodies, instances, pieces and properties
+	// aren't part of them, so restored actors keep their current state for those and their history starts over
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Branching")
+	bool RestoreCheckpoint(FName Name);
+
+	// Releases a checkpoint and any history only it was keeping alive
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Branching")
+	void DeleteCheckpoint(FName Name);
+
+	// Returns whether a checkpoint has been saved under Name
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Branching")
+	bool HasCheckpoint(FName Name) const { return Checkpoints.Contains(Name); }
+
+	// Swaps every rewind component's timeline with the future abandoned by the last rewind
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Branching")
+	void SwitchToAbandonedFutures();
+
+	// Records rewindable actors spawned or destroyed within the rewind window, so rewinding past their destruction brings
+	// them back and rewinding past their spawn removes them
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Lifetime")
+	bool bRecordActorLifetimes = true;
+
+	// Deactivated actors spawned per class when play begins, so rewinding through many destructions doesn't spawn actors
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Lifetime")
+	TMap<TSubclassOf<AActor>, int32> PrewarmedActorPools;
+
+	// Called by rewind components when their owner begins play
+	void RecordActorSpawned(URewindComponent& Component);
+
+	// Called by rewind components when their owner is destroyed; keeps the owner's timeline for resurrecting it
+	void RecordActorDestroyed(URewindComponent& Component);
+
+	// Keeps the timelines of rewindable actors whose streaming level or World Partition cell unloads, and restores them
+	// when the actors stream back in, so rewinds can cross cells that are no longer loaded
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Streaming")
+	bool bKeepUnloadedTimelines = true;
+
+	// Called by rewind components when their owner's level is unloaded
+	void StoreUnloadedTimeline(URewindComponent& Component);
+
+	// Called by rewind components when their owner begins play; restores the history it had when it was last unloaded
+	void RestoreUnloadedTimeline(URewindComponent& Component);
+
+	// Places rewindable actors into significance tiers by distance, visibility and tags, reducing the cost of those the player can't see
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Significance")
+	bool bEnableSignificance = true;
+
+	// Time taken to re-evaluate every registered component; evaluation is spread evenly across frames
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Significance", meta = (ClampMin = "0.0"))
+	float SignificanceUpdateSeconds = 0.5f;
+
+	// Actors with any of these tags always stay at high significance
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Significance")
+	TArray<FName> HighSignificanceActorTags;
+
+	// Settings for actors that are far away or out of sight
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Significance")
+	FRewindSignificanceTierSettings MediumSignificance;
+
+	// Settings for actors that are far away and out of sight
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Significance")
+	FRewindSignificanceTierSettings LowSignificance;
+
+	// Offsets the first snapshot of each component so components spawned together record on different frames
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Recording")
+	bool bStaggerRecording = true;
+
+	// Milliseconds per frame that rewind components may spend recording before due snapshots are deferred; 0 disables the budget
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Recording", meta = (ClampMin = "0.0"))
+	float RecordingBudgetMs = 1.0f;
+
+	// Frames a due snapshot can be deferred before it is recorded regardless of the budget
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Recording", meta = (ClampMin = "0"))
+	int32 MaxRecordingDeferralFrames = 4;
+
+	// Returns whether this frame's recording budget has time left
+	bool HasRecordingBudget();
+
+	// Queues a component whose due snapshot was deferred, to be recorded once every component has ticked, ahead of others
+	// from the next frame's budget
+	void DeferRecording(URewindComponent& Component) { DeferredRecordings.Add(&Component); }
+
+	// Charges time spent recording against this frame's budget
+	void ChargeRecordingTime(double Seconds);
+
+	// Returns the physics thread recorder shared by all rewind components, creating it on first use; null if unavailable
+	TSharedPtr<FRewindPhysicsRecorder> GetOrCreatePhysicsRecorder();
+
+	// Returns the spill file shared by all rewind components, creating it on first use
+	TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> GetOrCreateSpillFile();
+
+	// Time between recorded frames of rewindable Mass entities; all entities share one playhead
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Mass", meta = (ClampMin = "0.001"))
+	float MassSnapshotFrequencySeconds = 0.1f;
+
+	// Longest rewind of Mass entities; kept separate from MaxRewindSeconds as history grows with the number of entities
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Mass", meta = (ClampMin = "0.0"))
+	float MassMaxRewindSeconds = 20.0f;
+
+	// Most Mass entities that can be rewound at once; history is allocated in chunks as more entities become rewindable
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Mass", meta = (ClampMin = "1"))
+	int32 MaxRewindableMassEntities = 65536;
+
+	// Returns the world's log of one-shot events, whose playhead follows global time manipulation
+	FRewindEventTrack& GetEventTrack() { return EventTrack; }
+
+	// Length of each chunk in saved timeline files; the loader can seek to any chunk without reading the others
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind|Timeline File")
+	float TimelineFileChunkSeconds = 1.0f;
+
+	// Streams the timelines of all rewind components in the world to a file under Saved/Rewind; file I/O happens off the game thread
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Timeline File")
+	bool SaveGlobalTimelines(const FString& FileName);
+
 private:
 	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind")
 	bool bIsGlobalTimeScrubbing = false;
@@ -168,4 +366,120 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rewind")
 	float GetGlobalRewindSpeed() const { return GlobalRewindSpeed; }
 
+public:
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// File that flight recorder snapshots are spilled to; shared by all rewind components
+	TSharedPtr<FRewindSpillFile, ESPMode::ThreadSafe> SpillFile;
+
+	// Components that have begun play in this world; state changes are applied to all of them in one native pass
+	UPROPERTY(Transient)
+	TArray<URewindComponent*> RewindComponents;
+
+	// Calls Function on every registered component; safe against components unregistering during the pass
+	template <typename FunctionType>
+	void ForEachRewindComponent(FunctionType&& Function)
+	{
+		for (int32 Index = RewindComponents.Num() - 1; Index >= 0; --Index)
+		{
+			if (Index < RewindComponents.Num()) { Function(RewindComponents[Index]); }
+		}
+	}
+
+	// Frame that RecordingSecondsThisFrame was accumulated on
+	uint64 RecordingBudgetFrame = 0;
+
+	// Time spent recording snapshots on RecordingBudgetFrame
+	double RecordingSecondsThisFrame = 0.0;
+
+	// Components with deferred snapshots, longest deferred first
+	TArray<TWeakObjectPtr<URewindComponent>> DeferredRecordings;
+
+	// Resets the budget on the first use of each frame, unless deferred snapshots have already spent some of it
+	void UpdateRecordingBudgetFrame();
+
+	// Records deferred snapshots at the end of the frame, once every component has added the frame's time, charging them
+	// to the next frame's budget
+	friend struct FRewindDeferredRecordingTickFunction;
+	FRewindDeferredRecordingTickFunction DeferredRecordingTickFunction;
+	void FlushDeferredRecordings();
+
+	// Next component in the registry to have its significance evaluated
+	int32 SignificanceCursor = 0;
+
+	// Re-evaluates the significance of a slice of the registry
+	void UpdateSignificance(float DeltaSeconds);
+
+	// Returns the significance tier for a component given the current view location
+	ERewindSignificance EvaluateSignificance(const URewindComponent& Component, const FVector& ViewLocation) const;
+
+	// Samples simulating bodies on the physics thread for components that opt into it
+	TSharedPtr<FRewindPhysicsRecorder> PhysicsRecorder;
+	bool bTriedCreatingPhysicsRecorder = false;
+
+	// One-shot events of every rewindable actor in the world
+	FRewindEventTrack EventTrack;
+
+	// Moves the event track with time, or its playhead with time manipulation
+	void UpdateEventTrack(float DeltaSeconds);
+
+	// Named checkpoints saved with SaveCheckpoint
+	TMap<FName, TSharedPtr<FRewindCheckpoint>> Checkpoints;
+
+	// Timelines of actors in unloaded levels, keyed by actor path name, which is the same each time a level is loaded
+	TMap<FString, TSharedPtr<FRewindUnloadedTimeline>> UnloadedTimelines;
+	double EarliestUnloadedEndTime = TNumericLimits<double>::Max();
+	double LatestUnloadedEndTime = TNumericLimits<double>::Lowest();
+
+	// Releases unloaded timelines that are entirely older than the rewind window, or end after the playhead time resumes at
+	void PruneUnloadedTimelines();
+
+	// Lifetimes of actors spawned or destroyed within the rewind window; lifetime events refer to them by index
+	TSparseArray<TSharedPtr<FRewindLifetimeRecord>> LifetimeRecords;
+
+	// Event track type of actor spawns and destructions
+	int32 LifetimeEventType = INDEX_NONE;
+
+	// Deactivated actors by class, standing by to be resurrected
+	UPROPERTY(Transient)
+	TMap<UClass*, FRewindActorPool> ActorPools;
+
+	// Classes whose pools are topped up, one actor per frame, while time flows normally
+	TArray<TWeakObjectPtr<UClass>> ActorPoolsToRefill;
+
+	// Whether actors are being spawned into pools; their spawns aren't part of the timeline
+	bool bFillingActorPools = false;
+
+	// Undoes or redoes an actor spawn or destruction
+	static void ApplyLifetimeEvent(UObject* Target, const void* Payload, ERewindEventDirection Direction);
+
+	// Brings a recorded actor back from a pool, at the start of its timeline if bAtStart or the end otherwise
+	void ResurrectActor(int32 RecordIndex, bool bAtStart);
+
+	// Moves a recorded actor and its whole timeline into a pool
+	void BuryActor(int32 RecordIndex);
+
+	// Removes records whose events are forgotten, older than the rewind window or about to be overwritten
+	void PruneLifetimeRecords();
+
+	// Returns the event track time before which stored actor timelines are released
+	double GetOldestRewindableTime() const;
+
+	// Spawns deactivated actors into a pool
+	void FillActorPool(UClass* ActorClass, int32 Count);
+
+	// Spawns at most one actor into a pool that was drawn from
+	void RefillActorPools();
+
+	// Takes an actor out of a pool, spawning one if the pool is empty
+	AActor* AcquirePooledActor(UClass* ActorClass);
+
+	// Spawns a deactivated copy of an actor being destroyed, kept out of the pools to stand in for it alone
+	AActor* SpawnStandIn(AActor& Actor);
+
 };
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindGhostComponent.h"
+
+#include "RewindComponent.h"
+
+namespace RewindGhostComponent
+{
+	// Advances a ghost's playback time, wrapping or holding at the end of its track
+	float AdvanceTime(float Time, float DeltaTime, float Duration, bool bLoop)
+	{
+		Time += DeltaTime;
+		if (Time <= Duration) { return Time; }
+		return bLoop && Duration > 0.0f ? FMath::Fmod(Time, Duration) : Duration;
+	}
+} // namespace RewindGhostComponent
+
+URewindGhostComponent::URewindGhostComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void URewindGhostComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Ghosts are only ever seen
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetCanEverAffectNavigation(false);
+}
+
+int32 URewindGhostComponent::AddGhost(URewindComponent* Source, float StartSeconds)
+{
+	if (!Source) { return INDEX_NONE; }
+	return AddGhostTrack(FRewindGhostTrack::Bake(*Source), StartSeconds);
+}
+
+int32 URewindGhostComponent::AddGhostTrack(const TSharedRef<const FRewindGhostTrack>& Track, float StartSeconds)
+{
+	if (Track->Num() == 0) { return INDEX_NONE; }
+
+	FGhost Ghost;
+	Ghost.Track = Track;
+	Ghost.Time = FMath::Clamp(StartSeconds, 0.0f, Track->GetDuration());
+	const float Alpha = Track->Seek(Ghost.Time, Ghost.Cursor);
+
+	AddInstance(Track->SampleTransform(Ghost.Cursor, Alpha), true /*bWorldSpace*/);
+	return Ghosts.Add(MoveTemp(Ghost));
+}
+
+void URewindGhostComponent::RemoveGhost(int32 GhostIndex)
+{
+	if (!Ghosts.IsValidIndex(GhostIndex)) { return; }
+
+	Ghosts.RemoveAt(GhostIndex);
+	RemoveInstance(GhostIndex);
+}
+
+void URewindGhostComponent::ClearGhosts()
+{
+	Ghosts.Empty();
+	ClearInstances();
+}
+
+void URewindGhostComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindGhostComponent::TickComponent);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Instances removed behind the component's back leave ghosts without an instance to move
+	if (Ghosts.Num() == 0 || Ghosts.Num() != GetInstanceCount()) { return; }
+
+	GhostTransforms.SetNumUninitialized(Ghosts.Num(), false);
+	for (int32 Index = 0; Index < Ghosts.Num(); ++Index)
+	{
+		FGhost& Ghost = Ghosts[Index];
+		Ghost.Time =
+			RewindGhostComponent::AdvanceTime(Ghost.Time, DeltaTime * GhostPlaybackRate, Ghost.Track->GetDuration(), bLoopGhosts);
+		const float Alpha = Ghost.Track->Seek(Ghost.Time, Ghost.Cursor);
+		GhostTransforms[Index] = Ghost.Track->SampleTransform(Ghost.Cursor, Alpha);
+	}
+
+	// One batch for every ghost, rather than dirtying render state per instance
+	BatchUpdateInstancesTransforms(0, GhostTransforms, true /*bWorldSpace*/, true /*bMarkRenderStateDirty*/, true /*bTeleport*/);
+}
+
+URewindPoseGhostComponent::URewindPoseGhostComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void URewindPoseGhostComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Ghosts are only ever seen, and move where their track puts them regardless of what they are attached to
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetCanEverAffectNavigation(false);
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+}
+
+void URewindPoseGhostComponent::SetGhostSource(URewindComponent* Source, float StartSeconds)
+{
+	if (Source) { SetGhostTrack(FRewindGhostTrack::Bake(*Source), StartSeconds); }
+}
+
+void URewindPoseGhostComponent::SetGhostTrack(const TSharedRef<const FRewindGhostTrack>& Track, float StartSeconds)
+{
+	GhostTrack = Track;
+	GhostTime = FMath::Clamp(StartSeconds, 0.0f, Track->GetDuration());
+	GhostCursor = 0;
+
+	// Refresh the pose on the next tick
+	FramesSincePoseUpdate = PoseUpdateInterval;
+}
+
+void URewindPoseGhostComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindPoseGhostComponent::TickComponent);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!GhostTrack || GhostTrack->Num() == 0) { return; }
+
+	GhostTime = RewindGhostComponent::AdvanceTime(GhostTime, DeltaTime * GhostPlaybackRate, GhostTrack->GetDuration(), bLoopGhost);
+	const float Alpha = GhostTrack->Seek(GhostTime, GhostCursor);
+	const FTransform GhostTransform = MeshOffset * GhostTrack->SampleTransform(GhostCursor, Alpha);
+	SetWorldTransform(GhostTransform, false /*bSweep*/, nullptr, ETeleportType::TeleportPhysics);
+
+	if (++FramesSincePoseUpdate < PoseUpdateInterval || !GhostTrack->HasPoses()) { return; }
+	FramesSincePoseUpdate = 0;
+
+	// Poses recorded from a different skeleton can't be applied
+	if (GhostTrack->GetNumBones() != BoneSpaceTransforms.Num()) { return; }
+
+	GhostTrack->SamplePose(GhostCursor, Alpha, BoneSpaceTransforms);
+	MarkRefreshTransformDirty();
+}
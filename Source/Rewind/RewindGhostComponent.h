@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PoseableMeshComponent.h"
+#include "RewindGhostTrack.h"
+
+#include "RewindGhostComponent.generated.h"
+
+class URewindComponent;
+
+/**
+ * Replays recorded timelines as static mesh instances, for time trial ghosts and echoes of past runs.
+ *
+ * Each ghost is one instance of this component's mesh, with no collision, movement or tick of its own. The component
+ * ticks once for all of its ghosts, samples each one's baked track and hands every transform to the renderer in a single
+ * batch, so hundreds of ghosts cost about as much as one actor.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class REWIND_API URewindGhostComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URewindGhostComponent();
+
+	// Whether ghosts start over when they reach the end of their track; otherwise they hold their last snapshot
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost")
+	bool bLoopGhosts = true;
+
+	// Rate ghosts replay their tracks at
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost", meta = (ClampMin = "0.0"))
+	float GhostPlaybackRate = 1.0f;
+
+	// Adds a ghost replaying the timeline Source has recorded so far, StartSeconds into it; returns the ghost's index
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Ghost")
+	int32 AddGhost(URewindComponent* Source, float StartSeconds = 0.0f);
+
+	// Adds a ghost replaying a baked track, which is shared with any other ghosts replaying it
+	int32 AddGhostTrack(const TSharedRef<const FRewindGhostTrack>& Track, float StartSeconds = 0.0f);
+
+	// Removes a ghost; ghosts after it move down an index, as instances do
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Ghost")
+	void RemoveGhost(int32 GhostIndex);
+
+	// Removes every ghost
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Ghost")
+	void ClearGhosts();
+
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Ghost")
+	int32 GetNumGhosts() const { return Ghosts.Num(); }
+
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+private:
+	struct FGhost
+	{
+		TSharedPtr<const FRewindGhostTrack> Track;
+		float Time = 0.0f;
+		int32 Cursor = 0;
+	};
+
+	TArray<FGhost> Ghosts;
+
+	// Transforms handed to the renderer each frame; kept to avoid reallocating
+	TArray<FTransform> GhostTransforms;
+};
+
+/**
+ * Replays a recorded timeline and its poses on a skeletal mesh, for ghosts of characters.
+ *
+ * Poses come from the source's recorded pose timeline rather than an anim graph, and the mesh has no collision or
+ * movement. Sampling a pose costs a pass over the bones, so poses can be refreshed less often than the transform.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class REWIND_API URewindPoseGhostComponent : public UPoseableMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URewindPoseGhostComponent();
+
+	// Whether the ghost starts over when it reaches the end of its track; otherwise it holds its last snapshot
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost")
+	bool bLoopGhost = true;
+
+	// Rate the ghost replays its track at
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost", meta = (ClampMin = "0.0"))
+	float GhostPlaybackRate = 1.0f;
+
+	// Transform of the mesh relative to the recorded actor, such as a character mesh's offset from its capsule
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost")
+	FTransform MeshOffset = FTransform::Identity;
+
+	// Frames between pose refreshes; the transform is still updated every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Ghost", meta = (ClampMin = "1"))
+	int32 PoseUpdateInterval = 2;
+
+	// Replays the timeline Source has recorded so far, StartSeconds into it; Source should record poses of this mesh
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Ghost")
+	void SetGhostSource(URewindComponent* Source, float StartSeconds = 0.0f);
+
+	// Replays a baked track, which is shared with any other ghosts replaying it
+	void SetGhostTrack(const TSharedRef<const FRewindGhostTrack>& Track, float StartSeconds = 0.0f);
+
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+private:
+	TSharedPtr<const FRewindGhostTrack> GhostTrack;
+	float GhostTime = 0.0f;
+	int32 GhostCursor = 0;
+	int32 FramesSincePoseUpdate = 0;
+};
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindGhostTrack.h"
+
+#include "Algo/BinarySearch.h"
+#include "Rewind.h"
+#include "RewindComponent.h"
+
+TSharedRef<const FRewindGhostTrack> FRewindGhostTrack::Bake(const URewindComponent& Source)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindGhostTrack::Bake);
+
+	TSharedRef<FRewindGhostTrack> Track = MakeShared<FRewindGhostTrack>();
+	const TRewindTimeline<FTransformAndVelocitySnapshot>& Snapshots = Source.GetTransformAndVelocitySnapshots();
+
+	// Ghosts aren't attached to anything, and resolving relative snapshots would take the parent's history at the same
+	// times, so sources that were attached while recording are rejected, as are those with snapshots older than their
+	// attachment frames, whose space isn't known
+	const FRewindAttachmentTimeline& Attachments = Source.GetAttachmentTimeline();
+	if (Attachments.IsInitialized())
+	{
+		bool bIsWorldSpace = Attachments.Num() == Snapshots.Num();
+		for (int32 Index = 0; Index < Attachments.Num() && bIsWorldSpace; ++Index) { bIsWorldSpace = !Attachments.IsRelative(Index); }
+		if (!bIsWorldSpace)
+		{
+			UE_LOG(
+				LogRewind,
+				Warning,
+				TEXT("Cannot bake a ghost track from %s, which was recorded relative to an attach parent"),
+				*GetNameSafe(Source.GetOwner()));
+			return Track;
+		}
+	}
+
+	Track->Times.Reserve(Snapshots.Num());
+	Track->Locations.Reserve(Snapshots.Num());
+	Track->Rotations.Reserve(Snapshots.Num());
+	Track->Scales.Reserve(Snapshots.Num());
+
+	// The first snapshot's time since the one before it refers to history that isn't part of the track
+	float Time = 0.0f;
+	for (int32 Index = 0; Index < Snapshots.Num(); ++Index)
+	{
+		const FTransformAndVelocitySnapshot& Snapshot = Snapshots[Index];
+		if (Index > 0) { Time += Snapshot.TimeSinceLastSnapshot; }
+		Track->Times.Add(Time);
+		Track->Locations.Add(Snapshot.Transform.GetLocation());
+		Track->Rotations.Add(FQuat4f(Snapshot.Transform.GetRotation()));
+		Track->Scales.Add(FVector3f(Snapshot.Transform.GetScale3D()));
+	}
+
+	const FRewindPoseTimeline& Poses = Source.GetPoseTimeline();
+	if (Poses.Num() > 0)
+	{
+		Track->Poses = Poses;
+		Track->PoseOffset = Snapshots.Num() - Poses.Num();
+	}
+
+	return Track;
+}
+
+float FRewindGhostTrack::Seek(float Time, int32& Cursor) const
+{
+	check(Times.Num() > 0);
+
+	// Looping or seeking backwards jumps with a search; playing forward steps from the previous sample
+	Cursor = FMath::Clamp(Cursor, 0, Times.Num() - 1);
+	if (Time < Times[Cursor]) { Cursor = FMath::Max(Algo::UpperBound(Times, Time) - 1, 0); }
+	while (Cursor + 1 < Times.Num() && Times[Cursor + 1] <= Time) { ++Cursor; }
+
+	if (Cursor + 1 == Times.Num()) { return 0.0f; }
+	const float Span = Times[Cursor + 1] - Times[Cursor];
+	return Span > 0.0f ? FMath::Clamp((Time - Times[Cursor]) / Span, 0.0f, 1.0f) : 0.0f;
+}
+
+FTransform FRewindGhostTrack::SampleTransform(int32 Cursor, float Alpha) const
+{
+	const int32 Next = FMath::Min(Cursor + 1, Times.Num() - 1);
+	const FQuat4f Rotation = FQuat4f::FastLerp(Rotations[Cursor], Rotations[Next], Alpha).GetNormalized();
+	return FTransform(
+		FQuat(Rotation), FMath::Lerp(Locations[Cursor], Locations[Next], Alpha), FVector(FMath::Lerp(Scales[Cursor], Scales[Next], Alpha)));
+}
+
+void FRewindGhostTrack::SamplePose(int32 Cursor, float Alpha, TArray<FTransform>& OutBoneSpaceTransforms) const
+{
+	check(HasPoses());
+
+	// Snapshots older than the first pose hold it
+	const int32 Next = FMath::Min(Cursor + 1, Times.Num() - 1);
+	Poses.Sample(FMath::Max(Cursor - PoseOffset, 0), FMath::Max(Next - PoseOffset, 0), Alpha, OutBoneSpaceTransforms);
+}
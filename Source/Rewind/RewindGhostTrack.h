@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RewindPoseTimeline.h"
+
+class URewindComponent;
+
+/**
+ * Flattened copy of a recorded timeline for playback on render only ghosts.
+ *
+ * Baking reads the source timeline once, decompressing aged pages, into planar arrays with accumulated times, so
+ * sampling is a cursor step and a blend with no page lookups. Tracks are immutable once baked and shared, so any number
+ * of ghosts can replay the same run, each at its own offset.
+ */
+class REWIND_API FRewindGhostTrack
+{
+public:
+	// Bakes the whole timeline recorded by Source, along with its poses if it records them; the track is empty if any of
+	// Source's snapshots may hold transforms relative to an attach parent rather than world transforms
+	static TSharedRef<const FRewindGhostTrack> Bake(const URewindComponent& Source);
+
+	int32 Num() const { return Times.Num(); }
+
+	// Returns the time of the last snapshot relative to the first
+	float GetDuration() const { return Times.Num() > 0 ? Times.Last() : 0.0f; }
+
+	// Returns whether the source recorded poses
+	bool HasPoses() const { return Poses.Num() > 0; }
+
+	int32 GetNumBones() const { return Poses.GetNumBones(); }
+
+	// Moves Cursor to the snapshot at or before Time and returns the blend towards the next one; Cursor is a hint, so
+	// playing forward from the previous sample costs a step or two
+	float Seek(float Time, int32& Cursor) const;
+
+	// Blends the transforms of the snapshot at Cursor and the next one
+	FTransform SampleTransform(int32 Cursor, float Alpha) const;
+
+	// Blends the poses of the snapshot at Cursor and the next one into OutBoneSpaceTransforms
+	void SamplePose(int32 Cursor, float Alpha, TArray<FTransform>& OutBoneSpaceTransforms) const;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Times.GetAllocatedSize() + Locations.GetAllocatedSize() + Rotations.GetAllocatedSize() + Scales.GetAllocatedSize()
+			+ Poses.GetAllocatedSize();
+	}
+
+private:
+	// Time of each snapshot relative to the first, ascending
+	TArray<float> Times;
+
+	// Transform of each snapshot; locations stay double precision for large worlds
+	TArray<FVector> Locations;
+	TArray<FQuat4f> Rotations;
+	TArray<FVector3f> Scales;
+
+	// Poses cover the newest snapshots; the first pose belongs to snapshot PoseOffset
+	FRewindPoseTimeline Poses;
+	int32 PoseOffset = 0;
+};
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindInputRecorderComponent.h"
+
+#include "Engine/LocalPlayer.h"
+#include "EnhancedInputSubsystems.h"
+#include "EnhancedPlayerInput.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "InputAction.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Rewind.h"
+
+URewindInputRecorderComponent::URewindInputRecorderComponent()
+{
+	// Only ticks while recording or replaying
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void URewindInputRecorderComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only the locally controlled player's pawn picks up sessions from the command line
+	if (!GetPlayerController()) { return; }
+
+	FString FileName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("RewindReplayInput="), FileName))
+	{
+		bExitWhenReplayFinishes |= FParse::Param(FCommandLine::Get(), TEXT("RewindReplayExit"));
+		StartReplay(FileName);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("RewindRecordInput="), FileName)) { StartRecording(FileName); }
+}
+
+void URewindInputRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+	StopReplay();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void URewindInputRecorderComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindInputRecorderComponent::TickComponent);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (bIsRecording) { RecordFrame(); }
+	else if (bIsReplaying)
+	{
+		const double NowSeconds = FPlatformTime::Seconds();
+		if (LastFrameSeconds > 0.0) { FrameTimes.Add(NowSeconds - LastFrameSeconds); }
+		LastFrameSeconds = NowSeconds;
+
+		if (ReplayFrame < Recording.Num()) { ReplayFrameValues(); }
+		else { StopReplay(); }
+	}
+}
+
+bool URewindInputRecorderComponent::StartRecording(const FString& FileName)
+{
+	if (bIsRecording || bIsReplaying) { return false; }
+
+	APlayerController* PlayerController = GetPlayerController();
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem();
+	if (!PlayerController || !Subsystem || !Subsystem->GetPlayerInput())
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Cannot record input for %s, which isn't controlled by a local player"), *GetNameSafe(GetOwner()));
+		return false;
+	}
+
+	// Actions are added as they are first used, since a command line recording starts before mapping contexts are added
+	Recording.Empty();
+	RecordedActions.Reset();
+
+	RecordingFileName = FPaths::ProjectSavedDir() / TEXT("Rewind") / FileName;
+	bIsRecording = true;
+
+	// Read values once the controller has processed this frame's input
+	AddTickPrerequisiteActor(PlayerController);
+	SetComponentTickEnabled(true);
+	return true;
+}
+
+void URewindInputRecorderComponent::StopRecording()
+{
+	if (!bIsRecording) { return; }
+
+	bIsRecording = false;
+	SetComponentTickEnabled(false);
+	if (APlayerController* PlayerController = GetPlayerController()) { RemoveTickPrerequisiteActor(PlayerController); }
+
+	UE_LOG(LogRewind, Log, TEXT("Recorded %d frames of input to %s"), Recording.Num(), *RecordingFileName);
+	Recording.SaveAsync(RecordingFileName);
+}
+
+bool URewindInputRecorderComponent::StartReplay(const FString& FileName)
+{
+	if (bIsRecording || bIsReplaying) { return false; }
+
+	APlayerController* PlayerController = GetPlayerController();
+	if (!PlayerController || !GetInputSubsystem())
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Cannot replay input for %s, which isn't controlled by a local player"), *GetNameSafe(GetOwner()));
+		return false;
+	}
+
+	RecordingFileName = FPaths::ProjectSavedDir() / TEXT("Rewind") / FileName;
+	if (!Recording.Load(RecordingFileName) || Recording.Num() == 0) { return false; }
+
+	ReplayFrame = 0;
+	FrameTimes = FRewindFrameTimeHistogram();
+	LastFrameSeconds = 0.0;
+	bIsReplaying = true;
+
+	// Inject values before the controller processes this frame's input
+	PlayerController->AddTickPrerequisiteComponent(this);
+	SetComponentTickEnabled(true);
+
+	// Step the engine with the recorded frame lengths, so the session plays out the same regardless of how fast frames run
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	SetNextFrameDeltaSeconds();
+
+	UE_LOG(LogRewind, Log, TEXT("Replaying %d frames of input from %s"), Recording.Num(), *RecordingFileName);
+	return true;
+}
+
+void URewindInputRecorderComponent::StopReplay()
+{
+	if (!bIsReplaying) { return; }
+
+	bIsReplaying = false;
+	SetComponentTickEnabled(false);
+	if (APlayerController* PlayerController = GetPlayerController()) { PlayerController->RemoveTickPrerequisiteComponent(this); }
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	// Each run gets its own histogram, so runs on different builds can be compared side by side
+	const FString HistogramFileName = FString::Printf(
+		TEXT("%s_FrameTimes_%s.csv"), *FPaths::ChangeExtension(RecordingFileName, TEXT("")), *FDateTime::Now().ToString());
+	FrameTimes.SaveCsv(HistogramFileName);
+	UE_LOG(
+		LogRewind,
+		Log,
+		TEXT("Replayed %d of %d frames of input: average %.2f ms, p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms, histogram in %s"),
+		ReplayFrame,
+		Recording.Num(),
+		FrameTimes.GetAverageMilliseconds(),
+		FrameTimes.GetPercentileMilliseconds(0.5),
+		FrameTimes.GetPercentileMilliseconds(0.9),
+		FrameTimes.GetPercentileMilliseconds(0.99),
+		FrameTimes.GetMaxMilliseconds(),
+		*HistogramFileName);
+
+	if (bExitWhenReplayFinishes) { FPlatformMisc::RequestExit(false, TEXT("URewindInputRecorderComponent::StopReplay")); }
+}
+
+APlayerController* URewindInputRecorderComponent::GetPlayerController() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	APlayerController* PlayerController = Pawn ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+	return PlayerController && PlayerController->IsLocalController() ? PlayerController : nullptr;
+}
+
+UEnhancedInputLocalPlayerSubsystem* URewindInputRecorderComponent::GetInputSubsystem() const
+{
+	const APlayerController* PlayerController = GetPlayerController();
+	ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	return LocalPlayer ? ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(LocalPlayer) : nullptr;
+}
+
+void URewindInputRecorderComponent::RecordFrame()
+{
+	// Frame lengths are recorded before time dilation, which is how the engine's fixed time step applies them
+	FRewindInputFrame& Frame = Recording.AddFrame(FApp::GetDeltaTime());
+
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem();
+	const UEnhancedPlayerInput* PlayerInput = Subsystem ? Subsystem->GetPlayerInput() : nullptr;
+	if (!PlayerInput) { return; }
+
+	// Start recording actions mapped since the last frame once they have a value; those without one read as zero anyway
+	for (const FEnhancedActionKeyMapping& Mapping : PlayerInput->GetEnhancedActionMappings())
+	{
+		const UInputAction* Action = Mapping.Action;
+		if (!Action || RecordedActions.ContainsByPredicate([Action](const auto& Recorded) { return Recorded.Key == Action; })) { continue; }
+		if (!PlayerInput->GetActionValue(Action).IsNonZero()) { continue; }
+
+		const int32 ActionIndex = Recording.FindOrAddAction(Action);
+		if (ActionIndex != INDEX_NONE) { RecordedActions.Emplace(Action, ActionIndex); }
+	}
+
+	for (const TPair<TWeakObjectPtr<const UInputAction>, int32>& RecordedAction : RecordedActions)
+	{
+		const UInputAction* Action = RecordedAction.Key.Get();
+		const FInputActionValue Value = Action ? PlayerInput->GetActionValue(Action) : FInputActionValue();
+		if (!Value.IsNonZero()) { continue; }
+
+		FRewindInputFrame::FValue& RecordedValue = Frame.Values.AddDefaulted_GetRef();
+		RecordedValue.ActionIndex = static_cast<uint8>(RecordedAction.Value);
+		RecordedValue.ValueType = Value.GetValueType();
+		RecordedValue.Value = FVector3f(Value.Get<FVector>());
+	}
+}
+
+void URewindInputRecorderComponent::ReplayFrameValues()
+{
+	const FRewindInputFrame& Frame = Recording.GetFrame(ReplayFrame++);
+	if (UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem())
+	{
+		// Actions that aren't injected read as zero, which completes them just as releasing their keys did
+		for (const FRewindInputFrame::FValue& Value : Frame.Values)
+		{
+			const UInputAction* Action = Recording.GetAction(Value.ActionIndex);
+			if (Action) { Subsystem->InjectInputForAction(Action, FInputActionValue(Value.ValueType, FVector(Value.Value))); }
+		}
+	}
+
+	SetNextFrameDeltaSeconds();
+}
+
+void URewindInputRecorderComponent::SetNextFrameDeltaSeconds()
+{
+	if (ReplayFrame < Recording.Num()) { FApp::SetFixedDeltaTime(Recording.GetFrame(ReplayFrame).DeltaSeconds); }
+}
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Components/ActorComponent.h"
+#include "RewindInputRecording.h"
+
+#include "RewindInputRecorderComponent.generated.h"
+
+class APlayerController;
+class UEnhancedInputLocalPlayerSubsystem;
+
+/**
+ * Records the Enhanced Input action values of the owning pawn's player every frame, and replays them without a player.
+ *
+ * Replays inject the recorded values ahead of the player controller's input processing and step the engine with the
+ * recorded frame lengths, so the same session plays out the same way on every run. While replaying, wall clock frame
+ * times go into a histogram that is saved next to the recording, for comparing the cost of a session across builds.
+ *
+ * Sessions can be driven from the command line for unattended performance runs, e.g. with -nullrhi:
+ *   -RewindRecordInput=<File>     records from the start of play until the pawn ends play
+ *   -RewindReplayInput=<File>     replays from the start of play
+ *   -RewindReplayExit             quits once the replay finishes
+ * Files live under Saved/Rewind.
+ *
+ * Values are recorded after all modifiers and injected through the actions' own modifiers and triggers, so actions
+ * should keep their modifiers on their key mappings, as the template's actions do.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class REWIND_API URewindInputRecorderComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URewindInputRecorderComponent();
+
+	// Starts recording the actions mapped for the owner's player; the recording is written when recording stops
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	bool StartRecording(const FString& FileName);
+
+	// Stops recording and writes the recording on a worker thread
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	void StopRecording();
+
+	// Starts replaying a recording into the owner's player
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	bool StartReplay(const FString& FileName);
+
+	// Stops replaying and saves the frame time histogram gathered so far
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	void StopReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	bool IsRecording() const { return bIsRecording; }
+
+	UFUNCTION(BlueprintCallable, Category = "Rewind|Input Recording")
+	bool IsReplaying() const { return bIsReplaying; }
+
+	// Whether the application quits once a replay finishes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind|Input Recording")
+	bool bExitWhenReplayFinishes = false;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the component is removed from play
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bIsRecording = false;
+
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	bool bIsReplaying = false;
+
+	// Next frame of the recording to replay
+	UPROPERTY(Transient, VisibleAnywhere, Category = "Rewind|Debug")
+	int32 ReplayFrame = 0;
+
+	// Returns the controller of the owning pawn, if it is locally controlled by a player
+	APlayerController* GetPlayerController() const;
+
+	// Returns the Enhanced Input subsystem of the owning pawn's player
+	UEnhancedInputLocalPlayerSubsystem* GetInputSubsystem() const;
+
+	// Appends the current value of every recorded action, first adding mapped actions with a value that aren't recorded yet
+	void RecordFrame();
+
+	// Injects the values of the next recorded frame
+	void ReplayFrameValues();
+
+	// Makes the engine step the next frame with the recorded frame length
+	void SetNextFrameDeltaSeconds();
+
+	FRewindInputRecording Recording;
+	FString RecordingFileName;
+
+	// Actions whose values are recorded and their index in the recording; actions are added when they first have a value,
+	// as mapping contexts are often added after recording starts
+	TArray<TPair<TWeakObjectPtr<const UInputAction>, int32>> RecordedActions;
+
+	// Wall clock frame times while replaying
+	FRewindFrameTimeHistogram FrameTimes;
+	double LastFrameSeconds = 0.0;
+
+	// Fixed time step settings to restore when the replay stops
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindInputRecording.h"
+
+#include "InputAction.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Rewind.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
+
+int32 FRewindInputRecording::FindOrAddAction(const UInputAction* Action)
+{
+	check(Action);
+
+	const FSoftObjectPath Path(Action);
+	const int32 ExistingIndex = ActionPaths.IndexOfByKey(Path);
+	if (ExistingIndex != INDEX_NONE) { return ExistingIndex; }
+
+	// Frames store action indices and value counts in a byte
+	if (ActionPaths.Num() >= MAX_uint8) { return INDEX_NONE; }
+
+	Actions.Add(Action);
+	return ActionPaths.Add(Path);
+}
+
+const UInputAction* FRewindInputRecording::GetAction(int32 ActionIndex) const
+{
+	if (!ActionPaths.IsValidIndex(ActionIndex)) { return nullptr; }
+
+	if (!Actions[ActionIndex].IsValid()) { Actions[ActionIndex] = Cast<UInputAction>(ActionPaths[ActionIndex].TryLoad()); }
+	return Actions[ActionIndex].Get();
+}
+
+FRewindInputFrame& FRewindInputRecording::AddFrame(float DeltaSeconds)
+{
+	FRewindInputFrame& Frame = Frames.AddDefaulted_GetRef();
+	Frame.DeltaSeconds = DeltaSeconds;
+	return Frame;
+}
+
+void FRewindInputRecording::Empty()
+{
+	ActionPaths.Empty();
+	Actions.Empty();
+	Frames.Empty();
+}
+
+void FRewindInputRecording::SaveAsync(const FString& FileName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindInputRecording::SaveAsync);
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Serialize(Writer);
+
+	UE::Tasks::Launch(
+		UE_SOURCE_LOCATION,
+		[Bytes = MoveTemp(Bytes), FileName]()
+		{
+			if (!FFileHelper::SaveArrayToFile(Bytes, *FileName))
+			{
+				UE_LOG(LogRewind, Warning, TEXT("Failed to write rewind input recording %s"), *FileName);
+			}
+		});
+}
+
+bool FRewindInputRecording::Load(const FString& FileName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindInputRecording::Load);
+
+	Empty();
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FileName))
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Failed to read rewind input recording %s"), *FileName);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+	if (Reader.IsError())
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Rewind input recording %s is not a supported recording"), *FileName);
+		Empty();
+		return false;
+	}
+
+	Actions.SetNum(ActionPaths.Num());
+	return true;
+}
+
+void FRewindInputRecording::Serialize(FArchive& Ar)
+{
+	uint32 Magic = RewindInputFileMagic;
+	uint32 Version = RewindInputFileVersion;
+	Ar << Magic << Version;
+	if (Magic != RewindInputFileMagic || Version != RewindInputFileVersion)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << ActionPaths;
+
+	int32 NumFrames = Frames.Num();
+	Ar << NumFrames;
+	if (Ar.IsLoading())
+	{
+		// Every frame takes at least five bytes, which bounds the count a truncated or corrupt file can claim
+		if (NumFrames < 0 || NumFrames > (Ar.TotalSize() - Ar.Tell()) / 5)
+		{
+			Ar.SetError();
+			return;
+		}
+		Frames.SetNum(NumFrames);
+	}
+	for (FRewindInputFrame& Frame : Frames)
+	{
+		Ar << Frame.DeltaSeconds;
+
+		uint8 NumValues = static_cast<uint8>(Frame.Values.Num());
+		Ar << NumValues;
+		if (Ar.IsLoading()) { Frame.Values.SetNum(NumValues); }
+		for (FRewindInputFrame::FValue& Value : Frame.Values)
+		{
+			uint8 ValueType = static_cast<uint8>(Value.ValueType);
+			Ar << Value.ActionIndex << ValueType << Value.Value;
+			Value.ValueType = static_cast<EInputActionValueType>(ValueType);
+		}
+		if (Ar.IsError()) { return; }
+	}
+}
+
+FRewindFrameTimeHistogram::FRewindFrameTimeHistogram()
+{
+	Buckets.SetNumZeroed(FMath::CeilToInt32(MaxMilliseconds / BucketMilliseconds) + 1);
+}
+
+void FRewindFrameTimeHistogram::Add(double Seconds)
+{
+	const double Milliseconds = Seconds * 1000.0;
+	const int32 Bucket = FMath::Min(FMath::FloorToInt32(Milliseconds / BucketMilliseconds), Buckets.Num() - 1);
+	++Buckets[FMath::Max(Bucket, 0)];
+	++NumFrames;
+	TotalMilliseconds += Milliseconds;
+	MaxFrameMilliseconds = FMath::Max(MaxFrameMilliseconds, Milliseconds);
+}
+
+double FRewindFrameTimeHistogram::GetPercentileMilliseconds(double Percentile) const
+{
+	if (NumFrames == 0) { return 0.0; }
+
+	const int64 Rank = FMath::CeilToInt64(NumFrames * FMath::Clamp(Percentile, 0.0, 1.0));
+	int64 Count = 0;
+	for (int32 Bucket = 0; Bucket < Buckets.Num(); ++Bucket)
+	{
+		Count += Buckets[Bucket];
+		if (Count >= Rank) { return FMath::Min((Bucket + 1) * BucketMilliseconds, MaxFrameMilliseconds); }
+	}
+	return MaxFrameMilliseconds;
+}
+
+bool FRewindFrameTimeHistogram::SaveCsv(const FString& FileName) const
+{
+	FString Csv;
+	Csv += FString::Printf(TEXT("# Build,%s\n"), FApp::GetBuildVersion());
+	Csv += FString::Printf(TEXT("# Frames,%d\n"), NumFrames);
+	Csv += FString::Printf(TEXT("# AverageMs,%.3f\n"), GetAverageMilliseconds());
+	Csv += FString::Printf(TEXT("# P50Ms,%.3f\n"), GetPercentileMilliseconds(0.5));
+	Csv += FString::Printf(TEXT("# P90Ms,%.3f\n"), GetPercentileMilliseconds(0.9));
+	Csv += FString::Printf(TEXT("# P99Ms,%.3f\n"), GetPercentileMilliseconds(0.99));
+	Csv += FString::Printf(TEXT("# MaxMs,%.3f\n"), MaxFrameMilliseconds);
+	Csv += TEXT("BucketStartMs,Frames\n");
+	for (int32 Bucket = 0; Bucket < Buckets.Num(); ++Bucket)
+	{
+		if (Buckets[Bucket] > 0) { Csv += FString::Printf(TEXT("%.2f,%u\n"), Bucket * BucketMilliseconds, Buckets[Bucket]); }
+	}
+	return FFileHelper::SaveStringToFile(Csv, *FileName);
+}
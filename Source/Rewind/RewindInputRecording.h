@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputActionValue.h"
+#include "UObject/SoftObjectPath.h"
+
+class UInputAction;
+
+// On-disk layout of an input recording, written with FArchive:
+//   Magic and version
+//   Action table: soft object path of every recorded input action
+//   Frames: delta seconds, then the action index, value type and value of every action that was non-zero
+
+// Identifies a rewind input recording
+constexpr uint32 RewindInputFileMagic = 0x4E495752; // 'RWIN'
+
+// Bump whenever the on-disk layout changes
+constexpr uint32 RewindInputFileVersion = 1;
+
+// Input action values of one frame
+struct FRewindInputFrame
+{
+	struct FValue
+	{
+		uint8 ActionIndex = 0;
+		EInputActionValueType ValueType = EInputActionValueType::Boolean;
+		FVector3f Value = FVector3f::ZeroVector;
+	};
+
+	// Length of the frame the values were read on
+	float DeltaSeconds = 0.0f;
+
+	// Actions that were zero are left out
+	TArray<FValue, TInlineAllocator<4>> Values;
+};
+
+// Per-frame input action values of a play session, for replaying it without a player
+class REWIND_API FRewindInputRecording
+{
+public:
+	// Returns the index of an action in the action table, adding it if needed; INDEX_NONE once the table is full
+	int32 FindOrAddAction(const UInputAction* Action);
+
+	// Returns the action at an index of the action table, loading it on first use; null if it no longer exists
+	const UInputAction* GetAction(int32 ActionIndex) const;
+
+	int32 Num() const { return Frames.Num(); }
+
+	const FRewindInputFrame& GetFrame(int32 Index) const { return Frames[Index]; }
+
+	// Appends an empty frame
+	FRewindInputFrame& AddFrame(float DeltaSeconds);
+
+	// Removes all actions and frames
+	void Empty();
+
+	// Serializes the recording on the calling thread and writes it on a worker thread; never blocks on the file system
+	void SaveAsync(const FString& FileName);
+
+	// Reads a recording written by SaveAsync
+	bool Load(const FString& FileName);
+
+private:
+	void Serialize(FArchive& Ar);
+
+	TArray<FSoftObjectPath> ActionPaths;
+
+	// Actions resolved from ActionPaths
+	mutable TArray<TWeakObjectPtr<const UInputAction>> Actions;
+
+	TArray<FRewindInputFrame> Frames;
+};
+
+// Histogram of frame times with fixed width buckets, for comparing runs of the same session across builds
+class REWIND_API FRewindFrameTimeHistogram
+{
+public:
+	// Width of each bucket and the frame time past which frames share the last bucket
+	static constexpr double BucketMilliseconds = 0.25;
+	static constexpr double MaxMilliseconds = 100.0;
+
+	FRewindFrameTimeHistogram();
+
+	void Add(double Seconds);
+
+	int32 Num() const { return NumFrames; }
+
+	// Returns the upper bound of the bucket holding the given percentile of frames, in milliseconds
+	double GetPercentileMilliseconds(double Percentile) const;
+
+	double GetMaxMilliseconds() const { return MaxFrameMilliseconds; }
+
+	double GetAverageMilliseconds() const { return NumFrames > 0 ? TotalMilliseconds / NumFrames : 0.0; }
+
+	// Writes the non-empty buckets as comma separated values, headed by the build version and summary statistics
+	bool SaveCsv(const FString& FileName) const;
+
+private:
+	TArray<uint32> Buckets;
+	int32 NumFrames = 0;
+	double TotalMilliseconds = 0.0;
+	double MaxFrameMilliseconds = 0.0;
+};
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindInstanceTimeline.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+
+void FRewindInstanceTimeline::Initialize(const UInstancedStaticMeshComponent& Mesh)
+{
+	const int32 NumInstances = Mesh.PerInstanceSMData.Num();
+	Locations.SetNumUninitialized(NumInstances);
+	Rotations.SetNumUninitialized(NumInstances);
+	Scales.SetNumUninitialized(NumInstances);
+	for (int32 InstanceIndex = 0; InstanceIndex < NumInstances; ++InstanceIndex)
+	{
+		const FTransform3f Transform(FMatrix44f(Mesh.PerInstanceSMData[InstanceIndex].Transform));
+		Locations[InstanceIndex] = Transform.GetLocation();
+		Rotations[InstanceIndex] = Transform.GetRotation();
+		Scales[InstanceIndex] = Transform.GetScale3D();
+	}
+
+	Changes.Empty();
+	DirtyBegin = MAX_int32;
+	DirtyEnd = 0;
+}
+
+bool FRewindInstanceTimeline::IsCompatible(const UInstancedStaticMeshComponent& Mesh) const
+{
+	return Locations.Num() > 0 && Mesh.PerInstanceSMData.Num() == Locations.Num();
+}
+
+void FRewindInstanceTimeline::Record(const UInstancedStaticMeshComponent& Mesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindInstanceTimeline::Record);
+
+	check(IsCompatible(Mesh));
+
+	Changes.AddFrame();
+	for (int32 InstanceIndex = 0; InstanceIndex < Locations.Num(); ++InstanceIndex)
+	{
+		const FTransform3f Transform(FMatrix44f(Mesh.PerInstanceSMData[InstanceIndex].Transform));
+		const FVector3f Location = Transform.GetLocation();
+		const FQuat4f Rotation = Transform.GetRotation();
+		const bool bMoved = !Location.Equals(Locations[InstanceIndex], RewindChangeLog::LocationTolerance);
+		const bool bRotated = !Rotation.Equals(Rotations[InstanceIndex], RewindChangeLog::RotationTolerance);
+		if (!bMoved && !bRotated) { continue; }
+
+		Changes.AddChange(InstanceIndex, {Locations[InstanceIndex], Rotations[InstanceIndex]}, {Location, Rotation});
+		Locations[InstanceIndex] = Location;
+		Rotations[InstanceIndex] = Rotation;
+	}
+}
+
+void FRewindInstanceTimeline::PopFront()
+{
+	Changes.PopFront();
+}
+
+void FRewindInstanceTimeline::Truncate(int32 Count)
+{
+	Changes.Truncate(Count, [this](int32 InstanceIndex, const FInstanceState& State) { SetInstance(InstanceIndex, State); });
+}
+
+void FRewindInstanceTimeline::Empty()
+{
+	Changes.Empty();
+}
+
+void FRewindInstanceTimeline::Apply(int32 IndexA, int32 IndexB, float Alpha, UInstancedStaticMeshComponent& Mesh)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindInstanceTimeline::Apply);
+
+	if (!IsCompatible(Mesh) || Num() == 0) { return; }
+
+	// Settle on the older frame; instances that moved on the way to the newer one are blended on top of it
+	const int32 OlderIndex = FMath::Min(IndexA, IndexB);
+	const int32 NewerIndex = FMath::Max(IndexA, IndexB);
+	check(NewerIndex - OlderIndex <= 1);
+	Changes.Seek(OlderIndex, [this](int32 InstanceIndex, const FInstanceState& State) { SetInstance(InstanceIndex, State); });
+
+	const bool bBlend = NewerIndex != OlderIndex;
+	const float NewerAlpha = IndexB == NewerIndex ? Alpha : 1.0f - Alpha;
+	if (bBlend)
+	{
+		Changes.ForEachChange(
+			NewerIndex, [this](int32 InstanceIndex, const FInstanceState&, const FInstanceState&) { MarkDirty(InstanceIndex); });
+	}
+	if (DirtyBegin >= DirtyEnd) { return; }
+
+	// Send the whole dirty range in one batched update rather than updating instances one at a time
+	UpdateTransforms.SetNumUninitialized(DirtyEnd - DirtyBegin, false);
+	for (int32 InstanceIndex = DirtyBegin; InstanceIndex < DirtyEnd; ++InstanceIndex)
+	{
+		UpdateTransforms[InstanceIndex - DirtyBegin] = FTransform(
+			FQuat(Rotations[InstanceIndex]),
+			FVector(Locations[InstanceIndex]),
+			FVector(Scales[InstanceIndex]));
+	}
+	const int32 UpdateBegin = DirtyBegin;
+	DirtyBegin = MAX_int32;
+	DirtyEnd = 0;
+
+	if (bBlend)
+	{
+		Changes.ForEachChange(
+			NewerIndex,
+			[this, UpdateBegin, NewerAlpha](int32 InstanceIndex, const FInstanceState& From, const FInstanceState& To)
+			{
+				FTransform& Transform = UpdateTransforms[InstanceIndex - UpdateBegin];
+				Transform.SetLocation(FVector(FMath::Lerp(From.Location, To.Location, NewerAlpha)));
+				Transform.SetRotation(FQuat(FQuat4f::FastLerp(From.Rotation, To.Rotation, NewerAlpha).GetNormalized()));
+
+				// Blended instances differ from the current state, so they need to be sent again next time
+				MarkDirty(InstanceIndex);
+			});
+	}
+
+	Mesh.BatchUpdateInstancesTransforms(
+		UpdateBegin,
+		UpdateTransforms,
+		false /*bWorldSpace*/,
+		true /*bMarkRenderStateDirty*/,
+		true /*bTeleport*/);
+}
+
+SIZE_T FRewindInstanceTimeline::GetAllocatedSize() const
+{
+	return Changes.GetAllocatedSize() + Locations.GetAllocatedSize() + Rotations.GetAllocatedSize() + Scales.GetAllocatedSize()
+		+ UpdateTransforms.GetAllocatedSize();
+}
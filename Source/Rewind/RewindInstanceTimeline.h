@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RewindChangeLog.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ * Timeline of per-instance transforms of an instanced static mesh component.
+ *
+ * Frames store only the instances that moved since the previous frame in a change log, so settled debris costs nothing
+ * and playback can step in either direction by undoing or redoing changes. The current state of every instance is kept
+ * as a structure of arrays. Instance scale is not rewound.
+ */
+class REWIND_API FRewindInstanceTimeline
+{
+public:
+	// Reads every instance of Mesh as the starting state and discards any history
+	void Initialize(const UInstancedStaticMeshComponent& Mesh);
+
+	// Returns whether frames recorded so far can be applied to Mesh's current instances
+	bool IsCompatible(const UInstancedStaticMeshComponent& Mesh) const;
+
+	int32 Num() const { return Changes.Num(); }
+
+	// Appends a frame holding the instances of Mesh that moved since the newest frame; must be at the newest frame
+	void Record(const UInstancedStaticMeshComponent& Mesh);
+
+	// Removes the oldest frame
+	void PopFront();
+
+	// Keeps the oldest Count frames
+	void Truncate(int32 Count);
+
+	// Removes all frames, keeping the current state as the starting point for new ones
+	void Empty();
+
+	// Moves the instances of Mesh to the blend of two adjacent frames using one batched transform update
+	void Apply(int32 IndexA, int32 IndexB, float Alpha, UInstancedStaticMeshComponent& Mesh);
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FInstanceState
+	{
+		FVector3f Location;
+		FQuat4f Rotation;
+	};
+
+	// Sets the current state of an instance while stepping through the change log
+	void SetInstance(int32 InstanceIndex, const FInstanceState& State)
+	{
+		Locations[InstanceIndex] = State.Location;
+		Rotations[InstanceIndex] = State.Rotation;
+		MarkDirty(InstanceIndex);
+	}
+
+	// Widens the range of instances that must be sent to the mesh on the next apply
+	void MarkDirty(int32 InstanceIndex)
+	{
+		DirtyBegin = FMath::Min(DirtyBegin, InstanceIndex);
+		DirtyEnd = FMath::Max(DirtyEnd, InstanceIndex + 1);
+	}
+
+	// Instances that moved in each frame
+	TRewindChangeLog<FInstanceState> Changes;
+
+	// Local space state of every instance at the change log's current frame
+	TArray<FVector3f> Locations;
+	TArray<FQuat4f> Rotations;
+	TArray<FVector3f> Scales;
+
+	// Range of instances whose transforms on the mesh may differ from the current state
+	int32 DirtyBegin = MAX_int32;
+	int32 DirtyEnd = 0;
+
+	// Scratch space for batched updates
+	TArray<FTransform> UpdateTransforms;
+};
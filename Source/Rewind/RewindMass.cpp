@@ -0,0 +1,341 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindMass.h"
+
+#include "Engine/World.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassExecutionContext.h"
+#include "MassMovementFragments.h"
+#include "Rewind.h"
+#include "RewindGameMode.h"
+
+namespace RewindMass
+{
+	// Yaw is stored as a 16 bit fraction of a half turn
+	constexpr float YawToShort = 32768.0f / 180.0f;
+	constexpr float ShortToYaw = 180.0f / 32768.0f;
+
+	int16 QuantizeYaw(float Yaw)
+	{
+		return static_cast<int16>(static_cast<uint16>(FMath::RoundToInt32(FRotator::NormalizeAxis(Yaw) * YawToShort)));
+	}
+} // namespace RewindMass
+
+void URewindMassTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const
+{
+	BuildContext.AddFragment<FRewindMassFragment>();
+	BuildContext.RequireFragment<FTransformFragment>();
+}
+
+bool URewindMassSubsystem::InitializeStorage()
+{
+	if (MaxSlots > 0) { return true; }
+
+	GameMode = GetWorld()->GetAuthGameMode<ARewindGameMode>();
+	if (!GameMode) { return false; }
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindMassSubsystem::InitializeStorage);
+
+	SnapshotIntervalSeconds = GameMode->MassSnapshotFrequencySeconds;
+	MaxFrames = FMath::Max(FMath::CeilToInt32(GameMode->MassMaxRewindSeconds / SnapshotIntervalSeconds) + 1, 2);
+	MaxSlots = GameMode->MaxRewindableMassEntities;
+	FrameDeltas.SetNumZeroed(MaxFrames);
+	return true;
+}
+
+int32 URewindMassSubsystem::AllocateSlot()
+{
+	if (!InitializeStorage()) { return INDEX_NONE; }
+
+	int32 Slot = INDEX_NONE;
+	if (FreeSlots.Num() > 0) { Slot = FreeSlots.Pop(false); }
+	else if (NumAllocatedSlots < MaxSlots) { Slot = NumAllocatedSlots++; }
+	else
+	{
+		if (!bWarnedSlotsExhausted)
+		{
+			bWarnedSlotsExhausted = true;
+			UE_LOG(LogRewind, Warning, TEXT("More than %d Mass entities are rewindable; entities beyond that won't be rewound"), MaxSlots);
+		}
+		return INDEX_NONE;
+	}
+
+	// Slots are handed out in order, so a new chunk is only needed when the first slot of it is
+	if (Slot / SlotsPerChunk >= SlotChunks.Num())
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(URewindMassSubsystem::AllocateChunk);
+
+		FSlotChunk& Chunk = SlotChunks.AddDefaulted_GetRef();
+		Chunk.Locations.SetNumZeroed(MaxFrames * SlotsPerChunk);
+		Chunk.Yaws.SetNumZeroed(MaxFrames * SlotsPerChunk);
+		SlotBirthFrames.SetNumZeroed(SlotChunks.Num() * SlotsPerChunk);
+	}
+
+	// The entity's history starts with the next recorded frame
+	SlotBirthFrames[Slot] = NumDroppedFrames + NumRecordedFrames;
+	return Slot;
+}
+
+void URewindMassSubsystem::ReleaseSlot(int32 Slot)
+{
+	if (Slot != INDEX_NONE) { FreeSlots.Add(Slot); }
+}
+
+FRewindMassFrameUpdate URewindMassSubsystem::Update(float DeltaTime)
+{
+	// Nothing is recorded until the first rewindable entity allocates history
+	if (!GameMode || MaxSlots == 0) { return FRewindMassFrameUpdate(); }
+
+	const bool bIsRewinding = GameMode->IsGlobalRewinding();
+	const bool bIsFastForwarding = GameMode->IsGlobalFastForwarding();
+	const bool bIsManipulatingTime = bIsRewinding || bIsFastForwarding || GameMode->IsGlobalTimeScrubbing();
+	if (!bIsManipulatingTime)
+	{
+		// Leaving playback snaps every entity to the playhead and erases the future that was rewound over
+		if (bWasManipulatingTime)
+		{
+			bWasManipulatingTime = false;
+			TimeSinceLastFrame = 0.0f;
+			if (PlayheadFrame == INDEX_NONE) { return FRewindMassFrameUpdate(); }
+
+			NumRecordedFrames = PlayheadFrame + 1;
+			PlayheadSeconds = 0.0f;
+
+			// Entities born in the erased future, or during playback, are recorded from the next frame on
+			const uint64 NextFrame = NumDroppedFrames + NumRecordedFrames;
+			for (int32 Slot = 0; Slot < NumAllocatedSlots; ++Slot) { SlotBirthFrames[Slot] = FMath::Min(SlotBirthFrames[Slot], NextFrame); }
+			return MakePlayUpdate();
+		}
+
+		TimeSinceLastFrame += DeltaTime;
+		if (NumRecordedFrames > 0 && TimeSinceLastFrame < SnapshotIntervalSeconds) { return FRewindMassFrameUpdate(); }
+
+		// If the ring is full, drop the oldest frame
+		if (NumRecordedFrames == MaxFrames)
+		{
+			FirstFrame = (FirstFrame + 1) % MaxFrames;
+			--NumRecordedFrames;
+			++NumDroppedFrames;
+		}
+
+		FRewindMassFrameUpdate FrameUpdate;
+		FrameUpdate.Action = FRewindMassFrameUpdate::EAction::Record;
+		FrameUpdate.Frame = NumRecordedFrames++;
+		FrameDeltas[(FirstFrame + FrameUpdate.Frame) % MaxFrames] = TimeSinceLastFrame;
+		TimeSinceLastFrame = 0.0f;
+		return FrameUpdate;
+	}
+
+	// Playback starts from the newest frame
+	if (!bWasManipulatingTime)
+	{
+		bWasManipulatingTime = true;
+		PlayheadFrame = NumRecordedFrames - 1;
+		PlayheadSeconds = 0.0f;
+	}
+	if (PlayheadFrame == INDEX_NONE) { return FRewindMassFrameUpdate(); }
+
+	// Time scrubbing without rewinding or fast forwarding holds the playhead where it is
+	const float PlaybackDeltaTime = DeltaTime * GameMode->GetGlobalRewindSpeed();
+	if (bIsRewinding)
+	{
+		PlayheadSeconds -= PlaybackDeltaTime;
+		while (PlayheadSeconds < 0.0f && PlayheadFrame > 0)
+		{
+			PlayheadSeconds += GetFrameDelta(PlayheadFrame);
+			--PlayheadFrame;
+		}
+		PlayheadSeconds = FMath::Max(PlayheadSeconds, 0.0f);
+	}
+	else if (bIsFastForwarding)
+	{
+		PlayheadSeconds += PlaybackDeltaTime;
+		while (PlayheadFrame < NumRecordedFrames - 1 && PlayheadSeconds >= GetFrameDelta(PlayheadFrame + 1))
+		{
+			PlayheadSeconds -= GetFrameDelta(PlayheadFrame + 1);
+			++PlayheadFrame;
+		}
+		if (PlayheadFrame == NumRecordedFrames - 1) { PlayheadSeconds = 0.0f; }
+	}
+
+	return MakePlayUpdate();
+}
+
+FRewindMassFrameUpdate URewindMassSubsystem::MakePlayUpdate() const
+{
+	FRewindMassFrameUpdate FrameUpdate;
+	FrameUpdate.Action = FRewindMassFrameUpdate::EAction::Play;
+	FrameUpdate.FrameA = PlayheadFrame;
+	FrameUpdate.FrameB = PlayheadFrame;
+	FrameUpdate.VelocityScale = bWasManipulatingTime ? GameMode->GetGlobalRewindSpeed() : 1.0f;
+	if (PlayheadSeconds > 0.0f && PlayheadFrame < NumRecordedFrames - 1)
+	{
+		FrameUpdate.FrameB = PlayheadFrame + 1;
+		FrameUpdate.Alpha = FMath::Clamp(PlayheadSeconds / GetFrameDelta(PlayheadFrame + 1), 0.0f, 1.0f);
+	}
+	return FrameUpdate;
+}
+
+void URewindMassSubsystem::Record(const FRewindMassFrameUpdate& FrameUpdate, int32 Slot, const FTransform& Transform)
+{
+	FSlotChunk& Chunk = SlotChunks[Slot / SlotsPerChunk];
+	const int32 Offset = GetChunkOffset(FrameUpdate.Frame, Slot);
+	Chunk.Locations[Offset] = FVector3f(Transform.GetLocation());
+	Chunk.Yaws[Offset] = RewindMass::QuantizeYaw(Transform.GetRotation().Rotator().Yaw);
+}
+
+bool URewindMassSubsystem::Sample(
+	const FRewindMassFrameUpdate& FrameUpdate,
+	int32 Slot,
+	FTransform& InOutTransform,
+	FVector& OutVelocity) const
+{
+	// Entities spawned after the playhead hold still until time catches up with them
+	const uint64 BirthFrame = SlotBirthFrames[Slot];
+	if (NumDroppedFrames + FrameUpdate.FrameA < BirthFrame) { return false; }
+
+	const FSlotChunk& Chunk = GetChunk(Slot);
+	const int32 OffsetA = GetChunkOffset(FrameUpdate.FrameA, Slot);
+	const int32 OffsetB = GetChunkOffset(FrameUpdate.FrameB, Slot);
+	const float YawA = Chunk.Yaws[OffsetA] * RewindMass::ShortToYaw;
+	const float YawB = Chunk.Yaws[OffsetB] * RewindMass::ShortToYaw;
+	const float Yaw = YawA + FMath::FindDeltaAngleDegrees(YawA, YawB) * FrameUpdate.Alpha;
+	InOutTransform.SetLocation(FVector(FMath::Lerp(Chunk.Locations[OffsetA], Chunk.Locations[OffsetB], FrameUpdate.Alpha)));
+	InOutTransform.SetRotation(FQuat(FRotator(0.0f, Yaw, 0.0f)));
+
+	// Velocity comes from the gap the playhead is in, or the gap leading up to it when it sits on a frame
+	const int32 NewerFrame = FMath::Max(FrameUpdate.FrameB, 1);
+	const int32 OlderFrame = NewerFrame - 1;
+	OutVelocity = FVector::ZeroVector;
+	if (NewerFrame < NumRecordedFrames && NumDroppedFrames + OlderFrame >= BirthFrame)
+	{
+		const FVector3f Delta = Chunk.Locations[GetChunkOffset(NewerFrame, Slot)] - Chunk.Locations[GetChunkOffset(OlderFrame, Slot)];
+		OutVelocity = FVector(Delta) * (FrameUpdate.VelocityScale / FMath::Max(GetFrameDelta(NewerFrame), UE_SMALL_NUMBER));
+	}
+	return true;
+}
+
+URewindMassProcessor::URewindMassProcessor()
+{
+	// Run after movement so playback overrides whatever movement did this frame
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+	ExecutionOrder.ExecuteAfter.Add(UE::Mass::ProcessorGroupNames::Movement);
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void URewindMassProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FRewindMassFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassVelocityFragment>(EMassFragmentAccess::ReadWrite, EMassFragmentPresence::Optional);
+}
+
+void URewindMassProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(URewindMassProcessor::Execute);
+
+	URewindMassSubsystem* Subsystem = UWorld::GetSubsystem<URewindMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem) { return; }
+
+	// The playhead is advanced once for all entities; chunks only read or write their own slots, so they run in parallel
+	const FRewindMassFrameUpdate FrameUpdate = Subsystem->Update(Context.GetDeltaTimeSeconds());
+	if (FrameUpdate.Action == FRewindMassFrameUpdate::EAction::None) { return; }
+
+	EntityQuery.ParallelForEachEntityChunk(
+		EntityManager,
+		Context,
+		[Subsystem, &FrameUpdate](FMassExecutionContext& ChunkContext)
+		{
+			const TConstArrayView<FRewindMassFragment> RewindList = ChunkContext.GetFragmentView<FRewindMassFragment>();
+			const TArrayView<FTransformFragment> TransformList = ChunkContext.GetMutableFragmentView<FTransformFragment>();
+			const TArrayView<FMassVelocityFragment> VelocityList = ChunkContext.GetMutableFragmentView<FMassVelocityFragment>();
+			const int32 NumEntities = ChunkContext.GetNumEntities();
+			if (FrameUpdate.Action == FRewindMassFrameUpdate::EAction::Record)
+			{
+				for (int32 EntityIndex = 0; EntityIndex < NumEntities; ++EntityIndex)
+				{
+					const int32 Slot = RewindList[EntityIndex].Slot;
+					if (Slot != INDEX_NONE) { Subsystem->Record(FrameUpdate, Slot, TransformList[EntityIndex].GetTransform()); }
+				}
+				return;
+			}
+
+			for (int32 EntityIndex = 0; EntityIndex < NumEntities; ++EntityIndex)
+			{
+				const int32 Slot = RewindList[EntityIndex].Slot;
+				FVector Velocity;
+				if (Slot == INDEX_NONE || !Subsystem->Sample(FrameUpdate, Slot, TransformList[EntityIndex].GetMutableTransform(), Velocity))
+				{
+					continue;
+				}
+				if (VelocityList.Num() > 0) { VelocityList[EntityIndex].Value = Velocity; }
+			}
+		});
+}
+
+URewindMassSlotInitializer::URewindMassSlotInitializer()
+{
+	ObservedType = FRewindMassFragment::StaticStruct();
+	Operation = EMassObservedOperation::Add;
+
+	// Slots come from the subsystem's free list
+	bRequiresGameThreadExecution = true;
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void URewindMassSlotInitializer::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FRewindMassFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void URewindMassSlotInitializer::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	URewindMassSubsystem* Subsystem = UWorld::GetSubsystem<URewindMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem) { return; }
+
+	EntityQuery.ForEachEntityChunk(
+		EntityManager,
+		Context,
+		[Subsystem](FMassExecutionContext& ChunkContext)
+		{
+			for (FRewindMassFragment& Rewind : ChunkContext.GetMutableFragmentView<FRewindMassFragment>())
+			{
+				Rewind.Slot = Subsystem->AllocateSlot();
+			}
+		});
+}
+
+URewindMassSlotDeinitializer::URewindMassSlotDeinitializer()
+{
+	ObservedType = FRewindMassFragment::StaticStruct();
+	Operation = EMassObservedOperation::Remove;
+
+	// Slots are returned to the subsystem's free list
+	bRequiresGameThreadExecution = true;
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void URewindMassSlotDeinitializer::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FRewindMassFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void URewindMassSlotDeinitializer::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	URewindMassSubsystem* Subsystem = UWorld::GetSubsystem<URewindMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem) { return; }
+
+	EntityQuery.ForEachEntityChunk(
+		EntityManager,
+		Context,
+		[Subsystem](FMassExecutionContext& ChunkContext)
+		{
+			for (FRewindMassFragment& Rewind : ChunkContext.GetMutableFragmentView<FRewindMassFragment>())
+			{
+				Subsystem->ReleaseSlot(Rewind.Slot);
+				Rewind.Slot = INDEX_NONE;
+			}
+		});
+}
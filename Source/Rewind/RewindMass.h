@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MassEntityQuery.h"
+#include "MassEntityTraitBase.h"
+#include "MassEntityTypes.h"
+#include "MassObserverProcessor.h"
+#include "MassProcessor.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "RewindMass.generated.h"
+
+class ARewindGameMode;
+
+// Makes a Mass entity rewindable; locates the entity's column in URewindMassSubsystem's history
+USTRUCT()
+struct REWIND_API FRewindMassFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	// INDEX_NONE if the entity couldn't be given a slot because MaxRewindableMassEntities are already being rewound
+	int32 Slot = INDEX_NONE;
+};
+
+// Adds rewind support to Mass entity configs
+UCLASS(meta = (DisplayName = "Rewind"))
+class REWIND_API URewindMassTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+};
+
+// Work the rewind processor does for every rewindable entity this frame
+struct FRewindMassFrameUpdate
+{
+	enum class EAction : uint8
+	{
+		None,
+
+		// Write each entity's transform into Frame
+		Record,
+
+		// Move each entity to the blend of FrameA and FrameB
+		Play,
+	};
+
+	EAction Action = EAction::None;
+
+	// Frame recorded into
+	int32 Frame = INDEX_NONE;
+
+	// Frames blended during playback; Alpha is the weight of FrameB
+	int32 FrameA = INDEX_NONE;
+	int32 FrameB = INDEX_NONE;
+	float Alpha = 0.0f;
+
+	// Scale applied to recorded velocities during playback
+	float VelocityScale = 1.0f;
+};
+
+/**
+ * History of every rewindable Mass entity in a world.
+ *
+ * Unlike URewindComponent, which keeps a timeline per actor, entities share a single ring of frames and a single
+ * playhead that follows ARewindGameMode's global state. Each frame stores one column per entity slot as structures of
+ * arrays, so the processor's chunk loops only do per-entity reads and writes. Entities are assumed to stay upright:
+ * only location and yaw are recorded, and playback velocity is derived from consecutive locations.
+ */
+UCLASS()
+class REWIND_API URewindMassSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Returns a free slot for a new entity, or INDEX_NONE if all slots are in use
+	int32 AllocateSlot();
+
+	// Returns a slot to the free list
+	void ReleaseSlot(int32 Slot);
+
+	// Advances recording or the shared playhead by DeltaTime and returns what the processor should do this frame
+	FRewindMassFrameUpdate Update(float DeltaTime);
+
+	// Writes an entity's transform into a frame; safe to call from parallel chunk loops for distinct slots
+	void Record(const FRewindMassFrameUpdate& FrameUpdate, int32 Slot, const FTransform& Transform);
+
+	// Samples an entity's playback transform and velocity; returns false if the entity didn't exist at that point
+	bool Sample(const FRewindMassFrameUpdate& FrameUpdate, int32 Slot, FTransform& InOutTransform, FVector& OutVelocity) const;
+
+	int32 NumFrames() const { return NumRecordedFrames; }
+
+private:
+	// Allocates history using the game mode's settings on first use; returns false if there is no rewind game mode
+	bool InitializeStorage();
+
+	// Number of slots whose history is allocated together
+	static constexpr int32 SlotsPerChunk = 1024;
+
+	// History of SlotsPerChunk slots; frame-major, SlotsPerChunk entries per frame
+	struct FSlotChunk
+	{
+		TArray<FVector3f> Locations;
+		TArray<int16> Yaws;
+	};
+
+	// Returns the offset of a slot's entry for a frame within its chunk
+	int32 GetChunkOffset(int32 Frame, int32 Slot) const
+	{
+		return ((FirstFrame + Frame) % MaxFrames) * SlotsPerChunk + Slot % SlotsPerChunk;
+	}
+
+	const FSlotChunk& GetChunk(int32 Slot) const { return SlotChunks[Slot / SlotsPerChunk]; }
+
+	float GetFrameDelta(int32 Frame) const { return FrameDeltas[(FirstFrame + Frame) % MaxFrames]; }
+
+	// Builds a playback update blending the playhead's frames
+	FRewindMassFrameUpdate MakePlayUpdate() const;
+
+	UPROPERTY(Transient)
+	TObjectPtr<ARewindGameMode> GameMode;
+
+	// History of every slot allocated so far; chunks are allocated as slots are first used, so memory follows the highest
+	// number of entities rewound at once rather than MaxRewindableMassEntities
+	TArray<FSlotChunk> SlotChunks;
+
+	// Time between each frame and the one before it
+	TArray<float> FrameDeltas;
+
+	// Ring of frames; FirstFrame is the physical index of the oldest
+	int32 MaxFrames = 0;
+	int32 FirstFrame = 0;
+	int32 NumRecordedFrames = 0;
+
+	// Number of frames ever dropped from the front, so frames can be numbered across the lifetime of the ring
+	uint64 NumDroppedFrames = 0;
+
+	// First frame number each slot's current entity was recorded on; older frames belong to a previous entity
+	TArray<uint64> SlotBirthFrames;
+
+	TArray<int32> FreeSlots;
+	int32 MaxSlots = 0;
+	int32 NumAllocatedSlots = 0;
+
+	// Whether running out of slots has been reported; it is only reported once per world
+	bool bWarnedSlotsExhausted = false;
+
+	float SnapshotIntervalSeconds = 0.1f;
+
+	// Time since the newest frame was recorded
+	float TimeSinceLastFrame = 0.0f;
+
+	// Shared playhead: the frame at or before it, and how far past that frame it is
+	int32 PlayheadFrame = INDEX_NONE;
+	float PlayheadSeconds = 0.0f;
+
+	bool bWasManipulatingTime = false;
+};
+
+// Records and plays back every rewindable Mass entity after movement has run
+UCLASS()
+class REWIND_API URewindMassProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URewindMassProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+// Gives new rewindable entities a history slot
+UCLASS()
+class REWIND_API URewindMassSlotInitializer : public UMassObserverProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URewindMassSlotInitializer();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+// Frees the history slot of destroyed rewindable entities
+UCLASS()
+class REWIND_API URewindMassSlotDeinitializer : public UMassObserverProcessor
+{
+	GENERATED_BODY()
+
+public:
+	URewindMassSlotDeinitializer();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
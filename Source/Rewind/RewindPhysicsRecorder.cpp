@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindPhysicsRecorder.h"
+
+#include "Engine/World.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "Rewind.h"
+
+void FRewindPhysicsRecorderCallback::OnPreSimulate_Internal()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPhysicsRecorderCallback::OnPreSimulate_Internal);
+
+	// Apply registration changes made on the game thread since the previous step
+	if (const FRewindPhysicsRecorderInput* Input = GetConsumerInput_Internal())
+	{
+		for (const TPair<FPhysicsActorHandle, TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>>& Added : Input->AddedBodies)
+		{
+			FBody& Body = Bodies.AddDefaulted_GetRef();
+			Body.Proxy = Added.Key;
+			Body.Buffer = Added.Value;
+		}
+
+		for (const TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>& Removed : Input->RemovedBodies)
+		{
+			Bodies.RemoveAllSwap([&Removed](const FBody& Body) { return Body.Buffer == Removed; });
+		}
+	}
+
+	const float DeltaTime = GetDeltaTime_Internal();
+	const double SimTime = GetSimTime_Internal();
+	for (FBody& Body : Bodies)
+	{
+		Body.TimeSinceSample += DeltaTime;
+		if (Body.TimeSinceSample < Body.Buffer->IntervalSeconds.load(std::memory_order_relaxed)) { continue; }
+
+		// Kinematic bodies are being driven by playback rather than simulated, so there is nothing to record
+		Chaos::FRigidBodyHandle_Internal* Handle = Body.Proxy->GetPhysicsThreadAPI();
+		const Chaos::EObjectStateType ObjectState = Handle ? Handle->ObjectState() : Chaos::EObjectStateType::Static;
+		if (ObjectState != Chaos::EObjectStateType::Dynamic && ObjectState != Chaos::EObjectStateType::Sleeping) { continue; }
+
+		FRewindPhysicsSample Sample;
+		Sample.Time = SimTime;
+		Sample.Location = Handle->X();
+		Sample.Rotation = Handle->R();
+		Sample.LinearVelocity = Handle->V();
+		Sample.AngularVelocityInRadians = Handle->W();
+		Sample.bIsSleeping = ObjectState == Chaos::EObjectStateType::Sleeping;
+		Body.Buffer->Samples.Enqueue(Sample);
+		Body.TimeSinceSample = 0.0f;
+	}
+}
+
+FRewindPhysicsRecorder::~FRewindPhysicsRecorder()
+{
+	Shutdown();
+}
+
+bool FRewindPhysicsRecorder::Initialize(UWorld* World)
+{
+	check(!Callback);
+
+	FPhysScene* PhysScene = World ? World->GetPhysicsScene() : nullptr;
+	Solver = PhysScene ? PhysScene->GetSolver() : nullptr;
+	if (!Solver)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("No physics solver available; rewind components will record on the game thread"));
+		return false;
+	}
+
+	Callback = Solver->CreateAndRegisterSimCallbackObject_External<FRewindPhysicsRecorderCallback>();
+	return true;
+}
+
+void FRewindPhysicsRecorder::Shutdown()
+{
+	if (!Callback) { return; }
+
+	Solver->UnregisterAndFreeSimCallbackObject_External(Callback);
+	Callback = nullptr;
+	Solver = nullptr;
+}
+
+TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe> FRewindPhysicsRecorder::RegisterBody(
+	const FBodyInstance& BodyInstance,
+	float IntervalSeconds)
+{
+	FPhysicsActorHandle Proxy = BodyInstance.GetPhysicsActorHandle();
+	if (!Callback || !Proxy) { return nullptr; }
+
+	TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe> Buffer =
+		MakeShared<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>(BufferCapacity);
+	Buffer->IntervalSeconds = IntervalSeconds;
+	Callback->GetProducerInputData_External()->AddedBodies.Emplace(Proxy, Buffer);
+	return Buffer;
+}
+
+void FRewindPhysicsRecorder::UnregisterBody(const TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>& Buffer)
+{
+	if (Callback && Buffer) { Callback->GetProducerInputData_External()->RemovedBodies.Add(Buffer); }
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Containers/CircularQueue.h"
+#include "Physics/PhysicsInterfaceDeclares.h"
+
+#include <atomic>
+
+struct FBodyInstance;
+
+namespace Chaos
+{
+	class FPBDRigidsSolver;
+}
+
+// State of a rigid body captured on the physics thread at the start of a physics step
+struct FRewindPhysicsSample
+{
+	// Physics simulation time the sample was captured at
+	double Time = 0.0;
+
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FVector AngularVelocityInRadians = FVector::ZeroVector;
+	bool bIsSleeping = false;
+};
+
+// Samples recorded for one body; written by the physics thread and drained by the game thread without locks
+struct FRewindPhysicsBodyBuffer
+{
+	explicit FRewindPhysicsBodyBuffer(uint32 Capacity) : Samples(Capacity) {}
+
+	// Single producer (physics thread), single consumer (game thread); samples are dropped while the queue is full
+	TCircularQueue<FRewindPhysicsSample> Samples;
+
+	// Minimum simulation time between samples; may be changed by the game thread at any time
+	std::atomic<float> IntervalSeconds{ 0.0f };
+};
+
+// Body registration changes marshalled from the game thread to the physics thread
+struct FRewindPhysicsRecorderInput : public Chaos::FSimCallbackInput
+{
+	TArray<TPair<FPhysicsActorHandle, TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>>> AddedBodies;
+	TArray<TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>> RemovedBodies;
+
+	void Reset()
+	{
+		AddedBodies.Reset();
+		RemovedBodies.Reset();
+	}
+};
+
+// Physics thread callback that samples registered bodies at the fixed physics step
+class FRewindPhysicsRecorderCallback
+	: public Chaos::TSimCallbackObject<FRewindPhysicsRecorderInput, Chaos::FSimCallbackNoOutput, Chaos::ESimCallbackOptions::Presimulate>
+{
+private:
+	virtual void OnPreSimulate_Internal() override;
+
+	struct FBody
+	{
+		FPhysicsActorHandle Proxy = nullptr;
+		TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe> Buffer;
+
+		// Simulation time since the body was last sampled
+		float TimeSinceSample = 0.0f;
+	};
+
+	// Registered bodies; only touched on the physics thread
+	TArray<FBody> Bodies;
+};
+
+// Records simulating bodies from a Chaos sim callback instead of polling them on the game thread after physics completes
+class REWIND_API FRewindPhysicsRecorder
+{
+public:
+	~FRewindPhysicsRecorder();
+
+	// Registers the callback with the world's physics solver
+	bool Initialize(UWorld* World);
+
+	// Unregisters the callback; buffers handed out remain valid but stop receiving samples
+	void Shutdown();
+
+	// Starts sampling a simulating body every IntervalSeconds of simulation time; returns null if the body has no physics state
+	TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe> RegisterBody(const FBodyInstance& BodyInstance, float IntervalSeconds);
+
+	// Stops sampling a body; must be called before the body's physics state is destroyed
+	void UnregisterBody(const TSharedPtr<FRewindPhysicsBodyBuffer, ESPMode::ThreadSafe>& Buffer);
+
+	// Samples each body can buffer before the game thread drains them
+	static constexpr uint32 BufferCapacity = 256;
+
+private:
+	Chaos::FPBDRigidsSolver* Solver = nullptr;
+	FRewindPhysicsRecorderCallback* Callback = nullptr;
+};
@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindPoseTimeline.h"
+
+#include "Algo/BinarySearch.h"
+
+namespace RewindPose
+{
+	FRotationTrackPolicy::FKey FRotationTrackPolicy::MakeKey(uint32 Frame, const FValue& Value)
+	{
+		FKey Key;
+		Key.Frame = Frame;
+		Key.Components[0] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Value.X, -1.0f, 1.0f) * MAX_int16));
+		Key.Components[1] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Value.Y, -1.0f, 1.0f) * MAX_int16));
+		Key.Components[2] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Value.Z, -1.0f, 1.0f) * MAX_int16));
+		Key.Components[3] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(Value.W, -1.0f, 1.0f) * MAX_int16));
+		return Key;
+	}
+
+	FRotationTrackPolicy::FValue FRotationTrackPolicy::GetValue(const FKey& Key)
+	{
+		// Left unnormalized, so keys placed on the line between two others rebuild the frames around them exactly
+		constexpr float Scale = 1.0f / MAX_int16;
+		return FQuat4f(Key.Components[0] * Scale, Key.Components[1] * Scale, Key.Components[2] * Scale, Key.Components[3] * Scale);
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::Add(uint32 Frame, const FValue& Value, float ComponentTolerance, int32 MaxKeyGap)
+	{
+		if (Keys.Num() == FirstKey)
+		{
+			AddKey(Frame, Value);
+			return;
+		}
+
+		// Check the frames since the last key can still be rebuilt by interpolating up to the new value
+		FValue AlignedValue = PolicyType::Align(LastKeyValue, Value);
+		uint32 Distance = Frame - Keys.Last().Frame;
+		bool bNeedsKey = NewestFrame != Keys.Last().Frame && Distance > static_cast<uint32>(MaxKeyGap);
+		for (int32 Index = 0; Index < PolicyType::NumComponents && !bNeedsKey; ++Index)
+		{
+			const float Slope = (PolicyType::GetComponent(AlignedValue, Index) - PolicyType::GetComponent(LastKeyValue, Index)) / Distance;
+			bNeedsKey = Slope < MinSlopes[Index] || Slope > MaxSlopes[Index];
+		}
+
+		if (bNeedsKey)
+		{
+			// The previous frame was the last one that could be reached within tolerance, so it becomes the key
+			AddKey(Frame - 1, NewestValue);
+			AlignedValue = PolicyType::Align(LastKeyValue, Value);
+			Distance = 1;
+		}
+
+		// Only slopes that also rebuild this frame within tolerance remain, which includes the slope to this frame itself
+		NewestFrame = Frame;
+		NewestValue = AlignedValue;
+		for (int32 Index = 0; Index < PolicyType::NumComponents; ++Index)
+		{
+			const float Offset = PolicyType::GetComponent(AlignedValue, Index) - PolicyType::GetComponent(LastKeyValue, Index);
+			MinSlopes[Index] = FMath::Max(MinSlopes[Index], (Offset - ComponentTolerance) / Distance);
+			MaxSlopes[Index] = FMath::Min(MaxSlopes[Index], (Offset + ComponentTolerance) / Distance);
+		}
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::AddKey(uint32 Frame, const FValue& Value)
+	{
+		Keys.Add(PolicyType::MakeKey(Frame, Value));
+		BeginSpan();
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::BeginSpan()
+	{
+		LastKeyValue = PolicyType::GetValue(Keys.Last());
+		NewestFrame = Keys.Last().Frame;
+		NewestValue = LastKeyValue;
+		for (int32 Index = 0; Index < PolicyType::NumComponents; ++Index)
+		{
+			MinSlopes[Index] = -MAX_flt;
+			MaxSlopes[Index] = MAX_flt;
+		}
+	}
+
+	template <typename PolicyType>
+	typename TTrack<PolicyType>::FValue TTrack<PolicyType>::SampleLinear(uint32 Frame) const
+	{
+		check(Keys.Num() > FirstKey);
+
+		const FKey& LastKey = Keys.Last();
+		if (Frame >= LastKey.Frame)
+		{
+			if (NewestFrame == LastKey.Frame) { return LastKeyValue; }
+			const float Alpha = FMath::Min(static_cast<float>(Frame - LastKey.Frame) / (NewestFrame - LastKey.Frame), 1.0f);
+			return PolicyType::Interpolate(LastKeyValue, NewestValue, Alpha);
+		}
+
+		// Find the last key at or before the frame, starting from where the previous sample left off
+		int32 KeyIndex = FMath::Clamp(SampleHint, FirstKey, Keys.Num() - 2);
+		if (Keys[KeyIndex].Frame > Frame || Keys[KeyIndex + 1].Frame <= Frame)
+		{
+			const int32 Step = Keys[KeyIndex].Frame > Frame ? -1 : 1;
+			if (KeyIndex + Step >= FirstKey && Keys[KeyIndex + Step].Frame <= Frame && Keys[KeyIndex + Step + 1].Frame > Frame)
+			{
+				KeyIndex += Step;
+			}
+			else
+			{
+				const TArrayView<const FKey> LiveKeys = TArrayView<const FKey>(Keys).RightChop(FirstKey);
+				KeyIndex = FMath::Max(FirstKey + Algo::UpperBoundBy(LiveKeys, Frame, &FKey::Frame) - 1, FirstKey);
+			}
+		}
+		SampleHint = KeyIndex;
+
+		const FKey& Key = Keys[KeyIndex];
+		const FKey& NextKey = Keys[KeyIndex + 1];
+		if (Frame <= Key.Frame) { return PolicyType::GetValue(Key); }
+
+		const float Alpha = static_cast<float>(Frame - Key.Frame) / (NextKey.Frame - Key.Frame);
+		return PolicyType::Interpolate(PolicyType::GetValue(Key), PolicyType::GetValue(NextKey), Alpha);
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::PopFront(uint32 FirstFrame)
+	{
+		// Keep the last key at or before the first frame; it is still needed to interpolate up to the next one
+		while (FirstKey + 1 < Keys.Num() && Keys[FirstKey + 1].Frame <= FirstFrame) { ++FirstKey; }
+
+		// Compact once released keys make up most of the array so popping stays amortized constant time
+		if (FirstKey > 64 && FirstKey > Keys.Num() / 2)
+		{
+			Keys.RemoveAt(0, FirstKey, false);
+			SampleHint = FMath::Max(SampleHint - FirstKey, 0);
+			FirstKey = 0;
+		}
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::Truncate(uint32 LastFrame)
+	{
+		if (Keys.Num() == FirstKey || LastFrame >= NewestFrame) { return; }
+
+		// Frames after the last key lie on the line to the newest frame, so moving the newest frame back along that line
+		// leaves them as they were; the slope bounds still hold for them, as they were narrowed by their recorded values
+		const FValue Value = SampleLinear(LastFrame);
+		if (LastFrame >= Keys.Last().Frame)
+		{
+			NewestFrame = LastFrame;
+			NewestValue = Value;
+			return;
+		}
+
+		// Otherwise the frame lies on the line between two keys, so keying it rebuilds the frames before it exactly as before;
+		// the first live key is at or before the oldest frame, so it is never removed
+		while (Keys.Num() > FirstKey + 1 && Keys.Last().Frame > LastFrame) { Keys.Pop(false); }
+		if (Keys.Last().Frame < LastFrame) { Keys.Add(PolicyType::MakeKey(LastFrame, Value)); }
+		BeginSpan();
+	}
+
+	template <typename PolicyType>
+	void TTrack<PolicyType>::Empty()
+	{
+		Keys.Reset();
+		FirstKey = 0;
+		SampleHint = 0;
+	}
+
+	template class TTrack<FRotationTrackPolicy>;
+	template class TTrack<FVectorTrackPolicy>;
+} // namespace RewindPose
+
+void FRewindPoseTimeline::Initialize(int32 InNumBones, float RotationToleranceDegrees, float InTranslationTolerance, int32 InMaxKeyGap)
+{
+	Bones.Reset();
+	Bones.SetNum(InNumBones);
+	FirstFrame = 0;
+	NumFrames = 0;
+	RotationTolerance = RewindPose::FRotationTrackPolicy::GetComponentTolerance(
+		FMath::Cos(FMath::DegreesToRadians(FMath::Max(RotationToleranceDegrees, 0.0f)) * 0.5f));
+	TranslationTolerance = RewindPose::FVectorTrackPolicy::GetComponentTolerance(FMath::Max(InTranslationTolerance, 0.0f));
+	ScaleTolerance = RewindPose::FVectorTrackPolicy::GetComponentTolerance(ScaleDistanceTolerance);
+	MaxKeyGap = FMath::Max(InMaxKeyGap, 1);
+}
+
+void FRewindPoseTimeline::Add(TArrayView<const FTransform> BoneSpaceTransforms)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPoseTimeline::Add);
+
+	check(BoneSpaceTransforms.Num() == Bones.Num());
+
+	const uint32 Frame = FirstFrame + NumFrames;
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		const FTransform& Transform = BoneSpaceTransforms[BoneIndex];
+		FBoneTracks& Tracks = Bones[BoneIndex];
+		Tracks.Rotation.Add(Frame, FQuat4f(Transform.GetRotation()), RotationTolerance, MaxKeyGap);
+		Tracks.Translation.Add(Frame, FVector3f(Transform.GetTranslation()), TranslationTolerance, MaxKeyGap);
+		Tracks.Scale.Add(Frame, FVector3f(Transform.GetScale3D()), ScaleTolerance, MaxKeyGap);
+	}
+	++NumFrames;
+}
+
+void FRewindPoseTimeline::PopFront()
+{
+	check(NumFrames > 0);
+
+	++FirstFrame;
+	--NumFrames;
+	if (NumFrames == 0)
+	{
+		Empty();
+		return;
+	}
+
+	for (FBoneTracks& Tracks : Bones)
+	{
+		Tracks.Rotation.PopFront(FirstFrame);
+		Tracks.Translation.PopFront(FirstFrame);
+		Tracks.Scale.PopFront(FirstFrame);
+	}
+}
+
+void FRewindPoseTimeline::Truncate(int32 Count)
+{
+	if (Count >= NumFrames) { return; }
+	if (Count <= 0)
+	{
+		Empty();
+		return;
+	}
+
+	NumFrames = Count;
+	const uint32 LastFrame = FirstFrame + NumFrames - 1;
+	for (FBoneTracks& Tracks : Bones)
+	{
+		Tracks.Rotation.Truncate(LastFrame);
+		Tracks.Translation.Truncate(LastFrame);
+		Tracks.Scale.Truncate(LastFrame);
+	}
+}
+
+void FRewindPoseTimeline::Empty()
+{
+	for (FBoneTracks& Tracks : Bones)
+	{
+		Tracks.Rotation.Empty();
+		Tracks.Translation.Empty();
+		Tracks.Scale.Empty();
+	}
+	FirstFrame += NumFrames;
+	NumFrames = 0;
+}
+
+void FRewindPoseTimeline::Sample(int32 IndexA, int32 IndexB, float Alpha, TArray<FTransform>& OutBoneSpaceTransforms) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPoseTimeline::Sample);
+
+	check(IndexA >= 0 && IndexA < NumFrames && IndexB >= 0 && IndexB < NumFrames);
+
+	OutBoneSpaceTransforms.SetNumUninitialized(Bones.Num(), false);
+	const uint32 FrameA = FirstFrame + IndexA;
+	const uint32 FrameB = FirstFrame + IndexB;
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		const FTransform TransformA = SampleBone(Bones[BoneIndex], FrameA);
+		if (FrameA == FrameB)
+		{
+			OutBoneSpaceTransforms[BoneIndex] = TransformA;
+			continue;
+		}
+
+		OutBoneSpaceTransforms[BoneIndex].Blend(TransformA, SampleBone(Bones[BoneIndex], FrameB), Alpha);
+	}
+}
+
+SIZE_T FRewindPoseTimeline::GetAllocatedSize() const
+{
+	SIZE_T Size = Bones.GetAllocatedSize();
+	for (const FBoneTracks& Tracks : Bones)
+	{
+		Size += Tracks.Rotation.GetAllocatedSize() + Tracks.Translation.GetAllocatedSize() + Tracks.Scale.GetAllocatedSize();
+	}
+	return Size;
+}
+
+FTransform FRewindPoseTimeline::SampleBone(const FBoneTracks& Tracks, uint32 Frame) const
+{
+	return FTransform(
+		FQuat(Tracks.Rotation.Sample(Frame)),
+		FVector(Tracks.Translation.Sample(Frame)),
+		FVector(Tracks.Scale.Sample(Frame)));
+}
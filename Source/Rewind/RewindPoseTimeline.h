@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace RewindPose
+{
+	// Rotations are quantized to 16 bits per component and interpolated linearly, then normalized
+	struct FRotationTrackPolicy
+	{
+		using FValue = FQuat4f;
+
+		static constexpr int32 NumComponents = 4;
+
+		struct FKey
+		{
+			uint32 Frame = 0;
+			int16 Components[4] = { 0, 0, 0, 0 };
+		};
+
+		static FKey MakeKey(uint32 Frame, const FValue& Value);
+		static FValue GetValue(const FKey& Key);
+		static FValue Interpolate(const FValue& A, const FValue& B, float Alpha) { return A * (1.0f - Alpha) + B * Alpha; }
+		static FValue Resolve(const FValue& Value) { return Value.GetNormalized(); }
+		static float GetComponent(const FValue& Value, int32 Index)
+		{
+			return Index == 0 ? Value.X : Index == 1 ? Value.Y : Index == 2 ? Value.Z : Value.W;
+		}
+
+		// A quaternion and its negation are the same rotation; flipping values into the reference's hemisphere keeps
+		// interpolating between them on the shorter arc
+		static FValue Align(const FValue& Reference, const FValue& Value) { return (Reference | Value) < 0.0f ? Value * -1.0f : Value; }
+
+		// Tolerance is the cosine of half the allowed angle. Normalizing at most doubles the distance of an interpolated
+		// value from a unit quaternion, so a quarter of the allowed chord per component keeps the angle within tolerance
+		static float GetComponentTolerance(float Tolerance) { return FMath::Sqrt(FMath::Max(2.0f - 2.0f * Tolerance, 0.0f)) * 0.25f; }
+	};
+
+	// Translations and scales are stored at single precision and compared by distance
+	struct FVectorTrackPolicy
+	{
+		using FValue = FVector3f;
+
+		static constexpr int32 NumComponents = 3;
+
+		struct FKey
+		{
+			uint32 Frame = 0;
+			FVector3f Value = FVector3f::ZeroVector;
+		};
+
+		static FKey MakeKey(uint32 Frame, const FValue& Value) { return FKey{ Frame, Value }; }
+		static FValue GetValue(const FKey& Key) { return Key.Value; }
+		static FValue Interpolate(const FValue& A, const FValue& B, float Alpha) { return FMath::Lerp(A, B, Alpha); }
+		static FValue Resolve(const FValue& Value) { return Value; }
+		static float GetComponent(const FValue& Value, int32 Index) { return Value[Index]; }
+		static FValue Align(const FValue& Reference, const FValue& Value) { return Value; }
+
+		// Tolerance is a distance, which bounding each of three components by Tolerance / sqrt(3) keeps within
+		static float GetComponentTolerance(float Tolerance) { return Tolerance / FMath::Sqrt(3.0f); }
+	};
+
+	/**
+	 * Variable rate track for one channel of one bone.
+	 *
+	 * Frames are appended one at a time. Only keys and the newest frame are stored: frames after the last key are rebuilt by
+	 * interpolating from it to the newest frame. Each frame narrows the range of slopes from the last key that would still
+	 * rebuild it within tolerance, so checking a new frame against every frame since the last key is constant time; once the
+	 * slope to a new frame leaves that range, the previous frame becomes a key. Slow moving or static bones therefore
+	 * produce very few keys, while the error of any reconstructed frame stays bounded.
+	 */
+	template <typename PolicyType>
+	class TTrack
+	{
+	public:
+		using FValue = typename PolicyType::FValue;
+		using FKey = typename PolicyType::FKey;
+
+		// Appends the value of a frame; frames must be consecutive. ComponentTolerance is from PolicyType::GetComponentTolerance
+		void Add(uint32 Frame, const FValue& Value, float ComponentTolerance, int32 MaxKeyGap);
+
+		// Returns the value at a frame between the first key and the newest frame
+		FValue Sample(uint32 Frame) const { return PolicyType::Resolve(SampleLinear(Frame)); }
+
+		// Releases keys that are no longer needed to sample FirstFrame or later
+		void PopFront(uint32 FirstFrame);
+
+		// Removes all frames after LastFrame; earlier frames are reconstructed exactly as before
+		void Truncate(uint32 LastFrame);
+
+		void Empty();
+
+		SIZE_T GetAllocatedSize() const { return Keys.GetAllocatedSize(); }
+
+	private:
+		// Returns the value at a frame before it is resolved; tracks interpolate linearly in this space
+		FValue SampleLinear(uint32 Frame) const;
+
+		// Appends a key, which is also the newest frame
+		void AddKey(uint32 Frame, const FValue& Value);
+
+		// Makes the last key the newest frame, from which any slope is allowed
+		void BeginSpan();
+
+		// Keys in frame order; keys before FirstKey have been released but not yet compacted
+		TArray<FKey> Keys;
+		int32 FirstKey = 0;
+
+		// Value of the last key as it is sampled, which can differ from the recorded value by its quantization
+		FValue LastKeyValue = FValue(ForceInit);
+
+		// Newest frame, whose value is in the last key's hemisphere; frames after the last key interpolate towards it
+		uint32 NewestFrame = 0;
+		FValue NewestValue = FValue(ForceInit);
+
+		// Per component range of slopes, in units per frame, from the last key that rebuild every frame since within tolerance
+		float MinSlopes[PolicyType::NumComponents] = {};
+		float MaxSlopes[PolicyType::NumComponents] = {};
+
+		// Cursor left by the previous sample; playback samples neighbouring frames so this usually avoids a search
+		mutable int32 SampleHint = 0;
+	};
+} // namespace RewindPose
+
+/**
+ * Timeline of bone space skeletal poses stored as quantized, per-bone variable rate tracks.
+ *
+ * Each recorded pose is one frame; frames are indexed like the other rewind timelines, from oldest to newest. Keys are
+ * reduced as frames are recorded, so memory grows with how much bones move rather than with how long history is.
+ */
+class REWIND_API FRewindPoseTimeline
+{
+public:
+	// Prepares tracks for NumBones bones; RotationToleranceDegrees and TranslationTolerance bound reconstruction error
+	void Initialize(int32 InNumBones, float RotationToleranceDegrees, float TranslationTolerance, int32 InMaxKeyGap);
+
+	int32 GetNumBones() const { return Bones.Num(); }
+
+	int32 Num() const { return NumFrames; }
+
+	// Appends a pose; must contain a transform for every bone
+	void Add(TArrayView<const FTransform> BoneSpaceTransforms);
+
+	// Removes the oldest pose
+	void PopFront();
+
+	// Keeps the oldest Count poses
+	void Truncate(int32 Count);
+
+	// Removes all poses
+	void Empty();
+
+	// Blends the poses at IndexA and IndexB into OutBoneSpaceTransforms
+	void Sample(int32 IndexA, int32 IndexB, float Alpha, TArray<FTransform>& OutBoneSpaceTransforms) const;
+
+	// Returns the bytes used by keys and pending frames
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FBoneTracks
+	{
+		RewindPose::TTrack<RewindPose::FRotationTrackPolicy> Rotation;
+		RewindPose::TTrack<RewindPose::FVectorTrackPolicy> Translation;
+		RewindPose::TTrack<RewindPose::FVectorTrackPolicy> Scale;
+	};
+
+	// Samples a single frame of one bone
+	FTransform SampleBone(const FBoneTracks& Tracks, uint32 Frame) const;
+
+	TArray<FBoneTracks> Bones;
+
+	// Frame number of the oldest pose; frame numbers keep increasing as poses are added and removed
+	uint32 FirstFrame = 0;
+	int32 NumFrames = 0;
+
+	// Per component tolerances of each channel's tracks
+	float RotationTolerance = 0.0f;
+	float TranslationTolerance = 0.0f;
+	float ScaleTolerance = 0.0f;
+
+	// Scale is rarely animated, so any change to it is keyed tightly
+	static constexpr float ScaleDistanceTolerance = 0.001f;
+
+	// Longest run of frames allowed between keys
+	int32 MaxKeyGap = 900;
+};
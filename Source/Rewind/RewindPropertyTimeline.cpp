@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindPropertyTimeline.h"
+
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Rewind.h"
+#include "UObject/UnrealType.h"
+
+namespace RewindPropertyTimeline
+{
+	template <typename ValueType>
+	void Lerp(const uint8* A, const uint8* B, float Alpha, uint8* Out)
+	{
+		*reinterpret_cast<ValueType*>(Out) =
+			FMath::Lerp(*reinterpret_cast<const ValueType*>(A), *reinterpret_cast<const ValueType*>(B), Alpha);
+	}
+
+	// Rotators blend along the shortest path rather than component by component
+	void LerpRotator(const uint8* A, const uint8* B, float Alpha, uint8* Out)
+	{
+		const FRotator& RotatorA = *reinterpret_cast<const FRotator*>(A);
+		const FRotator& RotatorB = *reinterpret_cast<const FRotator*>(B);
+		*reinterpret_cast<FRotator*>(Out) = RotatorA + (RotatorB - RotatorA).GetNormalized() * Alpha;
+	}
+
+	// Returns the object a path's first name refers to when it names a component rather than a property of the owner
+	UObject* FindComponentByName(AActor& Owner, FName Name)
+	{
+		for (UActorComponent* Component : Owner.GetComponents())
+		{
+			if (Component && Component->GetFName() == Name) { return Component; }
+		}
+		return nullptr;
+	}
+} // namespace RewindPropertyTimeline
+
+void FRewindPropertyTimeline::Compile(AActor& Owner, TConstArrayView<FString> PropertyPaths, int32 InCapacity)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPropertyTimeline::Compile);
+
+	Entries.Reset();
+	Containers.Reset();
+	for (const FString& PropertyPath : PropertyPaths)
+	{
+		TArray<FString> Names;
+		PropertyPath.ParseIntoArray(Names, TEXT("."));
+		if (Names.Num() == 0) { continue; }
+
+		// Walk the path, following object properties into other objects and struct properties into their members
+		UObject* Container = &Owner;
+		const UStruct* Struct = Owner.GetClass();
+		int32 Offset = 0;
+		int32 NameIndex = 0;
+		if (!FindFProperty<FProperty>(Struct, *Names[0]))
+		{
+			Container = RewindPropertyTimeline::FindComponentByName(Owner, *Names[0]);
+			Struct = Container ? Container->GetClass() : nullptr;
+			NameIndex = 1;
+		}
+
+		FProperty* Property = nullptr;
+		for (; Struct && NameIndex < Names.Num(); ++NameIndex)
+		{
+			Property = FindFProperty<FProperty>(Struct, *Names[NameIndex]);
+			if (!Property || NameIndex == Names.Num() - 1) { break; }
+
+			if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				Offset += StructProperty->GetOffset_ForInternal();
+				Struct = StructProperty->Struct;
+			}
+			else if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+			{
+				const uint8* ObjectPointer = reinterpret_cast<uint8*>(Container) + Offset + ObjectProperty->GetOffset_ForInternal();
+				Container = ObjectProperty->GetObjectPropertyValue(ObjectPointer);
+				Struct = Container ? Container->GetClass() : nullptr;
+				Offset = 0;
+			}
+			else { Struct = nullptr; }
+		}
+		if (!Struct || !Property || NameIndex != Names.Num() - 1)
+		{
+			UE_LOG(LogRewind, Warning, TEXT("%s: rewound property %s not found"), *Owner.GetName(), *PropertyPath);
+			continue;
+		}
+
+		FEntry Entry;
+		Entry.Offset = Offset + Property->GetOffset_ForInternal();
+		Entry.Size = Property->GetSize();
+		const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+		if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+		{
+			// Bitfield bools share their byte with other flags, which must be left alone
+			Entry.Offset += BoolProperty->GetByteOffset();
+			Entry.Size = 1;
+			Entry.Mask = BoolProperty->GetFieldMask();
+		}
+		else if (Property->IsA<FFloatProperty>()) { Entry.Blend = &RewindPropertyTimeline::Lerp<float>; }
+		else if (Property->IsA<FDoubleProperty>()) { Entry.Blend = &RewindPropertyTimeline::Lerp<double>; }
+		else if (StructProperty && (StructProperty->Struct->StructFlags & STRUCT_IsPlainOldData))
+		{
+			// Other plain old data structs step
+			const UScriptStruct* ValueStruct = StructProperty->Struct;
+			if (ValueStruct == TBaseStructure<FVector>::Get()) { Entry.Blend = &RewindPropertyTimeline::Lerp<FVector>; }
+			else if (ValueStruct == TBaseStructure<FVector2D>::Get()) { Entry.Blend = &RewindPropertyTimeline::Lerp<FVector2D>; }
+			else if (ValueStruct == TBaseStructure<FLinearColor>::Get()) { Entry.Blend = &RewindPropertyTimeline::Lerp<FLinearColor>; }
+			else if (ValueStruct == TBaseStructure<FRotator>::Get()) { Entry.Blend = &RewindPropertyTimeline::LerpRotator; }
+		}
+		else if (!Property->IsA<FNumericProperty>() && !Property->IsA<FEnumProperty>() && !Property->IsA<FNameProperty>())
+		{
+			UE_LOG(LogRewind, Warning, TEXT("%s: rewound property %s is not plain data"), *Owner.GetName(), *PropertyPath);
+			continue;
+		}
+
+		// Static arrays are stepped as a whole
+		if (Property->ArrayDim > 1) { Entry.Blend = nullptr; }
+
+		Entry.ContainerIndex = Containers.AddUnique(Container);
+		Entries.Add(Entry);
+	}
+
+	// Gather in memory order, packing each value at its natural alignment so blends can read records in place
+	Entries.Sort(
+		[](const FEntry& A, const FEntry& B)
+		{ return A.ContainerIndex != B.ContainerIndex ? A.ContainerIndex < B.ContainerIndex : A.Offset < B.Offset; });
+	RecordSize = 0;
+	for (FEntry& Entry : Entries)
+	{
+		Entry.RecordOffset = Align(RecordSize, FMath::RoundUpToPowerOfTwo(FMath::Min(Entry.Size, 8)));
+		RecordSize = Entry.RecordOffset + Entry.Size;
+	}
+	RecordSize = Align(RecordSize, 8);
+
+	Capacity = FMath::Max(InCapacity, 1);
+	Records.SetNumZeroed(Entries.Num() > 0 ? Capacity * RecordSize : 0);
+	Head = 0;
+	NumFrames = 0;
+}
+
+void FRewindPropertyTimeline::Record()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPropertyTimeline::Record);
+
+	check(Capacity > 0);
+
+	// Claim the next slot, overwriting the oldest frame if the buffer is full
+	if (NumFrames == Capacity) { PopFront(); }
+	uint8* Record = GetRecord(NumFrames);
+	++NumFrames;
+
+	const uint8* Container = nullptr;
+	int32 ContainerIndex = INDEX_NONE;
+	for (const FEntry& Entry : Entries)
+	{
+		if (Entry.ContainerIndex != ContainerIndex)
+		{
+			ContainerIndex = Entry.ContainerIndex;
+			Container = reinterpret_cast<const uint8*>(Containers[ContainerIndex].Get());
+		}
+
+		// Values of destroyed containers are never applied, so their bytes only need to be deterministic
+		if (Container) { FMemory::Memcpy(Record + Entry.RecordOffset, Container + Entry.Offset, Entry.Size); }
+		else { FMemory::Memzero(Record + Entry.RecordOffset, Entry.Size); }
+	}
+}
+
+void FRewindPropertyTimeline::PopFront()
+{
+	check(NumFrames > 0);
+
+	Head = (Head + 1) % Capacity;
+	--NumFrames;
+}
+
+void FRewindPropertyTimeline::Truncate(int32 Count)
+{
+	NumFrames = FMath::Clamp(Count, 0, NumFrames);
+}
+
+void FRewindPropertyTimeline::Empty()
+{
+	Head = 0;
+	NumFrames = 0;
+}
+
+void FRewindPropertyTimeline::Apply(int32 IndexA, int32 IndexB, float Alpha) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindPropertyTimeline::Apply);
+
+	if (NumFrames == 0) { return; }
+
+	const uint8* RecordA = GetRecord(IndexA);
+	const uint8* RecordB = GetRecord(IndexB);
+	const uint8* NearestRecord = Alpha < 0.5f ? RecordA : RecordB;
+	const bool bBlend = IndexA != IndexB;
+	uint8* Container = nullptr;
+	int32 ContainerIndex = INDEX_NONE;
+	for (const FEntry& Entry : Entries)
+	{
+		if (Entry.ContainerIndex != ContainerIndex)
+		{
+			ContainerIndex = Entry.ContainerIndex;
+			Container = reinterpret_cast<uint8*>(Containers[ContainerIndex].Get());
+		}
+		if (!Container) { continue; }
+
+		uint8* Value = Container + Entry.Offset;
+		if (Entry.Mask != 0xFF) { *Value = (*Value & ~Entry.Mask) | (NearestRecord[Entry.RecordOffset] & Entry.Mask); }
+		else if (bBlend && Entry.Blend) { Entry.Blend(RecordA + Entry.RecordOffset, RecordB + Entry.RecordOffset, Alpha, Value); }
+		else { FMemory::Memcpy(Value, NearestRecord + Entry.RecordOffset, Entry.Size); }
+	}
+}
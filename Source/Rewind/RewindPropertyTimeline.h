@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/**
+ * Ring buffer of arbitrary properties of an actor and its components, such as health or a door's angle.
+ *
+ * Property paths are resolved through reflection once, into a flat plan of containers, offsets, sizes and blend
+ * functions. Recording is then a gather of raw bytes into one packed record per frame, and playback is the reverse
+ * scatter, with no reflection lookups after Compile. Only plain data properties can be rewound: numbers, bools, enums,
+ * names and plain old data structs such as FVector or FLinearColor.
+ */
+class REWIND_API FRewindPropertyTimeline
+{
+public:
+	/**
+	 * Resolves property paths on Owner into a copy plan, sizes the buffer for Capacity frames and discards any history.
+	 *
+	 * Paths are dot separated. The first name may be a property of the owner or the name of one of its components;
+	 * object properties are followed into the objects they reference, and struct properties into their members, so
+	 * "Health", "HealthComponent.Health" and "DoorState.OpenAngle" are all valid. Paths that can't be rewound are logged
+	 * and skipped.
+	 */
+	void Compile(AActor& Owner, TConstArrayView<FString> PropertyPaths, int32 InCapacity);
+
+	// Returns whether any property will be recorded
+	bool HasProperties() const { return Entries.Num() > 0; }
+
+	int32 Num() const { return NumFrames; }
+
+	// Gathers every property into a new frame, overwriting the oldest frame when full
+	void Record();
+
+	// Removes the oldest frame
+	void PopFront();
+
+	// Keeps the oldest Count frames
+	void Truncate(int32 Count);
+
+	// Removes all frames
+	void Empty();
+
+	// Writes the blend of two frames back to every property
+	void Apply(int32 IndexA, int32 IndexB, float Alpha) const;
+
+	SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize() + Containers.GetAllocatedSize() + Records.GetAllocatedSize(); }
+
+private:
+	// Writes the blend of two recorded values of Size bytes to Out
+	using FBlendFunction = void (*)(const uint8* A, const uint8* B, float Alpha, uint8* Out);
+
+	struct FEntry
+	{
+		// Index of the object holding the property in Containers
+		int32 ContainerIndex = INDEX_NONE;
+
+		// Byte offset of the value within the container, and within each record
+		int32 Offset = 0;
+		int32 RecordOffset = 0;
+		int32 Size = 0;
+
+		// Bits of the byte that hold the value, for bitfield bools; 0xFF for everything else
+		uint8 Mask = 0xFF;
+
+		// Blends values; null for values that step from one frame to the next
+		FBlendFunction Blend = nullptr;
+	};
+
+	int32 GetSlot(int32 Index) const { return (Head + Index) % Capacity; }
+
+	uint8* GetRecord(int32 Index) { return Records.GetData() + GetSlot(Index) * RecordSize; }
+	const uint8* GetRecord(int32 Index) const { return Records.GetData() + GetSlot(Index) * RecordSize; }
+
+	// Copy plan, ordered by container and then offset so gathers walk memory forwards
+	TArray<FEntry> Entries;
+	TArray<TWeakObjectPtr<UObject>> Containers;
+
+	// Packed values of every property, one record per frame
+	TArray<uint8> Records;
+	int32 RecordSize = 0;
+
+	// Ring of records; Head is the slot of the oldest frame
+	int32 Capacity = 0;
+	int32 Head = 0;
+	int32 NumFrames = 0;
+};
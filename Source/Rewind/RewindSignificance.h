@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RewindSignificance.generated.h"
+
+// How much a rewindable actor matters to the player; lower tiers trade rewind fidelity for cost
+UENUM(BlueprintType)
+enum class ERewindSignificance : uint8
+{
+	// Close to the view, visible or tagged as important; records and plays back at full rate
+	High,
+
+	// Far from the view or out of sight
+	Medium,
+
+	// Far from the view and out of sight
+	Low,
+};
+
+// Settings for a reduced significance tier
+USTRUCT(BlueprintType)
+struct FRewindSignificanceTierSettings
+{
+	GENERATED_BODY();
+
+	// Actors at least this far from the view are placed in this tier
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind", meta = (ClampMin = "0.0"))
+	float MinDistance = 0.0f;
+
+	// Snapshots are recorded this many times less often than the component's snapshot frequency
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind", meta = (ClampMin = "1"))
+	int32 RecordRateDivisor = 1;
+
+	// Playback is applied once every this many frames, catching up on the time skipped in between
+	UPROPERTY(EditDefaultsOnly, Category = "Rewind", meta = (ClampMin = "1"))
+	int32 PlaybackFrameInterval = 1;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Engine/EngineTypes.h"
+
+#include "RewindSnapshots.generated.h"
+
+// Parts of a transform and velocity snapshot that can be recorded and applied independently
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ERewindSnapshotChannels : uint8
+{
+	None = 0 UMETA(Hidden),
+	Location = 1 << 0,
+	Rotation = 1 << 1,
+	Scale = 1 << 2,
+	LinearVelocity = 1 << 3,
+	AngularVelocity = 1 << 4,
+	Transform = Location | Rotation | Scale UMETA(Hidden),
+	Velocity = LinearVelocity | AngularVelocity UMETA(Hidden),
+	All = Transform | Velocity UMETA(Hidden),
+};
+ENUM_CLASS_FLAGS(ERewindSnapshotChannels);
+
+// State snapshots used when rewinding transforms and velocity
+USTRUCT()
+struct FTransformAndVelocitySnapshot
+{
+	GENERATED_BODY();
+
+	// Time since the last snapshot was recorded
+	UPROPERTY(Transient)
+	float TimeSinceLastSnapshot = 0.0f;
+
+	// Transform at time snapshot was recorded
+	UPROPERTY(Transient)
+	FTransform Transform{ FVector::ZeroVector };
+
+	// Linear velocity from the owner's root primitive component at time snapshot was recorded
+	UPROPERTY(Transient)
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	// Angular velocity from the owner's root primitive component at time snapshot was recorded
+	UPROPERTY(Transient)
+	FVector AngularVelocityInRadians = FVector::ZeroVector;
+
+	// Whether the owner's root body was asleep at time snapshot was recorded
+	UPROPERTY(Transient)
+	bool bIsSleeping = false;
+};
+
+// State snapshots used when rewinding movement; movement mode only changes now and then, so its changes are recorded on
+// the world's event track instead
+USTRUCT()
+struct FMovementVelocityAndModeSnapshot
+{
+	GENERATED_BODY();
+
+	// Time since the last snapshot was recorded
+	UPROPERTY(Transient)
+	float TimeSinceLastSnapshot = 0.0f;
+
+	// Movement velocity from the owner's movement component at time snapshot was recorded
+	UPROPERTY(Transient)
+	FVector MovementVelocity = FVector::ZeroVector;
+};
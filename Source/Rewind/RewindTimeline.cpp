@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindTimeline.h"
+
+namespace RewindTimeline
+{
+	// Writes planar streams of one float per sample, after a header flagging which streams vary within the page
+	// Streams holding the same value in every sample, such as the scale of most actors or the velocity of bodies that don't
+	// simulate, are stored as that value alone, so invariant parts of a snapshot cost a few bytes per page
+	template <typename SampleType>
+	class TStreamWriter
+	{
+	public:
+		TStreamWriter(TArrayView<const SampleType> InSamples, TArray<uint8>& InBytes)
+			: Samples(InSamples)
+			, Bytes(InBytes)
+			, HeaderOffset(InBytes.AddZeroed(sizeof(uint32)))
+		{
+		}
+
+		template <typename GetterType>
+		void WriteStream(GetterType&& Getter)
+		{
+			check(NumStreams < 32);
+			const int32 Offset = Bytes.AddUninitialized(Samples.Num() * sizeof(float));
+			float* Stream = reinterpret_cast<float*>(Bytes.GetData() + Offset);
+			bool bVaries = false;
+			for (int32 Index = 0; Index < Samples.Num(); ++Index)
+			{
+				Stream[Index] = static_cast<float>(Getter(Samples[Index]));
+				bVaries |= Stream[Index] != Stream[0];
+			}
+
+			if (bVaries) { VaryingStreams |= 1u << NumStreams; }
+			else { Bytes.SetNum(Offset + FMath::Min<int32>(Samples.Num(), 1) * sizeof(float), false); }
+			FMemory::Memcpy(Bytes.GetData() + HeaderOffset, &VaryingStreams, sizeof(uint32));
+			++NumStreams;
+		}
+
+		// Appends one byte per sample
+		template <typename GetterType>
+		void WriteBytes(GetterType&& Getter)
+		{
+			for (const SampleType& Sample : Samples) { Bytes.Add(static_cast<uint8>(Getter(Sample))); }
+		}
+
+	private:
+		TArrayView<const SampleType> Samples;
+		TArray<uint8>& Bytes;
+		int32 HeaderOffset = 0;
+		uint32 VaryingStreams = 0;
+		int32 NumStreams = 0;
+	};
+
+	// Reads streams written by TStreamWriter in the order they were written
+	class FStreamReader
+	{
+	public:
+		FStreamReader(TArrayView<const uint8> InBytes, int32 InNumSamples)
+			: Bytes(InBytes)
+			, NumSamples(InNumSamples)
+		{
+			if (Bytes.Num() >= int32(sizeof(uint32)))
+			{
+				FMemory::Memcpy(&VaryingStreams, Bytes.GetData(), sizeof(uint32));
+				Offset = sizeof(uint32);
+			}
+		}
+
+		template <typename SetterType>
+		void ReadStream(SetterType&& Setter)
+		{
+			const bool bVaries = (VaryingStreams & (1u << NumStreams++)) != 0;
+			const int32 Stride = bVaries ? sizeof(float) : 0;
+			const int32 StreamBytes = (bVaries ? NumSamples : FMath::Min(NumSamples, 1)) * sizeof(float);
+			if (Offset == 0 || Offset + StreamBytes > Bytes.Num()) { return; }
+
+			for (int32 Index = 0; Index < NumSamples; ++Index)
+			{
+				float Value;
+				FMemory::Memcpy(&Value, Bytes.GetData() + Offset + Index * Stride, sizeof(float));
+				Setter(Index, Value);
+			}
+			Offset += StreamBytes;
+		}
+
+		// Reads one byte per sample
+		template <typename SetterType>
+		void ReadBytes(SetterType&& Setter)
+		{
+			for (int32 Index = 0; Index < NumSamples && Offset > 0 && Offset < Bytes.Num(); ++Index, ++Offset)
+			{
+				Setter(Index, Bytes[Offset]);
+			}
+		}
+
+	private:
+		TArrayView<const uint8> Bytes;
+		int32 NumSamples = 0;
+		int32 Offset = 0;
+		uint32 VaryingStreams = 0;
+		int32 NumStreams = 0;
+	};
+
+	// Epoch readers are currently pinning; data retired during an epoch is freed once readers of that epoch drain
+	std::atomic<uint64> ReadEpoch{ 1 };
+
+	// Number of readers pinning even and odd epochs
+	std::atomic<int32> NumEpochReaders[2];
+
+	// Deleters for data retired during even and odd epochs; game thread only
+	TArray<TUniqueFunction<void()>> RetiredData[2];
+} // namespace RewindTimeline
+
+uint64 FRewindReadEpoch::Enter()
+{
+	using namespace RewindTimeline;
+
+	for (;;)
+	{
+		const uint64 Epoch = ReadEpoch.load();
+		NumEpochReaders[Epoch & 1].fetch_add(1);
+
+		// If the epoch advanced before the pin was visible, the game thread may not have waited for us
+		if (ReadEpoch.load() == Epoch) { return Epoch; }
+		NumEpochReaders[Epoch & 1].fetch_sub(1);
+	}
+}
+
+void FRewindReadEpoch::Exit(uint64 Epoch)
+{
+	RewindTimeline::NumEpochReaders[Epoch & 1].fetch_sub(1);
+}
+
+void FRewindReadEpoch::Retire(TUniqueFunction<void()>&& Deleter)
+{
+	check(IsInGameThread());
+	RewindTimeline::RetiredData[RewindTimeline::ReadEpoch.load() & 1].Add(MoveTemp(Deleter));
+}
+
+void FRewindReadEpoch::Reclaim()
+{
+	using namespace RewindTimeline;
+
+	check(IsInGameThread());
+
+	// Data retired during the previous epoch was unpublished before the current epoch began, so only readers that pinned
+	// the previous epoch can still observe it
+	const uint64 Epoch = ReadEpoch.load();
+	const int32 PreviousParity = (Epoch - 1) & 1;
+	if (NumEpochReaders[PreviousParity].load() != 0) { return; }
+
+	for (TUniqueFunction<void()>& Deleter : RetiredData[PreviousParity]) { Deleter(); }
+	RetiredData[PreviousParity].Reset();
+
+	// Start a new epoch so data retired during this one becomes reclaimable once its readers drain
+	if (RetiredData[Epoch & 1].Num() > 0) { ReadEpoch.store(Epoch + 1); }
+}
+
+void TRewindTimelineCodec<FTransformAndVelocitySnapshot>::Encode(
+	TArrayView<const FTransformAndVelocitySnapshot> Samples,
+	TArray<uint8>& OutBytes)
+{
+	using FSnapshot = FTransformAndVelocitySnapshot;
+	OutBytes.Reserve(OutBytes.Num() + Samples.Num() * sizeof(float) * 20);
+
+	RewindTimeline::TStreamWriter<FSnapshot> Writer(Samples, OutBytes);
+	Writer.WriteStream([](const FSnapshot& S) { return S.TimeSinceLastSnapshot; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Writer.WriteStream([Axis](const FSnapshot& S) { return S.Transform.GetTranslation()[Axis]; });
+	}
+	Writer.WriteStream([](const FSnapshot& S) { return S.Transform.GetRotation().X; });
+	Writer.WriteStream([](const FSnapshot& S) { return S.Transform.GetRotation().Y; });
+	Writer.WriteStream([](const FSnapshot& S) { return S.Transform.GetRotation().Z; });
+	Writer.WriteStream([](const FSnapshot& S) { return S.Transform.GetRotation().W; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Writer.WriteStream([Axis](const FSnapshot& S) { return S.Transform.GetScale3D()[Axis]; });
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Writer.WriteStream([Axis](const FSnapshot& S) { return S.LinearVelocity[Axis]; });
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Writer.WriteStream([Axis](const FSnapshot& S) { return S.AngularVelocityInRadians[Axis]; });
+	}
+	Writer.WriteBytes([](const FSnapshot& S) { return S.bIsSleeping ? 1 : 0; });
+}
+
+void TRewindTimelineCodec<FTransformAndVelocitySnapshot>::Decode(
+	TArrayView<const uint8> Bytes,
+	int32 NumSamples,
+	TArray<FTransformAndVelocitySnapshot>& OutSamples)
+{
+	OutSamples.SetNum(NumSamples);
+
+	// Decode into plain vectors first since FTransform only exposes whole-component setters
+	TArray<FVector> Translations, Scales;
+	TArray<FQuat> Rotations;
+	Translations.SetNumZeroed(NumSamples);
+	Scales.SetNumZeroed(NumSamples);
+	Rotations.SetNumZeroed(NumSamples);
+
+	RewindTimeline::FStreamReader Reader(Bytes, NumSamples);
+	Reader.ReadStream([&](int32 Index, float Value) { OutSamples[Index].TimeSinceLastSnapshot = Value; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Reader.ReadStream([&](int32 Index, float Value) { Translations[Index][Axis] = Value; });
+	}
+	Reader.ReadStream([&](int32 Index, float Value) { Rotations[Index].X = Value; });
+	Reader.ReadStream([&](int32 Index, float Value) { Rotations[Index].Y = Value; });
+	Reader.ReadStream([&](int32 Index, float Value) { Rotations[Index].Z = Value; });
+	Reader.ReadStream([&](int32 Index, float Value) { Rotations[Index].W = Value; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Reader.ReadStream([&](int32 Index, float Value) { Scales[Index][Axis] = Value; });
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Reader.ReadStream([&](int32 Index, float Value) { OutSamples[Index].LinearVelocity[Axis] = Value; });
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Reader.ReadStream([&](int32 Index, float Value) { OutSamples[Index].AngularVelocityInRadians[Axis] = Value; });
+	}
+	Reader.ReadBytes([&](int32 Index, uint8 Value) { OutSamples[Index].bIsSleeping = Value != 0; });
+
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		// Renormalize to remove error introduced by single precision storage
+		OutSamples[Index].Transform = FTransform(Rotations[Index].GetNormalized(), Translations[Index], Scales[Index]);
+	}
+}
+
+void TRewindTimelineCodec<FMovementVelocityAndModeSnapshot>::Encode(
+	TArrayView<const FMovementVelocityAndModeSnapshot> Samples,
+	TArray<uint8>& OutBytes)
+{
+	using FSnapshot = FMovementVelocityAndModeSnapshot;
+
+	RewindTimeline::TStreamWriter<FSnapshot> Writer(Samples, OutBytes);
+	Writer.WriteStream([](const FSnapshot& S) { return S.TimeSinceLastSnapshot; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Writer.WriteStream([Axis](const FSnapshot& S) { return S.MovementVelocity[Axis]; });
+	}
+}
+
+void TRewindTimelineCodec<FMovementVelocityAndModeSnapshot>::Decode(
+	TArrayView<const uint8> Bytes,
+	int32 NumSamples,
+	TArray<FMovementVelocityAndModeSnapshot>& OutSamples)
+{
+	OutSamples.SetNum(NumSamples);
+
+	RewindTimeline::FStreamReader Reader(Bytes, NumSamples);
+	Reader.ReadStream([&](int32 Index, float Value) { OutSamples[Index].TimeSinceLastSnapshot = Value; });
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Reader.ReadStream([&](int32 Index, float Value) { OutSamples[Index].MovementVelocity[Axis] = Value; });
+	}
+}
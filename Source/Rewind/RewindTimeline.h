@@ -0,0 +1,603 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Containers/RingBuffer.h"
+#include "RewindCompression.h"
+#include "RewindSnapshots.h"
+#include "Tasks/Task.h"
+
+#include <atomic>
+
+// Converts pages of samples to and from a compact byte layout before they are compressed
+// The default copies raw bytes; specialize for sample types that have a more compressible representation
+template <typename SampleType>
+struct TRewindTimelineCodec
+{
+	static void Encode(TArrayView<const SampleType> Samples, TArray<uint8>& OutBytes)
+	{
+		OutBytes.Append(reinterpret_cast<const uint8*>(Samples.GetData()), Samples.NumBytes());
+	}
+
+	static void Decode(TArrayView<const uint8> Bytes, int32 NumSamples, TArray<SampleType>& OutSamples)
+	{
+		OutSamples.SetNum(NumSamples);
+		FMemory::Memcpy(OutSamples.GetData(), Bytes.GetData(), FMath::Min<int64>(Bytes.Num(), OutSamples.NumBytes()));
+	}
+};
+
+// Transform snapshots are stored as planar single precision streams, which compress far better than interleaved doubles;
+// streams that don't vary within a page, such as an unscaled actor's scale or a kinematic actor's velocity, are stored once.
+// This is lossy: snapshots read back from compressed pages keep about seven significant digits, which is still better than
+// a millimetre within 10 km of the origin, but doesn't round trip double precision large world coordinates exactly
+template <>
+struct TRewindTimelineCodec<FTransformAndVelocitySnapshot>
+{
+	REWIND_API static void Encode(TArrayView<const FTransformAndVelocitySnapshot> Samples, TArray<uint8>& OutBytes);
+	REWIND_API static void Decode(TArrayView<const uint8> Bytes, int32 NumSamples, TArray<FTransformAndVelocitySnapshot>& OutSamples);
+};
+
+// Movement snapshots are stored as planar single precision streams, with the same loss of precision as transform snapshots
+template <>
+struct TRewindTimelineCodec<FMovementVelocityAndModeSnapshot>
+{
+	REWIND_API static void Encode(TArrayView<const FMovementVelocityAndModeSnapshot> Samples, TArray<uint8>& OutBytes);
+	REWIND_API static void Decode(TArrayView<const uint8> Bytes, int32 NumSamples, TArray<FMovementVelocityAndModeSnapshot>& OutSamples);
+};
+
+// Epoch based reclamation for timeline data shared with concurrent readers
+// Readers pin the current epoch while they use published data. The game thread retires data it replaces and only frees it
+// once every reader that could have observed it has unpinned its epoch, so readers never lock or touch reference counts.
+class REWIND_API FRewindReadEpoch
+{
+public:
+	// Pins the current epoch; safe to call from any thread
+	static uint64 Enter();
+
+	// Unpins an epoch returned by Enter; safe to call from any thread
+	static void Exit(uint64 Epoch);
+
+	// Runs Deleter once no reader can still observe the data it frees; game thread only
+	static void Retire(TUniqueFunction<void()>&& Deleter);
+
+	// Frees retired data whose readers have drained and advances the epoch; game thread only
+	static void Reclaim();
+};
+
+/**
+ * Paged replacement for TRingBuffer that stores snapshots for rewinding.
+ *
+ * Recording appends to raw pages exactly like a ring buffer. Pages that fall out of the raw window at the head of the
+ * timeline are compressed on worker threads and the raw copy is released once the compressed copy is swapped in. When
+ * the playhead approaches a compressed page it is decompressed on a worker thread ahead of time; accessing a page
+ * that is still compressed falls back to decompressing it on the calling thread. Compression goes through
+ * TRewindTimelineCodec, which may store samples at lower precision than they were recorded at.
+ *
+ * All methods must be called from the game thread; worker tasks only ever see immutable, shared copies of page data.
+ * Other threads read the timeline through FReader, which sees the window as of the latest Publish. Published windows
+ * share pages with the timeline; slots a reader may observe are never written in place, so recording, PopFront and Pop
+ * can continue while readers walk a consistent window without taking locks. Branches use the same mechanism to keep
+ * abandoned or checkpointed history around without copying it.
+ */
+template <typename SampleType, int32 PageSize = 64>
+class TRewindTimeline
+{
+	static_assert(PageSize > 0, "Pages must hold at least one sample");
+
+	using FSampleArray = TArray<SampleType>;
+	using FSampleArrayPtr = TSharedPtr<FSampleArray, ESPMode::ThreadSafe>;
+	using FByteArrayPtr = TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe>;
+
+	struct FPage
+	{
+		// Raw samples; null while the page is only held compressed
+		FSampleArrayPtr Samples;
+
+		// Compressed copy of Samples; null unless the page is full and unmodified since it was compressed
+		FByteArrayPtr Compressed;
+
+		// Size of the encoded samples before compression
+		int32 EncodedSize = 0;
+
+		// Incremented whenever Samples is modified so stale compression results can be discarded
+		uint32 Version = 0;
+
+		// Compression task in flight and the version of the samples it is compressing
+		UE::Tasks::TTask<TPair<FByteArrayPtr, int32>> CompressTask;
+		uint32 CompressTaskVersion = 0;
+
+		// Whether compressing the current version of Samples failed; the page stays raw until it is modified
+		bool bCompressionFailed = false;
+
+		// Decompression task in flight
+		UE::Tasks::TTask<FSampleArrayPtr> DecompressTask;
+
+		// Range of slots in Samples that readers or branches may observe; these are copied on write
+		int32 PublishedBegin = PageSize;
+		int32 PublishedEnd = 0;
+	};
+
+	// Immutable window of the timeline as seen by readers
+	struct FView
+	{
+		struct FPageView
+		{
+			FSampleArrayPtr Samples;
+			FByteArrayPtr Compressed;
+			int32 EncodedSize = 0;
+		};
+
+		TArray<FPageView> Pages;
+		int32 HeadOffset = 0;
+		int32 NumSamples = 0;
+	};
+
+	// Latest published window; shared with readers so they can safely outlive the timeline
+	struct FPublication
+	{
+		std::atomic<const FView*> View{ nullptr };
+	};
+
+public:
+	// Immutable history captured from a timeline; holding one keeps its pages alive
+	using FBranch = TSharedPtr<const FView, ESPMode::ThreadSafe>;
+
+	using FReadHandle = TSharedRef<FPublication, ESPMode::ThreadSafe>;
+
+	// Reads the window published by the timeline from any thread without taking locks
+	// Keep readers short lived; retired windows can't be freed while a reader that may observe them is alive
+	class FReader
+	{
+	public:
+		explicit FReader(const FReadHandle& Handle)
+			: Epoch(FRewindReadEpoch::Enter())
+			, View(Handle->View.load(std::memory_order_acquire))
+		{
+		}
+
+		~FReader() { FRewindReadEpoch::Exit(Epoch); }
+
+		UE_NONCOPYABLE(FReader);
+
+		int32 Num() const { return View ? View->NumSamples : 0; }
+
+		bool IsEmpty() const { return Num() == 0; }
+
+		const SampleType& operator[](int32 Index) const
+		{
+			check(Index >= 0 && Index < Num());
+			const int32 Slot = View->HeadOffset + Index;
+			const int32 PageIndex = Slot / PageSize;
+			const typename FView::FPageView& Page = View->Pages[PageIndex];
+			if (Page.Samples) { return (*Page.Samples)[Slot % PageSize]; }
+
+			// Compressed pages are decoded on the reading thread into storage owned by this reader
+			TArray<SampleType>& Decoded = DecodedPages.FindOrAdd(PageIndex);
+			if (Decoded.IsEmpty()) { DecodePage(*Page.Compressed, Page.EncodedSize, Decoded); }
+			return Decoded[Slot % PageSize];
+		}
+
+		const SampleType& First() const { return (*this)[0]; }
+
+		const SampleType& Last() const { return (*this)[Num() - 1]; }
+
+	private:
+		uint64 Epoch;
+		const FView* View;
+
+		// Moving the map's arrays doesn't move their elements, so returned references stay valid
+		mutable TMap<int32, TArray<SampleType>> DecodedPages;
+	};
+
+	TRewindTimeline() = default;
+
+	UE_NONCOPYABLE(TRewindTimeline);
+
+	~TRewindTimeline()
+	{
+		if (Publication)
+		{
+			const FView* View = Publication->View.exchange(nullptr);
+			if (View) { FRewindReadEpoch::Retire([View]() { delete View; }); }
+		}
+	}
+
+	// Returns a handle that other threads can read the timeline through, publishing the timeline if it wasn't already
+	FReadHandle GetReadHandle()
+	{
+		if (!Publication)
+		{
+			Publication = MakeShared<FPublication, ESPMode::ThreadSafe>();
+			bHasUnpublishedChanges = true;
+			Publish();
+		}
+		return Publication.ToSharedRef();
+	}
+
+	// Captures the oldest Count samples as a branch; no samples are copied, as the branch shares pages with the timeline
+	FBranch Branch(int32 Count)
+	{
+		check(Count >= 0 && Count <= NumSamples);
+		return FBranch(CaptureView(Count));
+	}
+
+	// Appends the oldest Count samples of a branch to OutSamples, decoding compressed pages on the calling thread; branches
+	// are immutable, so this is safe from any thread
+	static void CopyBranch(const FBranch& Branch, int32 Count, TArray<SampleType>& OutSamples)
+	{
+		check(Branch.IsValid() && Count >= 0 && Count <= Branch->NumSamples);
+		OutSamples.Reserve(OutSamples.Num() + Count);
+		FSampleArray Decoded;
+		const int32 EndSlot = Branch->HeadOffset + Count;
+		for (int32 Slot = Branch->HeadOffset; Slot < EndSlot;)
+		{
+			const typename FView::FPageView& Page = Branch->Pages[Slot / PageSize];
+			const FSampleArray* Samples = Page.Samples.Get();
+			if (!Samples)
+			{
+				DecodePage(*Page.Compressed, Page.EncodedSize, Decoded);
+				Samples = &Decoded;
+			}
+			const int32 PageEndSlot = FMath::Min((Slot / PageSize + 1) * PageSize, EndSlot);
+			OutSamples.Append(Samples->GetData() + Slot % PageSize, PageEndSlot - Slot);
+			Slot = PageEndSlot;
+		}
+	}
+
+	// Replaces the timeline with a previously captured branch; again, only page references are copied
+	void Restore(const FBranch& Branch)
+	{
+		check(Branch.IsValid());
+		Pages.Empty(Branch->Pages.Num());
+		for (const typename FView::FPageView& PageView : Branch->Pages)
+		{
+			TUniquePtr<FPage> Page = MakeUnique<FPage>();
+			Page->Samples = PageView.Samples;
+			Page->Compressed = PageView.Compressed;
+			Page->EncodedSize = PageView.EncodedSize;
+
+			// The branch may be restored again later, so none of its slots can be written in place
+			Page->PublishedBegin = 0;
+			Page->PublishedEnd = PageSize;
+			Pages.Add(MoveTemp(Page));
+		}
+		HeadOffset = Branch->HeadOffset;
+		NumSamples = Branch->NumSamples;
+		bHasUnpublishedChanges = true;
+	}
+
+	// Makes changes since the previous call visible to readers; call once per frame after recording or playback
+	void Publish()
+	{
+		if (!Publication) { return; }
+
+		if (bHasUnpublishedChanges)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(TRewindTimeline::Publish);
+
+			FView* View = CaptureView(NumSamples);
+			const FView* PreviousView = Publication->View.exchange(View);
+			if (PreviousView) { FRewindReadEpoch::Retire([PreviousView]() { delete PreviousView; }); }
+			bHasUnpublishedChanges = false;
+		}
+
+		FRewindReadEpoch::Reclaim();
+	}
+
+	// Enables background compression, keeping the newest RawWindowSamples and PlayheadWindowSamples around the playhead raw
+	void SetCompression(bool bEnabled, int32 InRawWindowSamples, int32 InPlayheadWindowSamples)
+	{
+		bCompressionEnabled = bEnabled;
+		RawWindowSamples = FMath::Max(InRawWindowSamples, PageSize);
+		PlayheadWindowSamples = FMath::Max(InPlayheadWindowSamples, PageSize);
+	}
+
+	// Reserves space in the page table for the requested number of samples
+	void Reserve(int32 NumSamples) { Pages.Reserve(FMath::DivideAndRoundUp(NumSamples, PageSize) + 1); }
+
+	int32 Num() const { return NumSamples; }
+
+	bool IsEmpty() const { return NumSamples == 0; }
+
+	// Returns how many of the oldest samples share a page, and are released together once PopFront has removed them all
+	int32 GetNumInOldestPage() const { return FMath::Min(PageSize - HeadOffset, NumSamples); }
+
+	const SampleType& operator[](int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < NumSamples);
+		const int32 Slot = HeadOffset + Index;
+		return (*GetResidentSamples(*Pages[Slot / PageSize]))[Slot % PageSize];
+	}
+
+	const SampleType& First() const { return (*this)[0]; }
+
+	const SampleType& Last() const { return (*this)[NumSamples - 1]; }
+
+	// Appends a sample and returns its index
+	template <typename... ArgsType>
+	int32 Emplace(ArgsType&&... Args)
+	{
+		const int32 Slot = HeadOffset + NumSamples;
+		if (Slot / PageSize == Pages.Num()) { AddPage(false /*bFront*/); }
+		GetWritableSamples(*Pages[Slot / PageSize], Slot % PageSize)[Slot % PageSize] = SampleType(Forward<ArgsType>(Args)...);
+		bHasUnpublishedChanges = true;
+		return NumSamples++;
+	}
+
+	// Appends a sample and returns its index
+	int32 Add(const SampleType& Sample) { return Emplace(Sample); }
+
+	// Prepends a sample; used to stream older history back in
+	void AddFront(const SampleType& Sample)
+	{
+		if (HeadOffset == 0)
+		{
+			AddPage(true /*bFront*/);
+			HeadOffset = PageSize;
+		}
+		--HeadOffset;
+		++NumSamples;
+		GetWritableSamples(*Pages.First(), HeadOffset)[HeadOffset] = Sample;
+		bHasUnpublishedChanges = true;
+	}
+
+	// Removes the oldest sample
+	void PopFront()
+	{
+		check(NumSamples > 0);
+		--NumSamples;
+		bHasUnpublishedChanges = true;
+		if (++HeadOffset == PageSize || NumSamples == 0)
+		{
+			Pages.PopFront();
+			HeadOffset = 0;
+		}
+	}
+
+	// Removes the newest sample
+	void Pop()
+	{
+		check(NumSamples > 0);
+		--NumSamples;
+		bHasUnpublishedChanges = true;
+		if ((HeadOffset + NumSamples) % PageSize == 0)
+		{
+			Pages.Pop();
+			if (NumSamples == 0) { HeadOffset = 0; }
+		}
+	}
+
+	// Removes every sample after the oldest Count, releasing whole pages at a time
+	void Truncate(int32 Count)
+	{
+		check(Count >= 0 && Count <= NumSamples);
+		if (Count == NumSamples) { return; }
+
+		NumSamples = Count;
+		const int32 NumPagesInUse = NumSamples > 0 ? FMath::DivideAndRoundUp(HeadOffset + NumSamples, PageSize) : 0;
+		while (Pages.Num() > NumPagesInUse) { Pages.Pop(); }
+		if (NumSamples == 0) { HeadOffset = 0; }
+		bHasUnpublishedChanges = true;
+	}
+
+	// Removes all samples and releases all pages
+	void Empty()
+	{
+		Pages.Empty();
+		HeadOffset = 0;
+		NumSamples = 0;
+		bHasUnpublishedChanges = true;
+	}
+
+	// Compresses aged pages and prefetches pages around the playhead; call once per frame
+	void UpdateCompression(int32 PlayheadIndex)
+	{
+		if (!bCompressionEnabled) { return; }
+
+		TRACE_CPUPROFILER_EVENT_SCOPE(TRewindTimeline::UpdateCompression);
+
+		// Pages overlapping these sample ranges are kept raw
+		const int32 RawWindowStart = HeadOffset + NumSamples - RawWindowSamples;
+		const int32 PlayheadStart = HeadOffset + PlayheadIndex - PlayheadWindowSamples;
+		const int32 PlayheadEnd = HeadOffset + PlayheadIndex + PlayheadWindowSamples;
+
+		// The last page is still being written to and is never compressed
+		for (int32 PageIndex = 0; PageIndex < Pages.Num() - 1; ++PageIndex)
+		{
+			FPage& Page = *Pages[PageIndex];
+			CompleteTasks(Page);
+
+			const int32 PageStart = PageIndex * PageSize;
+			const int32 PageEnd = PageStart + PageSize - 1;
+			const bool bKeepRaw = PageEnd >= RawWindowStart || (PlayheadIndex >= 0 && PageEnd >= PlayheadStart && PageStart <= PlayheadEnd);
+			if (bKeepRaw)
+			{
+				// Decompress ahead of the playhead
+				if (!Page.Samples && !Page.DecompressTask.IsValid()) { LaunchDecompress(Page); }
+			}
+			else if (!Page.Compressed)
+			{
+				if (Page.Samples && !Page.CompressTask.IsValid() && !Page.bCompressionFailed) { LaunchCompress(Page); }
+			}
+			else if (Page.Samples)
+			{
+				// Compressed copy is up to date, so the raw copy can be released once readers have moved on too
+				Page.Samples.Reset();
+				bHasUnpublishedChanges = true;
+			}
+		}
+	}
+
+	// Returns the bytes currently held by raw and compressed pages
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = Pages.Max() * sizeof(TUniquePtr<FPage>);
+		for (int32 PageIndex = 0; PageIndex < Pages.Num(); ++PageIndex)
+		{
+			const FPage& Page = *Pages[PageIndex];
+			Size += sizeof(FPage);
+			if (Page.Samples) { Size += Page.Samples->GetAllocatedSize(); }
+			if (Page.Compressed) { Size += Page.Compressed->GetAllocatedSize(); }
+		}
+		return Size;
+	}
+
+	// Number of times a compressed page had to be decompressed on the calling thread
+	int32 GetNumDecompressionStalls() const { return NumDecompressionStalls; }
+
+private:
+	void AddPage(bool bFront)
+	{
+		TUniquePtr<FPage> Page = MakeUnique<FPage>();
+		Page->Samples = MakeShared<FSampleArray, ESPMode::ThreadSafe>();
+		Page->Samples->SetNum(PageSize);
+		if (bFront) { Pages.AddFront(MoveTemp(Page)); }
+		else { Pages.Add(MoveTemp(Page)); }
+	}
+
+	// Returns the raw samples of a page, decompressing them on the calling thread if necessary
+	const FSampleArrayPtr& GetResidentSamples(FPage& Page) const
+	{
+		if (!Page.Samples)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(TRewindTimeline::DecompressionStall);
+			++NumDecompressionStalls;
+			if (!Page.DecompressTask.IsValid()) { LaunchDecompress(Page); }
+			Page.DecompressTask.Wait();
+			CompleteTasks(Page);
+		}
+		return Page.Samples;
+	}
+
+	// Creates a window sharing the pages that hold the oldest Count samples, marking their slots as observed
+	FView* CaptureView(int32 Count)
+	{
+		FView* View = new FView();
+		View->HeadOffset = HeadOffset;
+		View->NumSamples = Count;
+		const int32 NumPagesInView = Count > 0 ? FMath::DivideAndRoundUp(HeadOffset + Count, PageSize) : 0;
+		View->Pages.Reserve(NumPagesInView);
+		for (int32 PageIndex = 0; PageIndex < NumPagesInView; ++PageIndex)
+		{
+			FPage& Page = *Pages[PageIndex];
+			View->Pages.Add({ Page.Samples, Page.Compressed, Page.EncodedSize });
+
+			// Remember which slots the view may observe so writes to them copy the page instead
+			if (Page.Samples)
+			{
+				const int32 PageStart = PageIndex * PageSize;
+				Page.PublishedBegin = FMath::Min(Page.PublishedBegin, FMath::Max(HeadOffset - PageStart, 0));
+				Page.PublishedEnd = FMath::Max(Page.PublishedEnd, FMath::Min(HeadOffset + Count - PageStart, PageSize));
+			}
+		}
+		return View;
+	}
+
+	// Returns raw samples that are safe to write Slot of; workers and readers may still hold the previous copy
+	FSampleArray& GetWritableSamples(FPage& Page, int32 Slot)
+	{
+		GetResidentSamples(Page);
+
+		// Unpublished slots can be written in place, since readers never look past the window they were given
+		const bool bSlotMayBeObserved = Page.CompressTask.IsValid() || (Slot >= Page.PublishedBegin && Slot < Page.PublishedEnd);
+		if (bSlotMayBeObserved && !Page.Samples.IsUnique())
+		{
+			Page.Samples = MakeShared<FSampleArray, ESPMode::ThreadSafe>(*Page.Samples);
+			Page.PublishedBegin = PageSize;
+			Page.PublishedEnd = 0;
+		}
+		Page.Compressed.Reset();
+		Page.bCompressionFailed = false;
+		++Page.Version;
+		return *Page.Samples;
+	}
+
+	// Swaps in the results of any completed tasks
+	static void CompleteTasks(FPage& Page)
+	{
+		if (Page.CompressTask.IsValid() && Page.CompressTask.IsCompleted())
+		{
+			// Discard results for samples that have since been modified; pages that failed to compress aren't retried
+			if (Page.CompressTaskVersion == Page.Version)
+			{
+				Page.Compressed = Page.CompressTask.GetResult().Key;
+				Page.EncodedSize = Page.CompressTask.GetResult().Value;
+				Page.bCompressionFailed = !Page.Compressed.IsValid();
+			}
+			Page.CompressTask = {};
+		}
+
+		if (Page.DecompressTask.IsValid() && Page.DecompressTask.IsCompleted())
+		{
+			if (!Page.Samples)
+			{
+				Page.Samples = Page.DecompressTask.GetResult();
+				Page.PublishedBegin = PageSize;
+				Page.PublishedEnd = 0;
+			}
+			Page.DecompressTask = {};
+		}
+	}
+
+	static void LaunchCompress(FPage& Page)
+	{
+		Page.CompressTaskVersion = Page.Version;
+		Page.CompressTask = UE::Tasks::Launch(
+			UE_SOURCE_LOCATION,
+			[Samples = Page.Samples]()
+			{
+				TArray<uint8> Encoded;
+				TRewindTimelineCodec<SampleType>::Encode(*Samples, Encoded);
+				FByteArrayPtr Compressed = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+				if (!RewindCompression::Compress(Encoded, *Compressed)) { Compressed.Reset(); }
+				return TPair<FByteArrayPtr, int32>(Compressed, Encoded.Num());
+			},
+			UE::Tasks::ETaskPriority::BackgroundNormal);
+	}
+
+	static void LaunchDecompress(FPage& Page)
+	{
+		check(Page.Compressed);
+		Page.DecompressTask = UE::Tasks::Launch(
+			UE_SOURCE_LOCATION,
+			[Compressed = Page.Compressed, EncodedSize = Page.EncodedSize]()
+			{
+				FSampleArrayPtr Samples = MakeShared<FSampleArray, ESPMode::ThreadSafe>();
+				DecodePage(*Compressed, EncodedSize, *Samples);
+				return Samples;
+			});
+	}
+
+	// Decompresses and decodes a full page of samples
+	static void DecodePage(TArrayView<const uint8> Compressed, int32 EncodedSize, FSampleArray& OutSamples)
+	{
+		TArray<uint8> Encoded;
+		if (RewindCompression::Decompress(Compressed, EncodedSize, Encoded))
+		{
+			TRewindTimelineCodec<SampleType>::Decode(Encoded, PageSize, OutSamples);
+		}
+		OutSamples.SetNum(PageSize);
+	}
+
+	// Page table; pages are mutable so const access can make compressed pages resident
+	mutable TRingBuffer<TUniquePtr<FPage>> Pages;
+
+	// Index of the oldest sample within the first page
+	int32 HeadOffset = 0;
+
+	int32 NumSamples = 0;
+
+	bool bCompressionEnabled = false;
+	int32 RawWindowSamples = PageSize;
+	int32 PlayheadWindowSamples = PageSize;
+
+	mutable int32 NumDecompressionStalls = 0;
+
+	// Window shared with readers; null until a read handle is requested
+	TSharedPtr<FPublication, ESPMode::ThreadSafe> Publication;
+
+	// Whether the window has changed since it was last published
+	bool bHasUnpublishedChanges = false;
+};
@@ -0,0 +1,362 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindTimelineFile.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/IsSorted.h"
+#include "Async/MappedFileHandle.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Rewind.h"
+#include "RewindComponent.h"
+
+static_assert(std::is_trivially_copyable_v<FRewindTimelineFileSample>, "Samples are copied directly to and from disk");
+
+// Structs are written as raw bytes, so those with padding are zeroed before their fields are set rather than writing
+// whatever was in memory; these two have none
+static_assert(sizeof(FRewindTimelineFileHeader) == 2 * sizeof(uint32), "File header has padding");
+static_assert(sizeof(FRewindTimelineFileChunkHeader) == 3 * sizeof(uint32), "Chunk header has padding");
+
+FRewindTimelineFileWriter::~FRewindTimelineFileWriter()
+{
+	// Write tasks hold a shared reference to the writer, so the file can only still be open if CloseAsync was never called
+	if (FileHandle) { FileHandle->Flush(); }
+}
+
+bool FRewindTimelineFileWriter::Open(const FString& FileName)
+{
+	check(!FileHandle.IsValid());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FileName));
+	FileHandle.Reset(PlatformFile.OpenWrite(*FileName));
+	if (!FileHandle)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Failed to open rewind timeline file %s for writing"), *FileName);
+		return false;
+	}
+
+	// Reserve both buffers up front so appending never reallocates in the common case
+	Buffers[0].Reserve(FlushThresholdBytes * 2);
+	Buffers[1].Reserve(FlushThresholdBytes * 2);
+
+	FRewindTimelineFileHeader Header;
+	AppendBytes(&Header, sizeof(Header));
+	return true;
+}
+
+uint32 FRewindTimelineFileWriter::AddTimeline(const FString& Name)
+{
+	return TimelineNames.Add(Name);
+}
+
+void FRewindTimelineFileWriter::WriteChunk(TArrayView<const FRewindTimelineFileSample> Samples)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindTimelineFileWriter::WriteChunk);
+
+	if (!FileHandle || Samples.Num() == 0) { return; }
+	checkSlow(Algo::IsSortedBy(Samples, &FRewindTimelineFileSample::Time));
+	checkf(ChunkIndex.Num() == 0 || ChunkIndex.Last().EndTime <= Samples[0].Time, TEXT("Chunks must be written in time order"));
+
+	FRewindTimelineFileChunkIndexEntry& Entry = ChunkIndex.AddZeroed_GetRef();
+	Entry.StartTime = Samples[0].Time;
+	Entry.EndTime = Samples.Last().Time;
+	Entry.Offset = FrontBufferFileOffset + Buffers[FrontBufferIndex].Num();
+	Entry.NumSamples = Samples.Num();
+
+	FRewindTimelineFileChunkHeader ChunkHeader;
+	ChunkHeader.StartTime = Entry.StartTime;
+	ChunkHeader.EndTime = Entry.EndTime;
+	ChunkHeader.NumSamples = Entry.NumSamples;
+	AppendBytes(&ChunkHeader, sizeof(ChunkHeader));
+	AppendBytes(Samples.GetData(), Samples.Num() * sizeof(FRewindTimelineFileSample));
+
+	TryFlush(false /*bForce*/);
+}
+
+void FRewindTimelineFileWriter::CloseAsync()
+{
+	if (!FileHandle) { return; }
+
+	// Append the name table and chunk index to the front buffer; they are small compared to the chunks
+	FRewindTimelineFileFooter Footer;
+	FMemory::Memzero(Footer);
+	Footer.Magic = RewindTimelineFileMagic;
+	Footer.TimelineTableOffset = FrontBufferFileOffset + Buffers[FrontBufferIndex].Num();
+	Footer.NumTimelines = TimelineNames.Num();
+	for (const FString& Name : TimelineNames)
+	{
+		FTCHARToUTF8 Utf8Name(*Name);
+		uint32 Length = Utf8Name.Length();
+		AppendBytes(&Length, sizeof(Length));
+		AppendBytes(Utf8Name.Get(), Length);
+	}
+
+	Footer.ChunkIndexOffset = FrontBufferFileOffset + Buffers[FrontBufferIndex].Num();
+	Footer.NumChunks = ChunkIndex.Num();
+	AppendBytes(ChunkIndex.GetData(), ChunkIndex.Num() * sizeof(FRewindTimelineFileChunkIndexEntry));
+	AppendBytes(&Footer, sizeof(Footer));
+
+	// Write whatever is left and close the file once the in-flight write (if any) completes
+	TArray<uint8> FinalBuffer = MoveTemp(Buffers[FrontBufferIndex]);
+	PendingWrite = UE::Tasks::Launch(
+		UE_SOURCE_LOCATION,
+		[This = AsShared(), FinalBuffer = MoveTemp(FinalBuffer)]()
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FRewindTimelineFileWriter::CloseAsync);
+			This->FileHandle->Write(FinalBuffer.GetData(), FinalBuffer.Num());
+			This->FileHandle->Flush();
+			This->FileHandle.Reset();
+		},
+		UE::Tasks::Prerequisites(PendingWrite));
+}
+
+void FRewindTimelineFileWriter::Wait()
+{
+	PendingWrite.Wait();
+}
+
+void FRewindTimelineFileWriter::TryFlush(bool bForce)
+{
+	TArray<uint8>& FrontBuffer = Buffers[FrontBufferIndex];
+	if (FrontBuffer.Num() < FlushThresholdBytes && !bForce) { return; }
+
+	// Never block on the worker; keep filling the front buffer until the back buffer is free again
+	if (!PendingWrite.IsCompleted()) { return; }
+
+	// Swap buffers and hand the filled one to the worker
+	const int32 BackBufferIndex = FrontBufferIndex;
+	FrontBufferIndex ^= 1;
+	FrontBufferFileOffset += Buffers[BackBufferIndex].Num();
+	Buffers[FrontBufferIndex].Reset();
+
+	PendingWrite = UE::Tasks::Launch(
+		UE_SOURCE_LOCATION,
+		[This = AsShared(), BackBufferIndex]()
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FRewindTimelineFileWriter::Write);
+			TArray<uint8>& BackBuffer = This->Buffers[BackBufferIndex];
+			This->FileHandle->Write(BackBuffer.GetData(), BackBuffer.Num());
+		});
+}
+
+void FRewindTimelineFileWriter::AppendBytes(const void* Data, int64 NumBytes)
+{
+	Buffers[FrontBufferIndex].Append(static_cast<const uint8*>(Data), NumBytes);
+}
+
+FRewindTimelineFileReader::~FRewindTimelineFileReader()
+{
+	Close();
+}
+
+bool FRewindTimelineFileReader::Open(const FString& FileName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindTimelineFileReader::Open);
+
+	Close();
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FileName));
+	if (!MappedFile)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Failed to map rewind timeline file %s"), *FileName);
+		return false;
+	}
+
+	// Map the whole file; pages are only read from disk when they are touched
+	const int64 FileSize = MappedFile->GetFileSize();
+	if (FileSize < int64(sizeof(FRewindTimelineFileHeader) + sizeof(FRewindTimelineFileFooter)))
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Rewind timeline file %s is truncated"), *FileName);
+		Close();
+		return false;
+	}
+	MappedRegion.Reset(MappedFile->MapRegion(0, FileSize));
+	if (!MappedRegion)
+	{
+		Close();
+		return false;
+	}
+	const uint8* Data = MappedRegion->GetMappedPtr();
+
+	const auto Reject = [this, &FileName](const TCHAR* Reason)
+	{
+		UE_LOG(LogRewind, Warning, TEXT("Rewind timeline file %s %s"), *FileName, Reason);
+		Close();
+		return false;
+	};
+
+	// Validate the header and footer
+	FRewindTimelineFileHeader Header;
+	FRewindTimelineFileFooter Footer;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	FMemory::Memcpy(&Footer, Data + FileSize - sizeof(Footer), sizeof(Footer));
+	if (Header.Magic != RewindTimelineFileMagic || Footer.Magic != RewindTimelineFileMagic || Header.Version != RewindTimelineFileVersion)
+	{
+		return Reject(TEXT("has an unsupported format"));
+	}
+
+	// Every offset and count below comes from the file, so a truncated or corrupt file must not be able to point the reader
+	// outside the mapping; sections are laid out in order, each ending where the next begins at the latest
+	const uint64 FooterOffset = FileSize - sizeof(Footer);
+	const uint64 TableOffset = Footer.TimelineTableOffset;
+	const uint64 IndexOffset = Footer.ChunkIndexOffset;
+	if (TableOffset < sizeof(Header) || TableOffset > IndexOffset || IndexOffset > FooterOffset
+		|| Footer.NumChunks > (FooterOffset - IndexOffset) / sizeof(FRewindTimelineFileChunkIndexEntry)
+		|| Footer.NumTimelines > (IndexOffset - TableOffset) / sizeof(uint32))
+	{
+		return Reject(TEXT("has a corrupt footer"));
+	}
+
+	// Read the name table
+	uint64 Offset = TableOffset;
+	TimelineNames.Reserve(Footer.NumTimelines);
+	for (uint32 Index = 0; Index < Footer.NumTimelines; ++Index)
+	{
+		uint32 Length = 0;
+		if (Offset + sizeof(Length) > IndexOffset) { return Reject(TEXT("has a corrupt timeline table")); }
+		FMemory::Memcpy(&Length, Data + Offset, sizeof(Length));
+		Offset += sizeof(Length);
+		if (Length > IndexOffset - Offset) { return Reject(TEXT("has a corrupt timeline table")); }
+		FUTF8ToTCHAR Name(reinterpret_cast<const ANSICHAR*>(Data + Offset), Length);
+		TimelineNames.Emplace(Name.Length(), Name.Get());
+		Offset += Length;
+	}
+
+	// Read the chunk index; it may be unaligned because of the variable length name table
+	ChunkIndex.SetNumUninitialized(Footer.NumChunks);
+	FMemory::Memcpy(ChunkIndex.GetData(), Data + IndexOffset, Footer.NumChunks * sizeof(FRewindTimelineFileChunkIndexEntry));
+
+	// Chunks must lie between the header and the name table, agree with their own headers and be in time order, which
+	// FindChunk's binary search relies on
+	for (int32 Index = 0; Index < ChunkIndex.Num(); ++Index)
+	{
+		const FRewindTimelineFileChunkIndexEntry& Entry = ChunkIndex[Index];
+		const uint64 SamplesOffset = Entry.Offset + sizeof(FRewindTimelineFileChunkHeader);
+		if (Entry.Offset < sizeof(Header) || Entry.Offset > TableOffset || SamplesOffset > TableOffset
+			|| Entry.NumSamples > (TableOffset - SamplesOffset) / sizeof(FRewindTimelineFileSample))
+		{
+			return Reject(TEXT("has a chunk outside the file"));
+		}
+
+		FRewindTimelineFileChunkHeader ChunkHeader;
+		FMemory::Memcpy(&ChunkHeader, Data + Entry.Offset, sizeof(ChunkHeader));
+		const bool bInOrder = Entry.StartTime <= Entry.EndTime && (Index == 0 || ChunkIndex[Index - 1].EndTime <= Entry.StartTime);
+		if (ChunkHeader.NumSamples != Entry.NumSamples || !bInOrder) { return Reject(TEXT("has a corrupt chunk index")); }
+	}
+
+	return true;
+}
+
+void FRewindTimelineFileReader::Close()
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	TimelineNames.Reset();
+	ChunkIndex.Reset();
+}
+
+int32 FRewindTimelineFileReader::FindChunk(float Time) const
+{
+	if (ChunkIndex.Num() == 0) { return INDEX_NONE; }
+
+	// First chunk that ends at or after Time; clamp to the last chunk
+	int32 Index = Algo::LowerBound(ChunkIndex, Time, [](const FRewindTimelineFileChunkIndexEntry& Entry, float Value) {
+		return Entry.EndTime < Value;
+	});
+	return FMath::Min(Index, ChunkIndex.Num() - 1);
+}
+
+bool FRewindTimelineFileReader::ReadChunkSamples(int32 Index, TArray<FRewindTimelineFileSample>& OutSamples) const
+{
+	if (!IsOpen() || !ChunkIndex.IsValidIndex(Index)) { return false; }
+
+	const FRewindTimelineFileChunkIndexEntry& Entry = ChunkIndex[Index];
+	OutSamples.SetNumUninitialized(Entry.NumSamples);
+	FMemory::Memcpy(OutSamples.GetData(), GetChunkSampleData(Index), Entry.NumSamples * sizeof(FRewindTimelineFileSample));
+	return true;
+}
+
+const uint8* FRewindTimelineFileReader::GetChunkSampleData(int32 Index) const
+{
+	return MappedRegion->GetMappedPtr() + ChunkIndex[Index].Offset + sizeof(FRewindTimelineFileChunkHeader);
+}
+
+bool FRewindTimelineFileReader::SampleAtTime(float Time, TArray<FRewindTimelineFileSample>& OutSamples, TBitArray<>& OutHasSample) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FRewindTimelineFileReader::SampleAtTime);
+
+	int32 ChunkToSearch = FindChunk(Time);
+	if (ChunkToSearch == INDEX_NONE) { return false; }
+
+	OutSamples.SetNum(TimelineNames.Num());
+	OutHasSample.Init(false, TimelineNames.Num());
+
+	// Walk back through the chunk (and the one before it, for timelines that started late in the chunk)
+	int32 NumFound = 0;
+	constexpr int32 MaxChunksToSearch = 2;
+	for (int32 ChunksSearched = 0; ChunksSearched < MaxChunksToSearch && ChunkToSearch >= 0; ++ChunksSearched, --ChunkToSearch)
+	{
+		// Samples are only as aligned as the chunk offsets in the mapped file, so each one is copied out before it is read
+		const uint8* SampleData = GetChunkSampleData(ChunkToSearch);
+		for (int32 Index = ChunkIndex[ChunkToSearch].NumSamples - 1; Index >= 0 && NumFound < OutSamples.Num(); --Index)
+		{
+			FRewindTimelineFileSample Sample;
+			FMemory::Memcpy(&Sample, SampleData + Index * sizeof(FRewindTimelineFileSample), sizeof(Sample));
+			if (Sample.Time > Time || !OutSamples.IsValidIndex(Sample.TimelineIndex)) { continue; }
+
+			if (!OutHasSample[Sample.TimelineIndex])
+			{
+				OutSamples[Sample.TimelineIndex] = Sample;
+				OutHasSample[Sample.TimelineIndex] = true;
+				++NumFound;
+			}
+		}
+	}
+
+	return NumFound > 0;
+}
+
+void RewindTimelineFile::AppendComponentSamples(
+	const URewindComponent& Component,
+	uint32 TimelineIndex,
+	double CurrentTime,
+	double StartTime,
+	TArray<FRewindTimelineFileSample>& OutSamples)
+{
+	const TRewindTimeline<FTransformAndVelocitySnapshot>& Snapshots = Component.GetTransformAndVelocitySnapshots();
+	const TRewindTimeline<FMovementVelocityAndModeSnapshot>& MovementSnapshots = Component.GetMovementVelocityAndModeSnapshots();
+	const bool bHasMovement = MovementSnapshots.Num() == Snapshots.Num();
+	if (Snapshots.Num() == 0) { return; }
+
+	// Modes come from the component's mode changes, which are walked once for all snapshots
+	TArray<TEnumAsByte<EMovementMode>> MovementModes;
+	if (bHasMovement) { Component.GetSnapshotMovementModes(MovementModes); }
+
+	// Snapshots store the time since the previous snapshot, so walk back from the newest one to recover absolute times
+	double SnapshotTime = CurrentTime - Component.GetTimeSinceSnapshotsChanged();
+	const int32 FirstNewSample = OutSamples.Num();
+	OutSamples.AddZeroed(Snapshots.Num());
+	for (int32 Index = Snapshots.Num() - 1; Index >= 0; --Index)
+	{
+		const FTransformAndVelocitySnapshot& Snapshot = Snapshots[Index];
+		FRewindTimelineFileSample& Sample = OutSamples[FirstNewSample + Index];
+		Sample.TimelineIndex = TimelineIndex;
+		Sample.Time = static_cast<float>(SnapshotTime - StartTime);
+		Sample.Location = FVector3f(Snapshot.Transform.GetLocation());
+		Sample.Rotation = FQuat4f(Snapshot.Transform.GetRotation());
+		Sample.Scale = FVector3f(Snapshot.Transform.GetScale3D());
+		Sample.LinearVelocity = FVector3f(Snapshot.LinearVelocity);
+		Sample.AngularVelocityInRadians = FVector3f(Snapshot.AngularVelocityInRadians);
+		Sample.bIsSleeping = Snapshot.bIsSleeping;
+		if (bHasMovement)
+		{
+			Sample.MovementVelocity = FVector3f(MovementSnapshots[Index].MovementVelocity);
+			Sample.MovementMode = MovementModes[Index];
+			Sample.bHasMovement = 1;
+		}
+
+		SnapshotTime -= Snapshot.TimeSinceLastSnapshot;
+	}
+}
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Tasks/Task.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class URewindComponent;
+
+// On-disk layout of a timeline file:
+//   FRewindTimelineFileHeader
+//   Chunks, each an FRewindTimelineFileChunkHeader followed by its time-sorted samples
+//   Timeline name table
+//   Chunk index (one FRewindTimelineFileChunkIndexEntry per chunk)
+//   FRewindTimelineFileFooter
+// The footer lives at the end of the file so chunks can be streamed out before the index is known.
+
+// Identifies a rewind timeline file
+constexpr uint32 RewindTimelineFileMagic = 0x444E5752; // 'RWND'
+
+// Bump whenever the on-disk layout changes
+constexpr uint32 RewindTimelineFileVersion = 2;
+
+struct FRewindTimelineFileHeader
+{
+	uint32 Magic = RewindTimelineFileMagic;
+	uint32 Version = RewindTimelineFileVersion;
+};
+
+struct FRewindTimelineFileChunkHeader
+{
+	// Time of the earliest sample in the chunk, in seconds since the start of the file
+	float StartTime = 0.0f;
+
+	// Time of the latest sample in the chunk, in seconds since the start of the file
+	float EndTime = 0.0f;
+
+	// Number of samples following this header
+	uint32 NumSamples = 0;
+};
+
+struct FRewindTimelineFileChunkIndexEntry
+{
+	// Time of the earliest sample in the chunk
+	float StartTime = 0.0f;
+
+	// Time of the latest sample in the chunk
+	float EndTime = 0.0f;
+
+	// Byte offset of the chunk header from the start of the file
+	uint64 Offset = 0;
+
+	// Number of samples stored in the chunk
+	uint32 NumSamples = 0;
+};
+
+struct FRewindTimelineFileFooter
+{
+	// Byte offset of the timeline name table
+	uint64 TimelineTableOffset = 0;
+
+	// Number of timelines in the name table
+	uint32 NumTimelines = 0;
+
+	// Byte offset of the chunk index
+	uint64 ChunkIndexOffset = 0;
+
+	// Number of entries in the chunk index
+	uint32 NumChunks = 0;
+
+	uint32 Magic = RewindTimelineFileMagic;
+};
+
+// Compact, single precision sample of one timeline at one point in time
+struct FRewindTimelineFileSample
+{
+	// Index of the timeline in the name table
+	uint32 TimelineIndex = 0;
+
+	// Seconds since the start of the file
+	float Time = 0.0f;
+
+	FVector3f Location = FVector3f::ZeroVector;
+	FQuat4f Rotation = FQuat4f::Identity;
+	FVector3f Scale = FVector3f::OneVector;
+	FVector3f LinearVelocity = FVector3f::ZeroVector;
+	FVector3f AngularVelocityInRadians = FVector3f::ZeroVector;
+
+	// Only meaningful when bHasMovement is set
+	FVector3f MovementVelocity = FVector3f::ZeroVector;
+	uint8 MovementMode = 0;
+	uint8 bHasMovement = 0;
+
+	// Whether the body was asleep
+	uint8 bIsSleeping = 0;
+};
+
+// Streams chunks of timeline samples to disk; I/O is performed on a worker thread using two alternating buffers
+class REWIND_API FRewindTimelineFileWriter : public TSharedFromThis<FRewindTimelineFileWriter, ESPMode::ThreadSafe>
+{
+public:
+	~FRewindTimelineFileWriter();
+
+	// Opens the file for writing and writes the file header
+	bool Open(const FString& FileName);
+
+	// Adds a timeline to the name table and returns its index
+	uint32 AddTimeline(const FString& Name);
+
+	// Appends a chunk of samples; samples must be sorted by time and chunks must be written in time order
+	void WriteChunk(TArrayView<const FRewindTimelineFileSample> Samples);
+
+	// Writes the name table, chunk index and footer on a worker thread, then closes the file; never blocks the caller
+	void CloseAsync();
+
+	// Blocks until all pending writes have completed
+	void Wait();
+
+	// Buffered bytes that trigger a write on the worker thread
+	int32 FlushThresholdBytes = 256 * 1024;
+
+private:
+	// Swaps the buffers and writes the back buffer on a worker thread if the previous write has completed
+	void TryFlush(bool bForce);
+
+	// Appends raw bytes to the front buffer
+	void AppendBytes(const void* Data, int64 NumBytes);
+
+	// File being written; only touched by write tasks once open
+	TUniquePtr<IFileHandle> FileHandle;
+
+	// Front buffer is filled by the caller while the back buffer is written by the worker
+	TArray<uint8> Buffers[2];
+	int32 FrontBufferIndex = 0;
+
+	// Write of the back buffer that is currently in flight
+	UE::Tasks::FTask PendingWrite;
+
+	// File offset that the start of the front buffer will be written at
+	uint64 FrontBufferFileOffset = 0;
+
+	TArray<FString> TimelineNames;
+	TArray<FRewindTimelineFileChunkIndexEntry> ChunkIndex;
+};
+
+// Memory maps a timeline file and decodes only the chunks around the requested time; the file is validated when opened,
+// so corrupt or truncated files are rejected rather than read out of bounds
+class REWIND_API FRewindTimelineFileReader
+{
+public:
+	~FRewindTimelineFileReader();
+
+	// Maps the file and reads the name table and chunk index; sample data is paged in on demand
+	bool Open(const FString& FileName);
+
+	// Releases the mapping
+	void Close();
+
+	// Returns whether a file is currently mapped
+	bool IsOpen() const { return MappedRegion.IsValid(); }
+
+	// Returns the names of the recorded timelines
+	const TArray<FString>& GetTimelineNames() const { return TimelineNames; }
+
+	// Returns the time of the latest sample in the file
+	float GetDuration() const { return ChunkIndex.Num() > 0 ? ChunkIndex.Last().EndTime : 0.0f; }
+
+	// Returns the index of the chunk containing Time using a binary search of the chunk index
+	int32 FindChunk(float Time) const;
+
+	// Copies the samples of a chunk out of the mapped file, where they are too loosely aligned to be read in place
+	bool ReadChunkSamples(int32 ChunkIndex, TArray<FRewindTimelineFileSample>& OutSamples) const;
+
+	// Finds the latest sample at or before Time for every timeline; OutHasSample is cleared for timelines without one
+	bool SampleAtTime(float Time, TArray<FRewindTimelineFileSample>& OutSamples, TBitArray<>& OutHasSample) const;
+
+private:
+	// Returns the start of a chunk's samples in the mapped file
+	const uint8* GetChunkSampleData(int32 ChunkIndex) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	TArray<FString> TimelineNames;
+	TArray<FRewindTimelineFileChunkIndexEntry> ChunkIndex;
+};
+
+namespace RewindTimelineFile
+{
+	// Converts the in-memory timeline of a component into file samples using absolute times relative to StartTime; samples
+	// are zeroed first, as they are written to disk padding and all
+	REWIND_API void AppendComponentSamples(
+		const URewindComponent& Component,
+		uint32 TimelineIndex,
+		double CurrentTime,
+		double StartTime,
+		TArray<FRewindTimelineFileSample>& OutSamples);
+} // namespace RewindTimelineFile
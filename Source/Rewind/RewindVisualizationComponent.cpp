@@ -2,7 +2,6 @@
 
 #include "RewindVisualizationComponent.h"
 
-#include "Containers/RingBuffer.h"
 #include "Engine/World.h"
 #include "RewindComponent.h"
 
@@ -29,7 +28,7 @@ void URewindVisualizationComponent::ClearInstances()
 	LastUpdateTime = 0.0f;
 }
 
-void URewindVisualizationComponent::SetInstancesFromSnapshots(const TRingBuffer<FTransformAndVelocitySnapshot>& Snapshots)
+void URewindVisualizationComponent::SetInstancesFromSnapshots(const TRewindTimeline<FTransformAndVelocitySnapshot>::FReader& Snapshots)
 {
 	// Skip the update if there are no snapshots
 	int CurrentInstanceCount = GetInstanceCount();
@@ -5,12 +5,10 @@
 #include "CoreMinimal.h"
 
 #include "Components/InstancedStaticMeshComponent.h"
-#include "Runtime/Core/Public/Containers/RingBuffer.h"
+#include "RewindTimeline.h"
 
 #include "RewindVisualizationComponent.generated.h"
 
-struct FTransformAndVelocitySnapshot;
-
 /**
  * Draws static mesh instances for each snapshot on the rewind timeline
  */
@@ -28,7 +26,7 @@ public:
 	virtual void ClearInstances() override;
 
 	// Assigns a static mesh to each transform in snapshots
-	void SetInstancesFromSnapshots(const TRingBuffer<FTransformAndVelocitySnapshot>& Snapshots);
+	void SetInstancesFromSnapshots(const TRewindTimeline<FTransformAndVelocitySnapshot>::FReader& Snapshots);
 
 protected:
 	// Called when the game starts